@@ -16,6 +16,13 @@ set(dandy_sources
     ${rootdir}/dandy/core/DRef.cpp
     ${rootdir}/dandy/core/DObject.cpp
     ${rootdir}/dandy/core/DObjectStorage.cpp
+    ${rootdir}/dandy/core/DRTTI.cpp
+    ${rootdir}/dandy/core/DFixedString.cpp
+    ${rootdir}/dandy/core/DStringPool.cpp
+    ${rootdir}/dandy/core/memory/DArena.cpp
+    ${rootdir}/dandy/core/memory/DEASTLAllocator.cpp
+    ${rootdir}/dandy/core/memory/DHeapTracker.cpp
+    ${rootdir}/dandy/core/memory/DPoolAllocator.cpp
     ${rootdir}/dandy/core/utils/DFILEUtils.cpp
     ${rootdir}/dandy/core/utils/DStringUtils.cpp
     ${rootdir}/dandy/core/stream/DStream.cpp
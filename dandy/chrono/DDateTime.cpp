@@ -43,6 +43,14 @@
 
 static const uint8_t D__LENGTH_OF_MONTH_TABLE[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 
+/* std::stringを返す書式化関数が使用する作業バッファです */
+typedef DFixedString<127> D__FormatBuffer;
+
+static inline std::string D__ToStdString(const DFixedStringBase& str)
+{
+    return std::string(str.c_str(), str.size());
+}
+
 DDate::DDate()
     : m_year(-1)
     , m_month(-1)
@@ -121,18 +129,30 @@ bool DDate::isValid() const
 }
 
 std::string DDate::format(const char* fmt) const
+{
+    D__FormatBuffer buffer;
+    this->format(&buffer, fmt);
+    return D__ToStdString(buffer);
+}
+
+std::string DDate::toString() const
+{
+    return this->format();
+}
+
+bool DDate::format(DFixedStringBase* dst, const char* fmt) const
 {
     struct tm tm;
     ::memset(&tm, 0, sizeof(tm));
     tm.tm_year = m_year - 1900;
     tm.tm_mon = m_month - 1;
     tm.tm_mday = m_day;
-    return d_strftime(fmt, &tm);
+    return d_strftime(dst, fmt, &tm);
 }
 
-std::string DDate::toString() const
+bool DDate::toString(DFixedStringBase* dst) const
 {
-    return this->format();
+    return this->format(dst);
 }
 
 DDate DDate::now()
@@ -204,18 +224,30 @@ int64_t DTime::toSeconds() const
 }
 
 std::string DTime::format(const char* fmt) const
+{
+    D__FormatBuffer buffer;
+    this->format(&buffer, fmt);
+    return D__ToStdString(buffer);
+}
+
+std::string DTime::toString() const
+{
+    return this->format();
+}
+
+bool DTime::format(DFixedStringBase* dst, const char* fmt) const
 {
     struct tm tm;
     ::memset(&tm, 0, sizeof(tm));
     tm.tm_hour = m_hour;
     tm.tm_min = m_minute;
     tm.tm_sec = m_second;
-    return d_strftime(fmt, &tm);
+    return d_strftime(dst, fmt, &tm);
 }
 
-std::string DTime::toString() const
+bool DTime::toString(DFixedStringBase* dst) const
 {
-    return this->format();
+    return this->format(dst);
 }
 
 DTime DTime::now()
@@ -255,10 +287,15 @@ int64_t DTimeDelta::totalSeconds() const
 
 std::string DTimeDelta::toString() const
 {
-    const std::string result(
-            DStringUtils::format("d:%d H:%d M:%d S:%d",
-                days, hours, minutes, seconds));
-    return result;
+    D__FormatBuffer buffer;
+    this->toString(&buffer);
+    return D__ToStdString(buffer);
+}
+
+bool DTimeDelta::toString(DFixedStringBase* dst) const
+{
+    return DStringUtils::format(dst, "d:%d H:%d M:%d S:%d",
+                                days, hours, minutes, seconds);
 }
 
 DTimeDelta DTimeDelta::ofDays(int days)
@@ -421,12 +458,23 @@ bool DTimeRange::isEmpty() const
 
 std::string DTimeRange::toString() const
 {
-    const std::string result(DStringUtils::format(
-            "%s-%s",
-            m_begin.toString().c_str(),
-            m_end.toString().c_str()));
+    D__FormatBuffer buffer;
+    this->toString(&buffer);
+    return D__ToStdString(buffer);
+}
 
-    return result;
+bool DTimeRange::toString(DFixedStringBase* dst) const
+{
+    X_ASSERT(dst);
+
+    D__FormatBuffer end;
+    if (!m_begin.toString(dst) || !m_end.toString(&end))
+        return false;
+
+    dst->push_back('-');
+    dst->append(end);
+
+    return !dst->overflowed();
 }
 
 DDateTime::DDateTime()
@@ -575,6 +623,16 @@ std::string DDateTime::toString() const
     return this->format();
 }
 
+bool DDateTime::format(DFixedStringBase* dst, const char* fmt) const
+{
+    return d_strftime(dst, fmt, m_timestamp);
+}
+
+bool DDateTime::toString(DFixedStringBase* dst) const
+{
+    return this->format(dst);
+}
+
 DDateTime DDateTime::now()
 {
     return DDateTime(::time(NULL));
@@ -651,7 +709,32 @@ std::string d_strftime(const char* fmt, DTimestamp timestamp)
 
 std::string d_strftime(const char* fmt, const struct tm* tmPtr)
 {
-    char buffer[128];
-    ::strftime(buffer, sizeof(buffer), fmt, tmPtr);
-    return buffer;
+    D__FormatBuffer buffer;
+    d_strftime(&buffer, fmt, tmPtr);
+    return D__ToStdString(buffer);
+}
+
+bool d_strftime(DFixedStringBase* dst, const char* fmt, DTimestamp timestamp)
+{
+    const struct tm* tmPtr = ::localtime(&timestamp);
+    return d_strftime(dst, fmt, tmPtr);
+}
+
+bool d_strftime(DFixedStringBase* dst, const char* fmt, const struct tm* tmPtr)
+{
+    X_ASSERT(dst);
+
+    /* strftime()は結果が収まらない場合に0を返し、内容は不定になります */
+    const size_t len = ::strftime(dst->data(), dst->capacity() + 1, fmt, tmPtr);
+    if ((len == 0) && (fmt[0] != '\0'))
+    {
+        dst->clear();
+        dst->updateLength(true);
+        return false;
+    }
+
+    dst->data()[len] = '\0';
+    dst->updateLength();
+
+    return true;
 }
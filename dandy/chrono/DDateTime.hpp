@@ -51,6 +51,7 @@
 
 
 #include <dandy/core/DCore.hpp>
+#include <dandy/core/DFixedString.hpp>
 
 
 #ifndef D_DATE_DEFAULT_FORMAT
@@ -69,6 +70,13 @@ typedef time_t DTimestamp;
 std::string d_strftime(const char* fmt, DTimestamp timestamp);
 std::string d_strftime(const char* fmt, const struct tm* tmPtr);
 
+/** dstにstrftime()の結果を設定します。動的メモリ確保は行いません
+ *
+ *  @return 結果がdstに収まった場合はtrue。収まらない場合、dstは空になります
+ */
+bool d_strftime(DFixedStringBase* dst, const char* fmt, DTimestamp timestamp);
+bool d_strftime(DFixedStringBase* dst, const char* fmt, const struct tm* tmPtr);
+
 
 class DDate
 {
@@ -92,6 +100,8 @@ public:
 
     std::string format(const char* fmt=D_DATE_DEFAULT_FORMAT) const;
     std::string toString() const;
+    bool format(DFixedStringBase* dst, const char* fmt=D_DATE_DEFAULT_FORMAT) const;
+    bool toString(DFixedStringBase* dst) const;
     static DDate now();
     static DDate fromCString(const char* str, const char* fmt=D_DATE_DEFAULT_FORMAT);
 
@@ -114,6 +124,8 @@ public:
     int64_t toSeconds() const;
     std::string format(const char* fmt=D_TIME_DEFAULT_FORMAT) const;
     std::string toString() const;
+    bool format(DFixedStringBase* dst, const char* fmt=D_TIME_DEFAULT_FORMAT) const;
+    bool toString(DFixedStringBase* dst) const;
     static DTime now();
     static DTime fromCString(const char* str, const char* fmt=D_DATE_DEFAULT_FORMAT);
 
@@ -141,6 +153,7 @@ public:
     int seconds;
     int64_t totalSeconds() const;
     std::string toString() const;
+    bool toString(DFixedStringBase* dst) const;
 
     static DTimeDelta ofDays(int days);
     static DTimeDelta ofHours(int hours);
@@ -177,6 +190,8 @@ public:
 
     std::string format(const char* fmt=D_DATE_TIME_DEFAULT_FORMAT) const;
     std::string toString() const;
+    bool format(DFixedStringBase* dst, const char* fmt=D_DATE_TIME_DEFAULT_FORMAT) const;
+    bool toString(DFixedStringBase* dst) const;
 
     static DDateTime now();
     static DDateTime min();
@@ -207,6 +222,7 @@ public:
     bool isValid() const;
     bool isEmpty() const;
     std::string toString() const;
+    bool toString(DFixedStringBase* dst) const;
 
 private:
     DTime m_begin;
@@ -45,6 +45,12 @@ static inline bool D__IsWithIn(bd_addr_t x, bd_addr_t begin, bd_addr_t end)
     return ((begin <= x) && (x < end));
 }
 
+
+DBlockDeviceMapper::DBlockDeviceMapper(const DEASTLAllocator& allocator)
+    : m_mappingTable(allocator)
+{
+}
+
 void DBlockDeviceMapper::addMap(BlockDevice* device, bd_addr_t virtualBegin, bd_addr_t physicalBegin, bd_size_t size)
 {
     Map map;
@@ -42,12 +42,19 @@
 
 
 #include <dandy/core/DCore.hpp>
-#include <list>
+#include <dandy/core/memory/DEASTLAllocator.hpp>
+#include <EASTL/list.h>
 
 
 class DBlockDeviceMapper
 {
 public:
+    /** allocatorからマッピングテーブルのノードを確保します
+     *
+     *  XFixedAllocatorを使用する場合は、ブロックサイズをNODE_SIZE以上にしてくだ
+     *  さい。
+     */
+    explicit DBlockDeviceMapper(const DEASTLAllocator& allocator = DEASTLAllocator(EASTL_NAME_VAL("DBlockDeviceMapper")));
 
     void addMap(BlockDevice* device, bd_addr_t virtualBegin, bd_addr_t physicalBegin, bd_size_t size);
     void removeMap(BlockDevice* device);
@@ -62,9 +69,12 @@ private:
         bd_size_t size;
     };
 
-    typedef std::list<Map>  MappingTable;
+    typedef eastl::list<Map, DEASTLAllocator>  MappingTable;
 
     MappingTable    m_mappingTable;
+
+public:
+    static const size_t NODE_SIZE = sizeof(MappingTable::node_type);
 };
 
 
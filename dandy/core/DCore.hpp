@@ -91,11 +91,48 @@
 #endif
 
 
+/** @def    D_HEAP_TRACKING
+ *  @brief  D_NEW()による確保を記録するかどうかです
+ *
+ *  1を定義すると、D_NEW()が確保したファイルと行をDHeapTrackerに記録するように
+ *  なります。解放の検出にmbedのメモリトレースを使うので、
+ *  MBED_MEM_TRACING_ENABLEDも定義してください。詳細は
+ *  dandy/core/memory/DHeapTracker.hppを参照してください。
+ */
+#ifndef D_HEAP_TRACKING
+    #define D_HEAP_TRACKING 0
+#endif
+
+
+#if D_HEAP_TRACKING
+/** D_NEW()を呼び出した位置です
+ */
+struct DHeapSite
+{
+    const char* file;
+    int line;
+    DHeapSite(const char* f, int l) : file(f), line(l) {}
+};
+
+void* operator new(size_t size, const DHeapSite& site);
+void* operator new[](size_t size, const DHeapSite& site);
+void operator delete(void* ptr, const DHeapSite& site);
+void operator delete[](void* ptr, const DHeapSite& site);
+#endif
+
+
 /** @def    D_NEW
  *  @brief  newのラッパーマクロです
+ *
+ *  D_DECLARE_POOLED()などで宣言したクラスのoperator newが使われるように、スコー
+ *  プ解決演算子を付けずにnewを呼び出します。
  */
 #ifndef D_NEW
-    #define D_NEW(constructor) ::new constructor
+    #if D_HEAP_TRACKING
+        #define D_NEW(constructor) new (DHeapSite(__FILE__, __LINE__)) constructor
+    #else
+        #define D_NEW(constructor) new constructor
+    #endif
 #endif
 
 
@@ -0,0 +1,178 @@
+/**
+ *       @file  DFixedString.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/DFixedString.hpp>
+
+
+X_IMPL_RTTI_TAG(D__DFIXEDSTRING_RTTI_TAG) = 0;
+static int D__WriteFixedString(void* self, const void* src, size_t size, size_t* nwritten);
+
+static const XStreamVTable D__fixed_string_vtable = {
+    .m_name = "DFixedString",
+    .m_read_func = NULL,
+    .m_write_func = D__WriteFixedString,
+};
+
+
+void DFixedStringBase::clear()
+{
+    m_length = 0;
+    m_data[0] = '\0';
+    m_overflow = false;
+}
+
+
+DFixedStringBase& DFixedStringBase::assign(const DStringView& str)
+{
+    const size_t n = d_min(str.size(), m_capacity);
+
+    /* 自身の部分文字列が渡される場合があるのでmemmove()を使用します */
+    ::memmove(m_data, str.data(), n);
+    m_length = n;
+    m_data[m_length] = '\0';
+    m_overflow = (n < str.size());
+
+    return *this;
+}
+
+
+DFixedStringBase& DFixedStringBase::append(const DStringView& str)
+{
+    const size_t n = d_min(str.size(), m_capacity - m_length);
+
+    ::memmove(m_data + m_length, str.data(), n);
+    m_length += n;
+    m_data[m_length] = '\0';
+    if (n < str.size())
+        m_overflow = true;
+
+    return *this;
+}
+
+
+DFixedStringBase& DFixedStringBase::append(size_t n, char c)
+{
+    const size_t fill = d_min(n, m_capacity - m_length);
+
+    ::memset(m_data + m_length, c, fill);
+    m_length += fill;
+    m_data[m_length] = '\0';
+    if (fill < n)
+        m_overflow = true;
+
+    return *this;
+}
+
+
+void DFixedStringBase::push_back(char c)
+{
+    this->append(1, c);
+}
+
+
+int DFixedStringBase::format(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    const int len = this->vformat(fmt, args);
+    va_end(args);
+
+    return len;
+}
+
+
+int DFixedStringBase::vformat(const char* fmt, va_list args)
+{
+    this->clear();
+    return this->vappendf(fmt, args);
+}
+
+
+int DFixedStringBase::appendf(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    const int len = this->vappendf(fmt, args);
+    va_end(args);
+
+    return len;
+}
+
+
+int DFixedStringBase::vappendf(const char* fmt, va_list args)
+{
+    /* x_vsnprintf()は切り詰めが発生するとバッファの外に終端文字を書き込むので、
+     * 容量を超えた分を捨てるストリームを経由して書式化します */
+    XStream xst;
+    xstream_init(&xst);
+    xst.m_rtti_tag = &D__DFIXEDSTRING_RTTI_TAG;
+    xst.m_driver = this;
+    xst.m_vtable = &D__fixed_string_vtable;
+
+    const size_t length = m_length;
+    const int len = xstream_vprintf(&xst, fmt, args);
+    if (len < 0)
+    {
+        m_length = length;
+        m_data[m_length] = '\0';
+    }
+
+    return len;
+}
+
+
+void DFixedStringBase::updateLength(bool truncated)
+{
+    m_data[m_capacity] = '\0';
+    m_length = ::strlen(m_data);
+    if (truncated)
+        m_overflow = true;
+}
+
+
+static int D__WriteFixedString(void* self, const void* src, size_t size, size_t* nwritten)
+{
+    DFixedStringBase* const str = static_cast<DFixedStringBase*>(self);
+    str->append(DStringView(static_cast<const char*>(src), size));
+
+    /* 切り詰めた分も書き込んだことにして、書式化を最後まで続けます */
+    *nwritten = size;
+
+    return 0;
+}
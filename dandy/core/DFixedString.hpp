@@ -0,0 +1,296 @@
+/**
+ *       @file  DFixedString.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DFixedString_hpp_
+#define dandy_DFixedString_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+#include <string>
+
+
+class DFixedStringBase;
+
+
+/** 文字列への参照です
+ *
+ *  ポインタと長さだけを保持し、文字列をコピーしません。const char*,
+ *  std::string, DFixedStringから暗黙に変換できるので、文字列を受け取るだけの引
+ *  数に使用すると、呼び出し側で一時的なstd::stringを作る必要がなくなります。
+ *  参照先の文字列はDStringViewより長く生存している必要があり、末尾がヌル文字で
+ *  終端されているとは限りません。
+ */
+class DStringView
+{
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    DStringView()
+        : m_data("")
+        , m_size(0)
+    {
+    }
+
+    DStringView(const char* str)
+        : m_data(str)
+        , m_size(::strlen(str))
+    {
+    }
+
+    DStringView(const char* str, size_t size)
+        : m_data(str)
+        , m_size(size)
+    {
+    }
+
+    DStringView(const std::string& str)
+        : m_data(str.data())
+        , m_size(str.size())
+    {
+    }
+
+    DStringView(const DFixedStringBase& str);
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    size_t length() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+
+    char operator[](size_t i) const
+    {
+        X_ASSERT(i < m_size);
+        return m_data[i];
+    }
+
+    DStringView substr(size_t pos, size_t n = npos) const
+    {
+        X_ASSERT(pos <= m_size);
+        return DStringView(m_data + pos, d_min(n, m_size - pos));
+    }
+
+    int compare(const DStringView& x) const
+    {
+        const int result = ::memcmp(m_data, x.m_data, d_min(m_size, x.m_size));
+        if (result != 0)
+            return result;
+        return (m_size < x.m_size) ? -1 : (m_size > x.m_size) ? 1 : 0;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+};
+
+
+inline bool operator==(const DStringView& a, const DStringView& b)
+{
+    return (a.size() == b.size()) && (a.compare(b) == 0);
+}
+
+
+inline bool operator!=(const DStringView& a, const DStringView& b)
+{
+    return !(a == b);
+}
+
+
+inline bool operator<(const DStringView& a, const DStringView& b)
+{
+    return a.compare(b) < 0;
+}
+
+
+/** DFixedString<N>の容量によらない操作をまとめた基底クラスです
+ *
+ *  文字列を受け取って書き込む関数は、DFixedStringBase*を引数にすることで任意の
+ *  容量のDFixedStringを受け付けます。容量を超える書き込みは切り詰められ、
+ *  overflowed()がtrueになります。動的メモリ確保は行いません。
+ */
+class DFixedStringBase
+{
+public:
+    const char* c_str() const { return m_data; }
+    const char* data() const { return m_data; }
+    char* data() { return m_data; }
+    size_t size() const { return m_length; }
+    size_t length() const { return m_length; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_length == 0; }
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_length; }
+
+    /** 最後のclear(), assign(), format()以降に切り詰めが発生した場合はtrueを返
+     *  します
+     */
+    bool overflowed() const { return m_overflow; }
+
+    char operator[](size_t i) const
+    {
+        X_ASSERT(i < m_length);
+        return m_data[i];
+    }
+
+    char& operator[](size_t i)
+    {
+        X_ASSERT(i < m_length);
+        return m_data[i];
+    }
+
+    void clear();
+    DFixedStringBase& assign(const DStringView& str);
+    DFixedStringBase& append(const DStringView& str);
+    DFixedStringBase& append(size_t n, char c);
+    void push_back(char c);
+
+    DFixedStringBase& operator+=(const DStringView& str) { return this->append(str); }
+    DFixedStringBase& operator+=(char c) { this->push_back(c); return *this; }
+
+    /** printf形式で書式化した文字列を設定します
+     *
+     *  @return 切り詰める前の文字列の長さ。書式のエラー時は負の値
+     */
+    int format(const char* fmt, ...) X_PRINTF_ATTR(2, 3);
+    int vformat(const char* fmt, va_list args);
+
+    /** printf形式で書式化した文字列を末尾に追加します
+     *
+     *  @return 切り詰める前の追加した文字列の長さ。書式のエラー時は負の値
+     */
+    int appendf(const char* fmt, ...) X_PRINTF_ATTR(2, 3);
+    int vappendf(const char* fmt, va_list args);
+
+    /** data()にヌル終端の文字列を直接書き込んだ後に、長さを更新します
+     *
+     *  書き込み時に切り詰めが発生した場合は、truncatedにtrueを渡してください。
+     */
+    void updateLength(bool truncated = false);
+
+protected:
+    DFixedStringBase(char* buffer, size_t capacity)
+        : m_data(buffer)
+        , m_capacity(capacity)
+        , m_length(0)
+        , m_overflow(false)
+    {
+        m_data[0] = '\0';
+    }
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DFixedStringBase);
+
+    char* const m_data;
+    const size_t m_capacity;
+    size_t m_length;
+    bool m_overflow;
+};
+
+
+inline DStringView::DStringView(const DFixedStringBase& str)
+    : m_data(str.data())
+    , m_size(str.size())
+{
+}
+
+
+/** 最大N文字をオブジェクト内のバッファに保持する文字列です
+ *
+ *  ログやシェルで使い捨てる文字列をstd::stringの代わりにスタックへ置くことで、
+ *  ヒープの確保と解放をなくします。
+ *
+ *  @code
+ *  DFixedString<32> str;
+ *  DStringUtils::format(&str, "%d/%d", done, total);
+ *  str += " done";
+ *  @endcode
+ */
+template <size_t N>
+class DFixedString : public DFixedStringBase
+{
+public:
+    DFixedString()
+        : DFixedStringBase(m_buffer, N)
+    {
+    }
+
+    DFixedString(const char* str)
+        : DFixedStringBase(m_buffer, N)
+    {
+        this->assign(str);
+    }
+
+    DFixedString(const DStringView& str)
+        : DFixedStringBase(m_buffer, N)
+    {
+        this->assign(str);
+    }
+
+    DFixedString(const DFixedString& x)
+        : DFixedStringBase(m_buffer, N)
+    {
+        this->assign(x);
+    }
+
+    DFixedString& operator=(const DFixedString& x)
+    {
+        if (this != &x)
+            this->assign(x);
+        return *this;
+    }
+
+    DFixedString& operator=(const DStringView& str)
+    {
+        this->assign(str);
+        return *this;
+    }
+
+    DFixedString& operator=(const char* str)
+    {
+        this->assign(str);
+        return *this;
+    }
+
+private:
+    char m_buffer[N + 1];
+};
+
+
+#endif /* end of include guard: dandy_DFixedString_hpp_ */
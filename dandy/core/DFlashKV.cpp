@@ -0,0 +1,950 @@
+/**
+ *       @file  DFlashKV.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/DFlashKV.hpp>
+
+
+#define D__KV_SECTOR_MAGIC      (0x564B4644UL) /* "DFKV" */
+#define D__KV_ENTRY_MAGIC       (0x4B56U)
+#define D__KV_FLAG_TOMBSTONE    (1U << 0)
+#define D__KV_EMPTY_SLOT        (UINT32_MAX)
+#define D__KV_NO_SLOT           (SIZE_MAX)
+#define D__KV_BUFFER_SIZE       (64)
+#define D__KV_CHUNK_SIZE        (32)
+
+enum
+{
+    D__KV_SECTOR_DIRTY,  /* 消去が必要 */
+    D__KV_SECTOR_ERASED, /* 消去済み */
+    D__KV_SECTOR_USED,   /* ログの一部として使用中 */
+};
+
+typedef MbedCRC<POLY_32BIT_ANSI, 32> D__KVCrc;
+
+
+static uint32_t D__Hash(const char* key, size_t size)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<uint8_t>(key[i]);
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+
+static bool D__IsBlank(const void* p, size_t size)
+{
+    const uint8_t* b = static_cast<const uint8_t*>(p);
+    for (size_t i = 0; i < size; i++)
+    {
+        if (b[i] != 0xFF)
+            return false;
+    }
+
+    return true;
+}
+
+
+DFlashKV::DFlashKV(BlockDevice* blockDevice, bd_addr_t address, bd_size_t size, size_t maxKeys)
+    : m_blockDevice(blockDevice)
+    , m_address(address)
+    , m_sectorSize(0)
+    , m_sectorCount(0)
+    , m_programSize(0)
+    , m_sectors(nullptr)
+    , m_slots(nullptr)
+    , m_slotMask(0)
+    , m_maxKeys(maxKeys)
+    , m_count(0)
+    , m_liveSize(0)
+    , m_head(0)
+    , m_tail(0)
+    , m_usedSectors(0)
+    , m_nextSeq(0)
+    , m_gcOffset(0)
+    , m_buffer(nullptr)
+    , m_writeOffset(0)
+    , m_bufferFill(0)
+    , m_mounted(false)
+{
+    X_ASSERT(m_blockDevice);
+    X_ASSERT(m_maxKeys > 0);
+
+    m_sectorSize = m_blockDevice->get_erase_size();
+    m_programSize = m_blockDevice->get_program_size();
+    X_ASSERT(m_sectorSize > 0);
+    X_ASSERT((D__KV_BUFFER_SIZE % m_programSize) == 0);
+    X_ASSERT((address % m_sectorSize) == 0);
+    X_ASSERT((size % m_sectorSize) == 0);
+
+    m_sectorCount = size / m_sectorSize;
+    X_ASSERT(m_sectorCount >= 2);
+
+    /* 負荷率を50%以下に抑えて、探索が必ず空きスロットで止まるようにする */
+    const size_t slotCount = x_roundup_power_of_two(m_maxKeys * 2);
+    m_slotMask = slotCount - 1;
+
+    m_sectors = D_NEW(Sector[m_sectorCount]);
+    m_slots = D_NEW(Slot[slotCount]);
+    m_buffer = D_NEW(uint8_t[D__KV_BUFFER_SIZE]);
+    X_ASSERT(m_sectors);
+    X_ASSERT(m_slots);
+    X_ASSERT(m_buffer);
+
+    this->ResetState();
+}
+
+DFlashKV::~DFlashKV()
+{
+    D_SAFE_DELETE_ARRAY(m_buffer);
+    D_SAFE_DELETE_ARRAY(m_slots);
+    D_SAFE_DELETE_ARRAY(m_sectors);
+}
+
+int DFlashKV::mount()
+{
+    this->ResetState();
+
+    int result;
+    bool found = false;
+    for (uint32_t i = 0; i < m_sectorCount; i++)
+    {
+        SectorHeader header;
+        result = m_blockDevice->read(&header, this->Address(i * m_sectorSize), sizeof(header));
+        if (result != 0)
+            return result;
+
+        /* 書きかけのヘッダのシーケンス番号を信用しないように反転値と照合する */
+        if ((header.magic != D__KV_SECTOR_MAGIC) || (header.seq != ~header.seqInv))
+            continue;
+
+        m_sectors[i].state = D__KV_SECTOR_USED;
+        m_sectors[i].seq = header.seq;
+        if (!found || (static_cast<int32_t>(header.seq - m_sectors[m_tail].seq) < 0))
+            m_tail = i;
+        found = true;
+    }
+
+    if (!found)
+        return -ENOENT;
+
+    /* 最も古いセクタから、シーケンス番号が連続している範囲がログになる。それ以
+     * 外のセクタはコンパクションや消去の途中で電源が落ちた残骸なので、次に使う
+     * 時に消去する。
+     */
+    m_head = m_tail;
+    m_usedSectors = 1;
+    for (;;)
+    {
+        const uint32_t next = (m_head + 1) % m_sectorCount;
+        if ((next == m_tail) ||
+            (m_sectors[next].state != D__KV_SECTOR_USED) ||
+            (m_sectors[next].seq != m_sectors[m_head].seq + 1))
+            break;
+        m_head = next;
+        m_usedSectors++;
+    }
+
+    /* 空きセクタが1つもないのはコンパクションの途中で電源が落ちた時だけで、そ
+     * の場合のヘッドには最も古いセクタから移動したエントリの複製しかない。複製
+     * 元はまだ残っているので、ヘッドを捨ててコンパクションをやり直す。
+     */
+    if (m_usedSectors == m_sectorCount)
+    {
+        m_head = (m_head + m_sectorCount - 1) % m_sectorCount;
+        m_usedSectors--;
+    }
+
+    for (uint32_t i = 0; i < m_sectorCount; i++)
+    {
+        const uint32_t distance = (i + m_sectorCount - m_tail) % m_sectorCount;
+        if (distance >= m_usedSectors)
+            m_sectors[i].state = D__KV_SECTOR_DIRTY;
+    }
+
+    m_nextSeq = m_sectors[m_head].seq + 1;
+
+    for (uint32_t n = 0; n < m_usedSectors; n++)
+    {
+        result = this->ScanSector((m_tail + n) % m_sectorCount);
+        if (result != 0)
+            return result;
+    }
+
+    m_mounted = true;
+
+    return 0;
+}
+
+int DFlashKV::format()
+{
+    this->ResetState();
+
+    int result = m_blockDevice->erase(m_address, m_sectorSize * m_sectorCount);
+    if (result != 0)
+        return result;
+
+    for (uint32_t i = 0; i < m_sectorCount; i++)
+        m_sectors[i].state = D__KV_SECTOR_ERASED;
+
+    result = this->OpenSector(0);
+    if (result != 0)
+        return result;
+
+    m_mounted = true;
+
+    return 0;
+}
+
+int DFlashKV::set(const char* key, const void* value, size_t size)
+{
+    X_ASSERT(m_mounted);
+    X_ASSERT(key);
+    X_ASSERT(value || (size == 0));
+
+    const size_t keySize = ::strlen(key);
+    if ((keySize == 0) || (keySize > MAX_KEY_SIZE))
+        return -EINVAL;
+
+    EntryHeader header;
+    header.magic = D__KV_ENTRY_MAGIC;
+    header.keySize = keySize;
+    header.flags = 0;
+    header.valueSize = size;
+    header.hash = D__Hash(key, keySize);
+
+    const uint32_t entrySize = this->EntrySize(header);
+    if (entrySize > m_sectorSize - this->HeaderSize())
+        return -EINVAL;
+
+    size_t slotIndex;
+    const int found = this->Lookup(key, keySize, header.hash, &slotIndex);
+    if (found < 0)
+        return found;
+
+    if (!found && (m_count >= m_maxKeys))
+        return -ENOMEM;
+
+    bd_size_t oldSize = 0;
+    if (found)
+    {
+        EntryHeader old;
+        const int result = this->ReadHeader(m_slots[slotIndex].offset, &old);
+        if (result != 0)
+            return result;
+        oldSize = this->EntrySize(old);
+    }
+
+    /* 予備の1セクタを除いた領域に有効なエントリが収まらなければ、コンパクショ
+     * ンをしても空きは作れない。
+     */
+    const bd_size_t capacity = static_cast<bd_size_t>(m_sectorCount - 1) * (m_sectorSize - this->HeaderSize());
+    if (m_liveSize - oldSize + entrySize > capacity)
+        return -ENOSPC;
+
+    uint32_t offset;
+    int result = this->Append(header, key, value, &offset);
+    if (result != 0)
+        return result;
+
+    /* Append()中のコンパクションでスロットのオフセットは変わっている可能性がある
+     * が、スロットの位置は変わらない。
+     */
+    if (found)
+    {
+        result = this->Supersede(slotIndex);
+        if (result != 0)
+            return result;
+    }
+    else
+    {
+        m_count++;
+    }
+
+    m_slots[slotIndex].hash = header.hash;
+    m_slots[slotIndex].offset = offset;
+    m_liveSize += entrySize;
+    m_sectors[this->SectorOf(offset)].live += entrySize;
+
+    return 0;
+}
+
+int DFlashKV::get(const char* key, void* dst, size_t size, size_t* actualSize)
+{
+    X_ASSERT(m_mounted);
+    X_ASSERT(key);
+    X_ASSERT(dst || (size == 0));
+
+    const size_t keySize = ::strlen(key);
+    size_t slotIndex;
+    const int found = this->Lookup(key, keySize, D__Hash(key, keySize), &slotIndex);
+    if (found < 0)
+        return found;
+    if (!found)
+        return -ENOENT;
+
+    const uint32_t offset = m_slots[slotIndex].offset;
+    EntryHeader header;
+    int result = this->ReadHeader(offset, &header);
+    if (result != 0)
+        return result;
+
+    const size_t toRead = X_MIN(size, static_cast<size_t>(header.valueSize));
+    if (toRead)
+    {
+        result = m_blockDevice->read(dst, this->Address(offset + sizeof(header) + keySize), toRead);
+        if (result != 0)
+            return result;
+    }
+
+    X_ASSIGN_NOT_NULL(actualSize, header.valueSize);
+
+    return 0;
+}
+
+int DFlashKV::remove(const char* key)
+{
+    X_ASSERT(m_mounted);
+    X_ASSERT(key);
+
+    const size_t keySize = ::strlen(key);
+    EntryHeader header;
+    header.magic = D__KV_ENTRY_MAGIC;
+    header.keySize = keySize;
+    header.flags = D__KV_FLAG_TOMBSTONE;
+    header.valueSize = 0;
+    header.hash = D__Hash(key, keySize);
+
+    size_t slotIndex;
+    const int found = this->Lookup(key, keySize, header.hash, &slotIndex);
+    if (found < 0)
+        return found;
+    if (!found)
+        return -ENOENT;
+
+    uint32_t offset;
+    int result = this->Append(header, key, nullptr, &offset);
+    if (result != 0)
+        return result;
+
+    result = this->Supersede(slotIndex);
+    if (result != 0)
+        return result;
+
+    this->IndexRemove(slotIndex);
+    m_count--;
+
+    return 0;
+}
+
+bool DFlashKV::has(const char* key)
+{
+    X_ASSERT(m_mounted);
+    X_ASSERT(key);
+
+    const size_t keySize = ::strlen(key);
+    size_t slotIndex;
+
+    return this->Lookup(key, keySize, D__Hash(key, keySize), &slotIndex) > 0;
+}
+
+int DFlashKV::compact(size_t maxEntries)
+{
+    X_ASSERT(m_mounted);
+
+    if (m_tail == m_head)
+        return 0;
+
+    /* 最も古いセクタに無効なエントリがなければ、移動しても空きは増えない */
+    const Sector& tail = m_sectors[m_tail];
+    if ((m_gcOffset == this->HeaderSize()) &&
+        (tail.live + this->HeaderSize() >= tail.used))
+        return 0;
+
+    return this->CollectTail(maxEntries);
+}
+
+void DFlashKV::ResetState()
+{
+    for (size_t i = 0; i <= m_slotMask; i++)
+    {
+        m_slots[i].hash = 0;
+        m_slots[i].offset = D__KV_EMPTY_SLOT;
+    }
+
+    for (uint32_t i = 0; i < m_sectorCount; i++)
+    {
+        m_sectors[i].seq = 0;
+        m_sectors[i].used = 0;
+        m_sectors[i].live = 0;
+        m_sectors[i].state = D__KV_SECTOR_DIRTY;
+    }
+
+    m_count = 0;
+    m_liveSize = 0;
+    m_head = 0;
+    m_tail = 0;
+    m_usedSectors = 0;
+    m_nextSeq = 1;
+    m_gcOffset = this->HeaderSize();
+    m_bufferFill = 0;
+    m_mounted = false;
+}
+
+int DFlashKV::Lookup(const char* key, size_t keySize, uint32_t hash, size_t* slotIndex)
+{
+    size_t i = hash & m_slotMask;
+    for (;;)
+    {
+        const Slot& slot = m_slots[i];
+        if (slot.offset == D__KV_EMPTY_SLOT)
+        {
+            *slotIndex = i;
+            return 0;
+        }
+
+        if (slot.hash == hash)
+        {
+            bool equal;
+            const int result = this->KeyEquals(slot.offset, key, keySize, &equal);
+            if (result != 0)
+                return result;
+
+            if (equal)
+            {
+                *slotIndex = i;
+                return 1;
+            }
+        }
+
+        i = (i + 1) & m_slotMask;
+    }
+}
+
+size_t DFlashKV::FindSlot(uint32_t hash, uint32_t offset) const
+{
+    size_t i = hash & m_slotMask;
+    for (;;)
+    {
+        const Slot& slot = m_slots[i];
+        if (slot.offset == D__KV_EMPTY_SLOT)
+            return D__KV_NO_SLOT;
+        if (slot.offset == offset)
+            return i;
+        i = (i + 1) & m_slotMask;
+    }
+}
+
+void DFlashKV::IndexRemove(size_t slotIndex)
+{
+    /* 線形探索法の後方シフト削除。墓標を使わないので探索長が劣化しない。 */
+    size_t i = slotIndex;
+    size_t j = slotIndex;
+    for (;;)
+    {
+        j = (j + 1) & m_slotMask;
+        if (m_slots[j].offset == D__KV_EMPTY_SLOT)
+            break;
+
+        const size_t home = m_slots[j].hash & m_slotMask;
+        const bool stay = (i <= j) ? ((i < home) && (home <= j))
+                                   : ((i < home) || (home <= j));
+        if (stay)
+            continue;
+
+        m_slots[i] = m_slots[j];
+        i = j;
+    }
+
+    m_slots[i].hash = 0;
+    m_slots[i].offset = D__KV_EMPTY_SLOT;
+}
+
+int DFlashKV::KeyEquals(uint32_t offset, const char* key, size_t keySize, bool* equal)
+{
+    EntryHeader header;
+    int result = this->ReadHeader(offset, &header);
+    if (result != 0)
+        return result;
+
+    *equal = false;
+    if (header.keySize != keySize)
+        return 0;
+
+    uint8_t chunk[D__KV_CHUNK_SIZE];
+    offset += sizeof(header);
+    while (keySize)
+    {
+        const size_t n = X_MIN(keySize, sizeof(chunk));
+        result = m_blockDevice->read(chunk, this->Address(offset), n);
+        if (result != 0)
+            return result;
+
+        if (::memcmp(chunk, key, n) != 0)
+            return 0;
+
+        key += n;
+        offset += n;
+        keySize -= n;
+    }
+
+    *equal = true;
+
+    return 0;
+}
+
+int DFlashKV::ReadHeader(uint32_t offset, EntryHeader* header)
+{
+    return m_blockDevice->read(header, this->Address(offset), sizeof(*header));
+}
+
+int DFlashKV::VerifyEntry(uint32_t offset, const EntryHeader& header, bool* valid)
+{
+    D__KVCrc ct;
+    uint32_t crc;
+    ct.compute_partial_start(&crc);
+    ct.compute_partial(const_cast<EntryHeader*>(&header), X_OFFSET_OF(EntryHeader, crc), &crc);
+
+    uint8_t chunk[D__KV_CHUNK_SIZE];
+    uint32_t remain = header.keySize + header.valueSize;
+    offset += sizeof(header);
+    while (remain)
+    {
+        const uint32_t n = X_MIN(remain, sizeof(chunk));
+        const int result = m_blockDevice->read(chunk, this->Address(offset), n);
+        if (result != 0)
+            return result;
+
+        ct.compute_partial(chunk, n, &crc);
+        offset += n;
+        remain -= n;
+    }
+    ct.compute_partial_stop(&crc);
+
+    *valid = (crc == header.crc);
+
+    return 0;
+}
+
+int DFlashKV::ScanSector(uint32_t sector)
+{
+    Sector& s = m_sectors[sector];
+    const uint32_t base = sector * m_sectorSize;
+    uint32_t pos = this->HeaderSize();
+    char key[MAX_KEY_SIZE];
+    int result;
+
+    while (pos + sizeof(EntryHeader) <= m_sectorSize)
+    {
+        EntryHeader header;
+        result = this->ReadHeader(base + pos, &header);
+        if (result != 0)
+            return result;
+
+        if (D__IsBlank(&header, sizeof(header)))
+            break;
+
+        /* 書き込み途中で途切れたエントリ以降は信用できないので、このセクタには
+         * もう追記しない。
+         */
+        bool valid = (header.magic == D__KV_ENTRY_MAGIC) &&
+                     (header.keySize > 0) &&
+                     (header.valueSize < m_sectorSize) &&
+                     (this->EntrySize(header) <= m_sectorSize - pos);
+        if (valid)
+        {
+            result = this->VerifyEntry(base + pos, header, &valid);
+            if (result != 0)
+                return result;
+        }
+
+        if (!valid)
+        {
+            X_LOG_WARN(("DFlashKV", "broken entry at 0x%08X", static_cast<unsigned>(base + pos)));
+            pos = m_sectorSize;
+            break;
+        }
+
+        const uint32_t entrySize = this->EntrySize(header);
+        result = m_blockDevice->read(key, this->Address(base + pos + sizeof(header)), header.keySize);
+        if (result != 0)
+            return result;
+
+        size_t slotIndex;
+        const int found = this->Lookup(key, header.keySize, header.hash, &slotIndex);
+        if (found < 0)
+            return found;
+
+        if (found)
+        {
+            result = this->Supersede(slotIndex);
+            if (result != 0)
+                return result;
+        }
+
+        if (header.flags & D__KV_FLAG_TOMBSTONE)
+        {
+            if (found)
+            {
+                this->IndexRemove(slotIndex);
+                m_count--;
+            }
+        }
+        else
+        {
+            if (!found)
+            {
+                if (m_count >= m_maxKeys)
+                    return -ENOMEM;
+                m_count++;
+            }
+            m_slots[slotIndex].hash = header.hash;
+            m_slots[slotIndex].offset = base + pos;
+            m_liveSize += entrySize;
+            s.live += entrySize;
+        }
+
+        pos += entrySize;
+    }
+
+    s.used = pos;
+
+    return 0;
+}
+
+int DFlashKV::Supersede(size_t slotIndex)
+{
+    const uint32_t offset = m_slots[slotIndex].offset;
+    EntryHeader old;
+    const int result = this->ReadHeader(offset, &old);
+    if (result != 0)
+        return result;
+
+    const uint32_t oldSize = this->EntrySize(old);
+    m_liveSize -= oldSize;
+    m_sectors[this->SectorOf(offset)].live -= oldSize;
+
+    return 0;
+}
+
+int DFlashKV::Append(const EntryHeader& header, const char* key, const void* value, uint32_t* offset)
+{
+    EntryHeader h = header;
+    D__KVCrc ct;
+    ct.compute_partial_start(&h.crc);
+    ct.compute_partial(&h, X_OFFSET_OF(EntryHeader, crc), &h.crc);
+    ct.compute_partial(const_cast<char*>(key), h.keySize, &h.crc);
+    if (h.valueSize)
+        ct.compute_partial(const_cast<void*>(value), h.valueSize, &h.crc);
+    ct.compute_partial_stop(&h.crc);
+
+    const uint32_t entrySize = this->EntrySize(h);
+    int result = this->Reserve(entrySize, false);
+    if (result != 0)
+        return result;
+
+    Sector& head = m_sectors[m_head];
+    *offset = m_head * m_sectorSize + head.used;
+
+    this->BeginWrite(*offset);
+    result = this->Write(&h, sizeof(h));
+    if (result == 0)
+        result = this->Write(key, h.keySize);
+    if ((result == 0) && h.valueSize)
+        result = this->Write(value, h.valueSize);
+    if (result == 0)
+        result = this->EndWrite();
+
+    /* 失敗しても書きかけの領域は再利用できないので進めておく */
+    head.used += entrySize;
+
+    return result;
+}
+
+int DFlashKV::CopyEntry(uint32_t offset, uint32_t entrySize, uint32_t* newOffset)
+{
+    int result = this->Reserve(entrySize, true);
+    if (result != 0)
+        return result;
+
+    Sector& head = m_sectors[m_head];
+    *newOffset = m_head * m_sectorSize + head.used;
+    head.used += entrySize;
+
+    uint8_t chunk[D__KV_CHUNK_SIZE];
+    uint32_t remain = entrySize;
+    this->BeginWrite(*newOffset);
+    while (remain)
+    {
+        const uint32_t n = X_MIN(remain, sizeof(chunk));
+        result = m_blockDevice->read(chunk, this->Address(offset), n);
+        if (result != 0)
+            return result;
+
+        result = this->Write(chunk, n);
+        if (result != 0)
+            return result;
+
+        offset += n;
+        remain -= n;
+    }
+
+    return this->EndWrite();
+}
+
+int DFlashKV::Reserve(uint32_t entrySize, bool useReserve)
+{
+    /* 通常の書き込みでは、コンパクション用に常に1セクタを空けておく */
+    const uint32_t reserved = useReserve ? 0 : 1;
+
+    for (uint32_t retry = 0; retry <= m_sectorCount * 2; retry++)
+    {
+        /* 予備のセクタを使ったコンパクションの途中では、ヘッドに通常のエントリ
+         * を書き込んではいけない。空きセクタがない状態で電源が落ちると、mount()
+         * はヘッドを複製だけのセクタとして捨てるからである。先に最も古いセクタ
+         * の移動を終わらせて解放する。
+         */
+        if (!useReserve && (this->freeSectors() == 0))
+        {
+            const int result = this->CollectTail(SIZE_MAX);
+            if (result != 0)
+                return result;
+            continue;
+        }
+
+        if (m_sectors[m_head].used + entrySize <= m_sectorSize)
+            return 0;
+
+        if (this->freeSectors() > reserved)
+            return this->OpenSector((m_head + 1) % m_sectorCount);
+
+        if (useReserve)
+            break;
+
+        const int result = this->CollectTail(SIZE_MAX);
+        if (result != 0)
+            return result;
+    }
+
+    return -ENOSPC;
+}
+
+int DFlashKV::OpenSector(uint32_t sector)
+{
+    Sector& s = m_sectors[sector];
+    int result;
+
+    if (s.state != D__KV_SECTOR_ERASED)
+    {
+        result = m_blockDevice->erase(this->Address(sector * m_sectorSize), m_sectorSize);
+        if (result != 0)
+            return result;
+        s.state = D__KV_SECTOR_ERASED;
+    }
+
+    SectorHeader header;
+    header.magic = D__KV_SECTOR_MAGIC;
+    header.seq = m_nextSeq;
+    header.seqInv = ~m_nextSeq;
+
+    this->BeginWrite(sector * m_sectorSize);
+    result = this->Write(&header, sizeof(header));
+    if (result == 0)
+        result = this->EndWrite();
+    if (result != 0)
+        return result;
+
+    s.seq = m_nextSeq++;
+    s.used = this->HeaderSize();
+    s.live = 0;
+    s.state = D__KV_SECTOR_USED;
+    m_head = sector;
+    m_usedSectors++;
+
+    return 0;
+}
+
+int DFlashKV::ReleaseTail()
+{
+    X_ASSERT(m_tail != m_head);
+
+    /* 消去中に電源が落ちると中途半端なデータが残るので、先にセクタヘッダを0で
+     * 上書きしてログから外しておく。
+     */
+    const SectorHeader header = { 0, 0, 0 };
+    this->BeginWrite(m_tail * m_sectorSize);
+    int result = this->Write(&header, sizeof(header));
+    if (result == 0)
+        result = this->EndWrite();
+    if (result != 0)
+        return result;
+
+    const uint32_t sector = m_tail;
+    Sector& s = m_sectors[sector];
+    s.seq = 0;
+    s.used = 0;
+    s.live = 0;
+    s.state = D__KV_SECTOR_DIRTY;
+    m_usedSectors--;
+    m_tail = (m_tail + 1) % m_sectorCount;
+    m_gcOffset = this->HeaderSize();
+
+    /* 消去は次にセクタを使う時まで遅らせる。DEraseAheadBlockDeviceのように
+     * trim()で消去を先行できるデバイスであれば、その時には消去が済んでいる。
+     */
+    return m_blockDevice->trim(this->Address(sector * m_sectorSize), m_sectorSize);
+}
+
+int DFlashKV::CollectTail(size_t maxEntries)
+{
+    int result;
+
+    if (m_tail == m_head)
+    {
+        if (m_sectors[m_head].used == this->HeaderSize())
+            return 0;
+
+        /* ヘッドを移さないと、移動したエントリを自分自身に書き込むことになる */
+        if (this->freeSectors() == 0)
+            return -ENOSPC;
+        result = this->OpenSector((m_head + 1) % m_sectorCount);
+        if (result != 0)
+            return result;
+    }
+
+    const uint32_t base = m_tail * m_sectorSize;
+    const Sector& tail = m_sectors[m_tail];
+
+    for (size_t n = 0; (n < maxEntries) && (m_gcOffset < tail.used); n++)
+    {
+        EntryHeader header;
+        result = this->ReadHeader(base + m_gcOffset, &header);
+        if (result != 0)
+            return result;
+
+        const uint32_t entrySize = this->EntrySize(header);
+        if ((header.magic != D__KV_ENTRY_MAGIC) ||
+            (header.valueSize >= m_sectorSize) ||
+            (entrySize > tail.used - m_gcOffset))
+        {
+            /* mount()時に見つかった書きかけのエントリ。以降は全て無効。 */
+            m_gcOffset = tail.used;
+            break;
+        }
+
+        if (!(header.flags & D__KV_FLAG_TOMBSTONE))
+        {
+            const size_t slotIndex = this->FindSlot(header.hash, base + m_gcOffset);
+            if (slotIndex != D__KV_NO_SLOT)
+            {
+                uint32_t newOffset;
+                result = this->CopyEntry(base + m_gcOffset, entrySize, &newOffset);
+                if (result != 0)
+                    return result;
+
+                m_slots[slotIndex].offset = newOffset;
+                m_sectors[m_tail].live -= entrySize;
+                m_sectors[this->SectorOf(newOffset)].live += entrySize;
+            }
+        }
+
+        m_gcOffset += entrySize;
+    }
+
+    if (m_gcOffset >= tail.used)
+        return this->ReleaseTail();
+
+    return 0;
+}
+
+void DFlashKV::BeginWrite(uint32_t offset)
+{
+    X_ASSERT((offset % m_programSize) == 0);
+    m_writeOffset = offset;
+    m_bufferFill = 0;
+}
+
+int DFlashKV::Write(const void* src, uint32_t size)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(src);
+    while (size)
+    {
+        const uint32_t n = X_MIN(size, D__KV_BUFFER_SIZE - m_bufferFill);
+        ::memcpy(m_buffer + m_bufferFill, p, n);
+        m_bufferFill += n;
+        p += n;
+        size -= n;
+
+        if (m_bufferFill == D__KV_BUFFER_SIZE)
+        {
+            const int result = m_blockDevice->program(m_buffer, this->Address(m_writeOffset), D__KV_BUFFER_SIZE);
+            if (result != 0)
+                return result;
+            m_writeOffset += D__KV_BUFFER_SIZE;
+            m_bufferFill = 0;
+        }
+    }
+
+    return 0;
+}
+
+int DFlashKV::EndWrite()
+{
+    if (!m_bufferFill)
+        return 0;
+
+    /* 消去値で埋めれば余りの部分は未書き込みのままになる */
+    const uint32_t size = this->Align(m_bufferFill);
+    ::memset(m_buffer + m_bufferFill, 0xFF, size - m_bufferFill);
+
+    const int result = m_blockDevice->program(m_buffer, this->Address(m_writeOffset), size);
+    m_writeOffset += size;
+    m_bufferFill = 0;
+
+    return result;
+}
+
+uint32_t DFlashKV::EntrySize(const EntryHeader& header) const
+{
+    return this->Align(sizeof(EntryHeader) + header.keySize + header.valueSize);
+}
@@ -0,0 +1,231 @@
+/**
+ *       @file  DFlashKV.hpp
+ *      @brief  BlockDevice上のログ構造キー・バリューストアです
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DFlashKV_hpp_
+#define dandy_DFlashKV_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+
+
+/** BlockDevice上のログ構造キー・バリューストアです
+ *
+ *  指定領域をeraseサイズ単位のセクタに分割してリングログとして扱います。値の更
+ *  新は常にログの末尾への追記で行い、古いエントリは次のエントリが書き込まれた時
+ *  点で無効になります。エントリはCRCで保護されているので、書き込み中に電源が落
+ *  ちても、更新前か更新後のどちらかの値が残ります。
+ *
+ *  RAM上にはキーのハッシュ値からフラッシュ上のオフセットを引くオープンアドレス
+ *  法のインデックスを持ち、get()はインデックスを引いてから1回の読み出しで完了し
+ *  ます。
+ *
+ *  空きセクタが少なくなると、最も古いセクタの有効なエントリをログの末尾に移動し
+ *  てからセクタを消去します。compact()を使用すると、この処理を任意のタイミング
+ *  で少しずつ進めることができます。
+ *
+ *  @code
+ *  DFlashKV kv(&flash, 0x10000, 0x8000);
+ *  if (kv.mount() != 0)
+ *      kv.format();
+ *
+ *  const uint32_t gain = 1234;
+ *  kv.set("gain", &gain, sizeof(gain));
+ *
+ *  uint32_t v;
+ *  kv.get("gain", &v, sizeof(v));
+ *  @endcode
+ */
+class DFlashKV
+{
+public:
+
+    /** キーの最大長です
+     */
+    static const size_t MAX_KEY_SIZE = 255;
+
+
+    /** ストアを構築します
+     *
+     *  address, sizeはblockDevice->get_erase_size()の倍数で、2セクタ以上でなけれ
+     *  ばなりません。maxKeysは保持可能なキーの最大数で、インデックスのサイズを決
+     *  めます。
+     */
+    DFlashKV(BlockDevice* blockDevice, bd_addr_t address, bd_size_t size, size_t maxKeys = 64);
+    ~DFlashKV();
+
+
+    /** フラッシュ上のログを走査してインデックスを構築します
+     *
+     *  有効なログが1つもない場合は-ENOENTを返します。
+     */
+    int mount();
+
+
+    /** 領域を消去して空のストアを作成します
+     */
+    int format();
+
+
+    /** keyに値を設定します
+     */
+    int set(const char* key, const void* value, size_t size);
+
+
+    /** keyの値をdstに読み出します
+     *
+     *  dstにはsizeバイトまでしか書き込みません。actualSizeには格納されている値
+     *  のサイズを返します。
+     */
+    int get(const char* key, void* dst, size_t size, size_t* actualSize = nullptr);
+
+
+    /** keyを削除します
+     */
+    int remove(const char* key);
+
+
+    /** keyが存在するかどうかを返します
+     */
+    bool has(const char* key);
+
+
+    /** 最も古いセクタのコンパクションを最大maxEntriesエントリ分進めます
+     *
+     *  セクタ内の全エントリの処理が終わるとセクタを消去します。アイドル時に少し
+     *  ずつ呼び出しておくと、set()中にコンパクションが走ることを避けられます。
+     */
+    int compact(size_t maxEntries = 8);
+
+
+    /** 格納されているキーの数を返します
+     */
+    size_t count() const { return m_count; }
+
+
+    /** 有効なエントリが占有しているバイト数を返します
+     */
+    bd_size_t usedSize() const { return m_liveSize; }
+
+
+    /** 新しいエントリに使用できる空きセクタの数を返します
+     */
+    size_t freeSectors() const { return m_sectorCount - m_usedSectors; }
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DFlashKV);
+
+    struct EntryHeader
+    {
+        uint16_t magic;
+        uint8_t  keySize;
+        uint8_t  flags;
+        uint32_t valueSize;
+        uint32_t hash;
+        uint32_t crc;
+    };
+
+    struct SectorHeader
+    {
+        uint32_t magic;
+        uint32_t seq;
+        uint32_t seqInv;
+    };
+
+    struct Sector
+    {
+        uint32_t seq;
+        uint32_t used;
+        uint32_t live;
+        uint8_t  state;
+    };
+
+    struct Slot
+    {
+        uint32_t hash;
+        uint32_t offset;
+    };
+
+    void ResetState();
+    int Lookup(const char* key, size_t keySize, uint32_t hash, size_t* slotIndex);
+    size_t FindSlot(uint32_t hash, uint32_t offset) const;
+    void IndexRemove(size_t slotIndex);
+    int KeyEquals(uint32_t offset, const char* key, size_t keySize, bool* equal);
+    int ReadHeader(uint32_t offset, EntryHeader* header);
+    int VerifyEntry(uint32_t offset, const EntryHeader& header, bool* valid);
+    int ScanSector(uint32_t sector);
+    int Supersede(size_t slotIndex);
+    int Append(const EntryHeader& header, const char* key, const void* value, uint32_t* offset);
+    int CopyEntry(uint32_t offset, uint32_t entrySize, uint32_t* newOffset);
+    int Reserve(uint32_t entrySize, bool useReserve);
+    int OpenSector(uint32_t sector);
+    int ReleaseTail();
+    int CollectTail(size_t maxEntries);
+    void BeginWrite(uint32_t offset);
+    int Write(const void* src, uint32_t size);
+    int EndWrite();
+    uint32_t EntrySize(const EntryHeader& header) const;
+    uint32_t HeaderSize() const { return this->Align(sizeof(SectorHeader)); }
+    uint32_t Align(uint32_t size) const { return X_ROUNDUP_MULTIPLE(size, m_programSize); }
+    bd_addr_t Address(uint32_t offset) const { return m_address + offset; }
+    uint32_t SectorOf(uint32_t offset) const { return offset / m_sectorSize; }
+
+    BlockDevice* m_blockDevice;
+    bd_addr_t m_address;
+    uint32_t m_sectorSize;
+    uint32_t m_sectorCount;
+    uint32_t m_programSize;
+    Sector* m_sectors;
+    Slot* m_slots;
+    size_t m_slotMask;
+    size_t m_maxKeys;
+    size_t m_count;
+    bd_size_t m_liveSize;
+    uint32_t m_head;
+    uint32_t m_tail;
+    uint32_t m_usedSectors;
+    uint32_t m_nextSeq;
+    uint32_t m_gcOffset;
+    uint8_t* m_buffer;
+    uint32_t m_writeOffset;
+    uint32_t m_bufferFill;
+    bool m_mounted;
+};
+
+
+#endif /* end of include guard: dandy_DFlashKV_hpp_ */
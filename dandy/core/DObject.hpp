@@ -42,15 +42,37 @@
 
 
 #include <dandy/core/DRTTI.hpp>
+#include <dandy/core/DFixedString.hpp>
 #include <string>
 
 
+#ifndef D_OBJECT_STRING_MAX_LENGTH
+    /* to_string()がstd::stringを返す際に使用するバッファの文字数です */
+    #define D_OBJECT_STRING_MAX_LENGTH  (64)
+#endif
+
+
 class DObject
 {
 public:
     D_DECLARE_RTTI;
     virtual ~DObject() {}
-    virtual std::string to_string() const { return "DObject"; }
+
+    virtual std::string to_string() const
+    {
+        DFixedString<D_OBJECT_STRING_MAX_LENGTH> str;
+        this->to_string(&str);
+        return std::string(str.c_str(), str.size());
+    }
+
+    /** オブジェクトの文字列表現をdstに設定します。動的メモリ確保は行いません
+     *
+     *  派生クラスではこちらをオーバーライドしてください。std::stringを返す
+     *  to_string()はこの関数の結果を返します。派生クラスで片方だけをオーバーラ
+     *  イドすると、もう片方が隠れるので、using DObject::to_string;を記述してく
+     *  ださい。
+     */
+    virtual void to_string(DFixedStringBase* dst) const { dst->assign("DObject"); }
 };
 
 
@@ -37,45 +37,205 @@
  */
 
 #include <dandy/core/DObjectStorage.hpp>
-#include <utility>
+#include <dandy/core/DStringPool.hpp>
 
 
+static_assert((DObjectStorage::CAPACITY & (DObjectStorage::CAPACITY - 1)) == 0,
+              "D_OBJECT_STORAGE_CAPACITY must be a power of 2");
+static const size_t D__MASK = DObjectStorage::CAPACITY - 1;
+static const size_t D__MAX_COUNT = DObjectStorage::CAPACITY * 3 / 4;
 static SingletonPtr<DObjectStorage> _shared_instance;
 
 
+static inline void D__memoryBarrier()
+{
+#if defined(__CORTEX_M)
+    __DMB();
+#else
+    __sync_synchronize();
+#endif
+}
+
+
+DObjectStorage::DObjectStorage()
+    : m_count(0)
+    , m_sequence(0)
+{
+    std::memset(m_entries, 0, sizeof(m_entries));
+}
+
 DObjectStorage* DObjectStorage::shared()
 {
     return _shared_instance.get();
 }
 
-void DObjectStorage::put(const char* name, DObject* obj)
+bool DObjectStorage::put(const char* name, DObject* obj)
 {
-    m_map.insert(std::make_pair(name, obj));
+    const uint32_t hash = d_fnv1a(name);
+    const char* const key = DStringPool::shared()->intern(name);
+    bool ret = false;
+
+    m_mutex.lock();
+
+    const size_t index = Find(key, hash);
+    if (!m_entries[index].name && (m_count < D__MAX_COUNT))
+    {
+        BeginWrite();
+        Entry& entry = m_entries[index];
+        entry.hash = hash;
+        entry.obj = obj;
+        entry.name = key;
+        m_count++;
+        EndWrite();
+        ret = true;
+    }
+
+    m_mutex.unlock();
+
+    return ret;
 }
 
 bool DObjectStorage::has(const char* name)
 {
-    return m_map.find(name) != m_map.end();
+    return has(name, d_fnv1a(name));
+}
+
+bool DObjectStorage::has(const char* name, uint32_t hash)
+{
+    DObject* obj;
+    return Lookup(name, hash, &obj);
 }
 
 DObject* DObjectStorage::get(const char* name)
 {
-    DObjectMap::iterator ret = m_map.find(name);
-    if (ret == m_map.end())
-        return NULL;
-    return ret->second;
+    return get(name, d_fnv1a(name));
+}
+
+DObject* DObjectStorage::get(const char* name, uint32_t hash)
+{
+    DObject* obj;
+    return Lookup(name, hash, &obj) ? obj : NULL;
 }
 
 void DObjectStorage::remove(const char* name)
 {
-    DObjectMap::iterator ret = m_map.find(name);
-    if (ret == m_map.end())
-        return;
-    m_map.erase(ret);
+    const uint32_t hash = d_fnv1a(name);
+
+    m_mutex.lock();
+
+    size_t hole = Find(name, hash);
+    if (m_entries[hole].name)
+    {
+        BeginWrite();
+
+        /* 後続のエントリを詰めて、探索の連鎖が途切れないようにします */
+        size_t i = hole;
+        for (;;)
+        {
+            i = (i + 1) & D__MASK;
+            const Entry& entry = m_entries[i];
+            if (!entry.name)
+                break;
+
+            const size_t home = entry.hash & D__MASK;
+            if (((i - home) & D__MASK) >= ((i - hole) & D__MASK))
+            {
+                m_entries[hole] = entry;
+                hole = i;
+            }
+        }
+
+        std::memset(&m_entries[hole], 0, sizeof(Entry));
+        m_count--;
+
+        EndWrite();
+    }
+
+    m_mutex.unlock();
 }
 
 void DObjectStorage::walk(DObjectStorageWalkCallback callback)
 {
-    D_FOREACH(DObjectMap::const_iterator, ite, m_map)
-        callback(ite->first.c_str(), ite->second);
+    /* 書き込み側のロックを保持している間、テーブルは変化しません */
+    m_mutex.lock();
+
+    for (size_t i = 0; i < CAPACITY; i++)
+    {
+        const Entry& entry = m_entries[i];
+        if (entry.name)
+            callback(entry.name, entry.obj);
+    }
+
+    m_mutex.unlock();
+}
+
+bool DObjectStorage::Lookup(const char* name, uint32_t hash, DObject** obj) const
+{
+    X_ASSERT(name);
+
+    /* シーケンス番号が偶数で、読み出しの前後で変化していなければ、読み出した
+     * エントリは書き込みの途中のものではありません。
+     * 読み出し中に書き込みが行われた場合は、ロックを取って読み直します。書き込
+     * み中のスレッドより優先度が高いスレッドが読み出しを繰り返して、書き込みが
+     * 終わらなくなるのを防ぐためです。
+     */
+    const uint32_t sequence = m_sequence;
+    D__memoryBarrier();
+
+    if ((sequence & 1) == 0)
+    {
+        const size_t index = Find(name, hash);
+        const bool found = (index < CAPACITY) && m_entries[index].name;
+        DObject* const value = found ? m_entries[index].obj : NULL;
+
+        D__memoryBarrier();
+        if (m_sequence == sequence)
+        {
+            *obj = value;
+            return found;
+        }
+    }
+
+    m_mutex.lock();
+    const size_t index = Find(name, hash);
+    const bool found = m_entries[index].name != NULL;
+    *obj = m_entries[index].obj;
+    m_mutex.unlock();
+
+    return found;
+}
+
+void DObjectStorage::BeginWrite()
+{
+    m_sequence++;
+    D__memoryBarrier();
+}
+
+void DObjectStorage::EndWrite()
+{
+    D__memoryBarrier();
+    m_sequence++;
+}
+
+size_t DObjectStorage::Find(const char* name, uint32_t hash) const
+{
+    /* 書き込みの途中のテーブルを読んだ場合に備えて、探索はCAPACITY回で打ち切
+     * り、見つからなければCAPACITYを返します。
+     * 名前はDStringPoolにinternされていて解放されないので、書き込みの途中で
+     * 読んだポインタでも参照できます。
+     */
+    size_t i = hash & D__MASK;
+    for (size_t n = 0; n < CAPACITY; n++, i = (i + 1) & D__MASK)
+    {
+        const Entry& entry = m_entries[i];
+        const char* const entryName = entry.name;
+        if (!entryName)
+            return i;
+
+        if ((entry.hash == hash) &&
+            ((entryName == name) || (std::strcmp(entryName, name) == 0)))
+            return i;
+    }
+
+    return CAPACITY;
 }
@@ -41,27 +41,92 @@
 
 
 #include <dandy/core/DObject.hpp>
-#include <map>
-#include <string>
+#include <dandy/core/utils/DCoreUtils.hpp>
+#include "platform/PlatformMutex.h"
+
+
+/** @def    D_OBJECT_STORAGE_CAPACITY
+ *  @brief  DObjectStorageのハッシュテーブルのスロット数です
+ *
+ *  2のべき乗でなければなりません。登録できるオブジェクトはこの3/4までです。
+ */
+#ifndef D_OBJECT_STORAGE_CAPACITY
+    #define D_OBJECT_STORAGE_CAPACITY 64
+#endif
+
+
+/** 文字列リテラルを、名前とコンパイル時に計算したハッシュ値の2つの引数に展開し
+ *  ます
+ *
+ *  @code
+ *  DObject* i2c = DObjectStorage::shared()->get(D_OBJECT_KEY("i2c0"));
+ *  @endcode
+ */
+#define D_OBJECT_KEY(name) (name), D_HASH_LITERAL(name)
 
 
 typedef Callback<void(const char*, DObject*)> DObjectStorageWalkCallback;
 
+
+/** 名前でオブジェクトを登録、検索するレジストリです
+ *
+ *  固定長のハッシュテーブル(線形探索のオープンアドレス法)で、エントリごとの動
+ *  的メモリ確保はありません。名前はDStringPool::shared()にinternして保持しま
+ *  す。
+ *
+ *  ハッシュ値を引数に取るオーバーロードに、D_OBJECT_KEY()やD_HASH_LITERAL()で
+ *  計算したハッシュ値を渡すと、検索時に文字列のハッシュ計算を行いません。
+ *
+ *  すべてのメンバ関数はスレッドセーフです。put()とremove()はミューテックスで排
+ *  他しますが、get()とhas()はシーケンスロックで読み出すので、書き込みと重なら
+ *  ない限りロックを取りません。登録はほとんど起動時にしか行わないので、複数のス
+ *  レッドから頻繁に検索してもミューテックスで直列化されません。
+ */
 class DObjectStorage
 {
 public:
+    static const size_t CAPACITY = D_OBJECT_STORAGE_CAPACITY;
+
+    DObjectStorage();
     static DObjectStorage* shared();
-    void put(const char* name, DObject* obj);
+
+    /** nameでobjを登録します
+     *
+     *  同じ名前がすでに登録されているか、テーブルに空きがない場合はfalseを返し
+     *  ます。
+     */
+    bool put(const char* name, DObject* obj);
     bool has(const char* name);
+    bool has(const char* name, uint32_t hash);
     DObject* get(const char* name);
+    DObject* get(const char* name, uint32_t hash);
     void remove(const char* name);
+
+    /** 登録されているすべてのオブジェクトについてcallbackを呼び出します
+     *
+     *  呼び出し中は書き込み側のロックを保持するので、一貫した状態のテーブルを走
+     *  査できます。callbackからput()やremove()を呼び出してはいけません。
+     */
     void walk(DObjectStorageWalkCallback callback);
+    size_t count() const { return m_count; }
 
 private:
-    // TODO uthashに置き換え
-    typedef std::map<std::string, DObject*> DObjectMap;
+    struct Entry
+    {
+        uint32_t hash;
+        const char* name;
+        DObject* obj;
+    };
+
+    bool Lookup(const char* name, uint32_t hash, DObject** obj) const;
+    void BeginWrite();
+    void EndWrite();
+    size_t Find(const char* name, uint32_t hash) const;
 
-    DObjectMap m_map;
+    Entry m_entries[CAPACITY];
+    size_t m_count;
+    volatile uint32_t m_sequence;
+    mutable PlatformMutex m_mutex;
 };
 
 #endif /* end of include guard: dandy_DObjectStorage_hpp_ */
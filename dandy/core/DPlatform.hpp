@@ -43,6 +43,9 @@
     #define D_PLATFORM_MBED 1
     #include <mbed.h>
     #include <BlockDevice.h>
+#elif defined(__linux__) || defined(__APPLE__)
+    #define D_PLATFORM_HOST 1
+    #include <dandy/core/host/DHostPlatform.hpp>
 #else
     #error Unsupported platform
 #endif
@@ -0,0 +1,142 @@
+/**
+ *       @file  DRTTI.cpp
+ *      @brief  dynamic_castなしでrtti機能を提供します。
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2018/08/22
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2014> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/DRTTI.hpp>
+
+
+const DRTTI* DRTTI::s_head;
+volatile bool DRTTI::s_dirty;
+
+
+void DRTTI::Register(DRTTI* rtti)
+{
+    /* s_headは静的な初期化(ゼロ初期化)が行われるので、他の翻訳単位のDRTTIの
+     * 構築順序によらず使用できます */
+    core_util_critical_section_enter();
+    rtti->m_next = s_head;
+    s_head = rtti;
+    s_dirty = true;
+    core_util_critical_section_exit();
+}
+
+
+void DRTTI::Update()
+{
+    core_util_critical_section_enter();
+
+    if (! s_dirty)
+    {
+        core_util_critical_section_exit();
+        return;
+    }
+
+    for (const DRTTI* rtti = s_head; rtti; rtti = rtti->m_next)
+    {
+        rtti->m_child = nullptr;
+        rtti->m_sibling = nullptr;
+    }
+
+    for (const DRTTI* rtti = s_head; rtti; rtti = rtti->m_next)
+    {
+        if (rtti->m_basertti)
+        {
+            rtti->m_sibling = rtti->m_basertti->m_child;
+            rtti->m_basertti->m_child = rtti;
+        }
+    }
+
+    /* ルートごとに、スタックを使わずに子、兄弟、基底クラスのリンクを辿ります */
+    uint32_t order = 0;
+    for (const DRTTI* root = s_head; root; root = root->m_next)
+    {
+        if (root->m_basertti)
+            continue;
+
+        const DRTTI* node = root;
+        for (;;)
+        {
+            node->m_preorder = ++order;
+            if (node->m_child)
+            {
+                node = node->m_child;
+                continue;
+            }
+
+            /* 兄弟が見つかるまで基底クラスへ戻りながら、部分木を閉じます */
+            while ((node != root) && (! node->m_sibling))
+            {
+                node->m_postorder = order;
+                node = node->m_basertti;
+            }
+
+            node->m_postorder = order;
+            if (node == root)
+                break;
+
+            node = node->m_sibling;
+        }
+    }
+
+    s_dirty = false;
+    core_util_critical_section_exit();
+}
+
+
+const DRTTI* DRTTI::find(const char* classname)
+{
+    X_ASSERT(classname);
+
+    for (const DRTTI* rtti = s_head; rtti; rtti = rtti->m_next)
+    {
+        if (::strcmp(rtti->m_classname, classname) == 0)
+            return rtti;
+    }
+
+    return nullptr;
+}
+
+
+size_t DRTTI::count()
+{
+    size_t n = 0;
+    for (const DRTTI* rtti = s_head; rtti; rtti = rtti->m_next)
+        ++n;
+
+    return n;
+}
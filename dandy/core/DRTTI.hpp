@@ -44,19 +44,41 @@
 #include <EASTL/type_traits.h>
 
 
+/** クラスの型情報です
+ *
+ *  すべてのDRTTIは構築時にレジストリへ登録されます。最初の型判定の際に、継承
+ *  ツリーを深さ優先で辿って各型に行きがけ順の番号(preorder)と、その型の部分木
+ *  に含まれる最大の番号(postorder)を割り当てます。型AがBから派生していることは
+ *  Aの番号がBの区間[preorder, postorder]に含まれることと同じなので、
+ *  derives_from()は継承の深さによらず2回の整数比較で判定できます。
+ *
+ *  番号の割り当て後に型が追加された場合は、次の型判定で番号を振りなおします。
+ */
 class DRTTI
 {
   public:
     explicit DRTTI(const char* classname)
         : m_classname(classname)
         , m_basertti(nullptr)
+        , m_next(nullptr)
+        , m_child(nullptr)
+        , m_sibling(nullptr)
+        , m_preorder(0)
+        , m_postorder(0)
     {
+        Register(this);
     }
 
     DRTTI(const char* classname, const DRTTI& basertti)
         : m_classname(classname)
         , m_basertti(&basertti)
+        , m_next(nullptr)
+        , m_child(nullptr)
+        , m_sibling(nullptr)
+        , m_preorder(0)
+        , m_postorder(0)
     {
+        Register(this);
     }
 
 
@@ -66,6 +88,12 @@ class DRTTI
     }
 
 
+    const DRTTI* base() const
+    {
+        return m_basertti;
+    }
+
+
     bool is_exactly(const DRTTI& rtti) const
     {
         return (this == &rtti);
@@ -74,21 +102,65 @@ class DRTTI
 
     bool derives_from (const DRTTI& rtti) const
     {
-        const DRTTI* compare = this;
-        while (compare != nullptr)
-        {
-            if (compare == &rtti)
-                return true;
-            compare = compare->m_basertti;
-        }
-        return false;
+        if (X_UNLIKELY(s_dirty))
+            Update();
+
+        /* 未割り当ての型どうしを派生関係とみなさないようにします */
+        if ((m_preorder == 0) || (rtti.m_preorder == 0))
+            return false;
+
+        return (rtti.m_preorder <= m_preorder) && (m_preorder <= rtti.m_postorder);
+    }
+
+
+    /** 登録されているすべての型を列挙するための先頭の要素を返します
+     *
+     *  @code
+     *  for (const DRTTI* rtti = DRTTI::first(); rtti; rtti = rtti->next())
+     *      printf("%s\n", rtti->classname());
+     *  @endcode
+     */
+    static const DRTTI* first()
+    {
+        return s_head;
     }
 
+
+    const DRTTI* next() const
+    {
+        return m_next;
+    }
+
+
+    /** classnameの型を返します。見つからない場合はnullptrを返します
+     */
+    static const DRTTI* find(const char* classname);
+
+
+    /** 登録されている型の数を返します
+     */
+    static size_t count();
+
 private:
     EA_NON_COPYABLE(DRTTI);
 
+    static void Register(DRTTI* rtti);
+    static void Update();
+
     const char* const  m_classname;
     const DRTTI* const m_basertti;
+    const DRTTI* m_next;
+
+    /* 番号の割り当て時にのみ使用する子と兄弟へのリンク */
+    mutable const DRTTI* m_child;
+    mutable const DRTTI* m_sibling;
+
+    /* 0は未割り当て。割り当て済みの型の区間には含まれません */
+    mutable uint32_t m_preorder;
+    mutable uint32_t m_postorder;
+
+    static const DRTTI* s_head;
+    static volatile bool s_dirty;
 };
 
 
@@ -38,6 +38,7 @@
 
 
 #include <dandy/core/DRef.hpp>
+#include <dandy/core/DStringPool.hpp>
 
 
 D_IMPL_RTTI_ROOT(DRef);
@@ -54,20 +55,28 @@ DRef::DRef()
 DRef::~DRef()
 {
     X_ASSERT(this->m_use_count == 0);
-    D_SAFE_DELETE_ARRAY(m_name);
 }
 
 
 void DRef::retain()
 {
+#if D_REF_ATOMIC_COUNT
+    core_util_atomic_incr_u32(&m_use_count, 1);
+#else
     ++m_use_count;
+#endif
 }
 
 
 void DRef::release()
 {
-    --m_use_count;
-    if (m_use_count == 0)
+#if D_REF_ATOMIC_COUNT
+    const bool last = (core_util_atomic_decr_u32(&m_use_count, 1) == 0);
+#else
+    const bool last = (--m_use_count == 0);
+#endif
+
+    if (last)
         D_DELETE(this);
 }
 
@@ -77,21 +86,5 @@ void DRef::set_name(const char* name)
     if (m_name == name)
         return;
 
-    if ((m_name != nullptr) && (name != nullptr) &&
-            (std::strcmp(m_name, name) == 0))
-        return;
-
-    if (m_name)
-        D_SAFE_DELETE_ARRAY(m_name);
-
-    if (! name)
-    {
-        m_name = nullptr;
-    }
-    else
-    {
-        m_name = D_NEW(char[std::strlen(name) + 1]);
-        X_ASSERT(m_name);
-        std::strcpy(m_name, name);
-    }
+    m_name = DStringPool::shared()->intern(name);
 }
@@ -47,6 +47,19 @@
 #include <dandy/core/DRTTI.hpp>
 
 
+/** @def    D_REF_ATOMIC_COUNT
+ *  @brief  DRefの参照カウントの増減をアトミック操作で行うかどうかです
+ *
+ *  1を定義すると、retain()とrelease()がcore_util_atomic_incr_u32()と
+ *  core_util_atomic_decr_u32()で参照カウントを更新するようになり、外部のミュー
+ *  テックスなしで複数のスレッドや割り込みハンドラからretain/releaseできます。
+ *  Cortex-MではLDREX/STREXのループになるので、既定では無効です。
+ */
+#ifndef D_REF_ATOMIC_COUNT
+    #define D_REF_ATOMIC_COUNT 0
+#endif
+
+
 
 /** nullチェック付きのretainです。
  */
@@ -81,6 +94,8 @@ public:
 
 
     /** 参照カウントを1つ減算します。
+     *
+     *  参照カウントが0になるとオブジェクトをD_DELETE()します。
      */
     void release();
 
@@ -91,6 +106,9 @@ public:
 
 
     /** オブジェクトの名前を設定します。
+     *
+     *  名前はDStringPool::shared()にinternして保持するので、同じ名前のオブジェ
+     *  クトは同じポインタを共有します。name()同士はポインタで比較できます。
      */
     void set_name(const char* name);
 
@@ -107,12 +125,18 @@ public:
 
     /** 現在の参照カウント値を返します。
      */
-    int use_count() const { return m_use_count; }
+    int use_count() const { return static_cast<int>(m_use_count); }
 
 private:
-    int     m_tag;
-    int     m_use_count;
-    char*   m_name;
+#if D_REF_ATOMIC_COUNT
+    typedef volatile uint32_t UseCount;
+#else
+    typedef int UseCount;
+#endif
+
+    int         m_tag;
+    UseCount    m_use_count;
+    const char* m_name;
 };
 
 
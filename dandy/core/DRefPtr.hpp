@@ -0,0 +1,232 @@
+/**
+ *       @file  DRefPtr.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DRefPtr_hpp_
+#define dandy_DRefPtr_hpp_
+
+
+#include <dandy/core/DRef.hpp>
+
+
+/** DRefの派生クラスを指す侵入型のスマートポインタです
+ *
+ *  参照カウントはオブジェクト自身が持っているので、DRefPtrはポインタ1つ分の
+ *  大きさしかありません。コピーするとretain()、破棄するとrelease()を呼び出すの
+ *  で、D_SAFE_RETAIN()とD_SAFE_RELEASE()の対応を手で管理する必要がなくなりま
+ *  す。
+ *
+ *  C++11以降ではムーブに対応しており、所有権の受け渡しでは参照カウントを更新し
+ *  ません。参照カウントをアトミックに更新する必要がある場合は
+ *  D_REF_ATOMIC_COUNTを参照してください。
+ *
+ *  @code
+ *  DRefPtr<DBuffer> buf(D_NEW(DBuffer(256)));  // use_count() == 1
+ *  DRefPtr<DBuffer> other = buf;               // use_count() == 2
+ *  queue.put(other.detach());                  // 別スレッドに参照を渡す
+ *  ...
+ *  DRefPtr<DBuffer> received = DRefPtr<DBuffer>::adopt(queue.get());
+ *  @endcode
+ */
+template <typename T>
+class DRefPtr
+{
+    typedef T* DRefPtr::*UnspecifiedBoolType;
+
+public:
+    typedef T element_type;
+
+
+    /** nullを指すポインタを構築します
+     */
+    DRefPtr()
+        : m_ptr(0)
+    {
+    }
+
+
+    /** pを指し、参照カウントを1つ加算します
+     */
+    DRefPtr(T* p)
+        : m_ptr(p)
+    {
+        D_SAFE_RETAIN(m_ptr);
+    }
+
+
+    DRefPtr(const DRefPtr& other)
+        : m_ptr(other.m_ptr)
+    {
+        D_SAFE_RETAIN(m_ptr);
+    }
+
+
+    template <typename U>
+    DRefPtr(const DRefPtr<U>& other)
+        : m_ptr(other.get())
+    {
+        D_SAFE_RETAIN(m_ptr);
+    }
+
+
+#if !defined(EA_COMPILER_NO_RVALUE_REFERENCES)
+    DRefPtr(DRefPtr&& other)
+        : m_ptr(other.m_ptr)
+    {
+        other.m_ptr = 0;
+    }
+
+
+    DRefPtr& operator=(DRefPtr&& other)
+    {
+        if (this != &other)
+        {
+            T* old = m_ptr;
+            m_ptr = other.m_ptr;
+            other.m_ptr = 0;
+            D_SAFE_RELEASE(old);
+        }
+        return *this;
+    }
+#endif
+
+
+    ~DRefPtr()
+    {
+        D_SAFE_RELEASE(m_ptr);
+    }
+
+
+    DRefPtr& operator=(const DRefPtr& other)
+    {
+        reset(other.m_ptr);
+        return *this;
+    }
+
+
+    DRefPtr& operator=(T* p)
+    {
+        reset(p);
+        return *this;
+    }
+
+
+    /** 参照カウントを加算済みのpを、加算せずに引き取ります
+     *
+     *  detach()で取り出したポインタや、呼び出し側がreleaseする約束で返された
+     *  ポインタを受け取るときに使用します。
+     */
+    static DRefPtr adopt(T* p)
+    {
+        DRefPtr ret;
+        ret.m_ptr = p;
+        return ret;
+    }
+
+
+    /** 参照カウントを減算せずにポインタを手放します
+     *
+     *  戻り値の参照は呼び出し側が所有するので、いずれrelease()するかadopt()に
+     *  渡さなければなりません。
+     */
+    T* detach()
+    {
+        T* const ret = m_ptr;
+        m_ptr = 0;
+        return ret;
+    }
+
+
+    /** pを指すように変更します
+     *
+     *  pを先にretain()するので、自分自身と同じオブジェクトを渡しても安全です。
+     */
+    void reset(T* p = 0)
+    {
+        D_SAFE_RETAIN(p);
+        T* old = m_ptr;
+        m_ptr = p;
+        D_SAFE_RELEASE(old);
+    }
+
+
+    void swap(DRefPtr& other)
+    {
+        T* const tmp = m_ptr;
+        m_ptr = other.m_ptr;
+        other.m_ptr = tmp;
+    }
+
+
+    T* get() const { return m_ptr; }
+    T& operator*() const { X_ASSERT(m_ptr); return *m_ptr; }
+    T* operator->() const { X_ASSERT(m_ptr); return m_ptr; }
+    operator UnspecifiedBoolType() const { return m_ptr ? &DRefPtr::m_ptr : 0; }
+    bool operator!() const { return m_ptr == 0; }
+
+private:
+    T* m_ptr;
+};
+
+
+template <typename T, typename U>
+inline bool operator==(const DRefPtr<T>& a, const DRefPtr<U>& b) { return a.get() == b.get(); }
+
+template <typename T, typename U>
+inline bool operator!=(const DRefPtr<T>& a, const DRefPtr<U>& b) { return a.get() != b.get(); }
+
+template <typename T, typename U>
+inline bool operator==(const DRefPtr<T>& a, U* b) { return a.get() == b; }
+
+template <typename T, typename U>
+inline bool operator!=(const DRefPtr<T>& a, U* b) { return a.get() != b; }
+
+template <typename T, typename U>
+inline bool operator==(T* a, const DRefPtr<U>& b) { return a == b.get(); }
+
+template <typename T, typename U>
+inline bool operator!=(T* a, const DRefPtr<U>& b) { return a != b.get(); }
+
+template <typename T>
+inline bool operator<(const DRefPtr<T>& a, const DRefPtr<T>& b) { return a.get() < b.get(); }
+
+template <typename T>
+inline void swap(DRefPtr<T>& a, DRefPtr<T>& b) { a.swap(b); }
+
+
+#endif /* end of include guard: dandy_DRefPtr_hpp_ */
@@ -0,0 +1,232 @@
+/**
+ *       @file  DStringPool.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/DStringPool.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+
+
+static const size_t D__INITIAL_CAPACITY = 16;
+static SingletonPtr<DStringPool> _shared_instance;
+
+
+DStringPool* DStringPool::shared()
+{
+    return _shared_instance.get();
+}
+
+
+DStringPool::DStringPool(size_t chunkSize)
+    : m_chunk(NULL)
+    , m_slots(NULL)
+    , m_capacity(0)
+    , m_count(0)
+    , m_chunkSize(chunkSize)
+    , m_usedBytes(0)
+{
+    X_ASSERT(m_chunkSize > 0);
+}
+
+
+DStringPool::~DStringPool()
+{
+    while (m_chunk)
+    {
+        Chunk* const next = m_chunk->next;
+        char* mem = reinterpret_cast<char*>(m_chunk);
+        D_SAFE_DELETE_ARRAY(mem);
+        m_chunk = next;
+    }
+
+    D_SAFE_DELETE_ARRAY(m_slots);
+}
+
+
+const char* DStringPool::intern(const char* str)
+{
+    if (!str)
+        return NULL;
+
+    return intern(str, std::strlen(str));
+}
+
+
+const char* DStringPool::intern(const char* str, size_t len)
+{
+    X_ASSERT(str);
+
+    const uint32_t hash = d_fnv1a(str, len);
+
+    m_mutex.lock();
+
+    if (!m_slots)
+        Grow();
+
+    const Slot* slot = Find(str, len, hash);
+    const char* ret;
+    if (slot->str)
+    {
+        ret = slot->str;
+    }
+    else
+    {
+        if ((m_count + 1) * 4 > m_capacity * 3)
+        {
+            Grow();
+            slot = Find(str, len, hash);
+        }
+
+        ret = Store(str, len);
+        Slot* const dst = const_cast<Slot*>(slot);
+        dst->hash = hash;
+        dst->str = ret;
+        m_count++;
+    }
+
+    m_mutex.unlock();
+
+    return ret;
+}
+
+
+const char* DStringPool::find(const char* str) const
+{
+    if (!str)
+        return NULL;
+
+    const size_t len = std::strlen(str);
+    const uint32_t hash = d_fnv1a(str, len);
+
+    m_mutex.lock();
+    const char* const ret = m_capacity ? Find(str, len, hash)->str : NULL;
+    m_mutex.unlock();
+
+    return ret;
+}
+
+
+size_t DStringPool::count() const
+{
+    return m_count;
+}
+
+
+size_t DStringPool::usedBytes() const
+{
+    return m_usedBytes;
+}
+
+
+const DStringPool::Slot* DStringPool::Find(const char* str, size_t len, uint32_t hash) const
+{
+    /* 線形探索です。m_capacityは2のべき乗で、空きスロットが必ず残っています */
+    const size_t mask = m_capacity - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        const Slot* const slot = &m_slots[i];
+        if (!slot->str)
+            return slot;
+
+        if ((slot->hash == hash) &&
+            (std::strncmp(slot->str, str, len) == 0) &&
+            (slot->str[len] == '\0'))
+            return slot;
+    }
+}
+
+
+const char* DStringPool::Store(const char* str, size_t len)
+{
+    const size_t need = len + 1;
+    Chunk* chunk = m_chunk;
+
+    if (!chunk || (chunk->size - chunk->used < need))
+    {
+        const size_t size = d_max<size_t>(m_chunkSize, need);
+        chunk = reinterpret_cast<Chunk*>(D_NEW(char[sizeof(Chunk) + size]));
+        X_ASSERT(chunk);
+        chunk->size = size;
+        chunk->used = 0;
+
+        if (m_chunk && (need > m_chunkSize))
+        {
+            /* 大きな文字列専用のチャンクは、使用中のチャンクの後ろにつなぎます */
+            chunk->next = m_chunk->next;
+            m_chunk->next = chunk;
+        }
+        else
+        {
+            chunk->next = m_chunk;
+            m_chunk = chunk;
+        }
+    }
+
+    char* const dst = reinterpret_cast<char*>(chunk + 1) + chunk->used;
+    std::memcpy(dst, str, len);
+    dst[len] = '\0';
+    chunk->used += need;
+    m_usedBytes += need;
+
+    return dst;
+}
+
+
+void DStringPool::Grow()
+{
+    const size_t capacity = m_capacity ? m_capacity * 2 : D__INITIAL_CAPACITY;
+    Slot* const slots = D_NEW(Slot[capacity]);
+    X_ASSERT(slots);
+    std::memset(slots, 0, sizeof(Slot) * capacity);
+
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < m_capacity; i++)
+    {
+        const Slot& src = m_slots[i];
+        if (!src.str)
+            continue;
+
+        size_t j = src.hash & mask;
+        while (slots[j].str)
+            j = (j + 1) & mask;
+        slots[j] = src;
+    }
+
+    D_SAFE_DELETE_ARRAY(m_slots);
+    m_slots = slots;
+    m_capacity = capacity;
+}
@@ -0,0 +1,146 @@
+/**
+ *       @file  DStringPool.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DStringPool_hpp_
+#define dandy_DStringPool_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include "platform/PlatformMutex.h"
+
+
+/** 文字列を一度だけ保存して、同じ内容には同じポインタを返す文字列プールです
+ *
+ *  intern()が返すポインタはプールが破棄されるまで有効で、内容が等しい文字列に
+ *  は必ず同じポインタが返るので、intern()済みの文字列同士はstrcmp()ではなく
+ *  ポインタの比較で等しいかを判定できます。
+ *
+ *  文字列は数百バイトのチャンクに詰めて保存するので、名前ごとに小さな動的メモ
+ *  リ確保を行うよりも断片化が起きにくくなります。その代わり、一度intern()した
+ *  文字列は個別に解放できません。オブジェクトの名前やレジストリのキーのように、
+ *  種類が限られていて、長く使われる文字列に使用してください。
+ *
+ *  すべてのメンバ関数はスレッドセーフです。
+ *
+ *  @code
+ *  const char* a = DStringPool::shared()->intern("i2c0");
+ *  const char* b = DStringPool::shared()->intern(buf);   // buf = "i2c0"
+ *  X_ASSERT(a == b);
+ *  @endcode
+ */
+class DStringPool
+{
+public:
+
+    /** 既定のチャンクのバイト数です
+     */
+    static const size_t DEFAULT_CHUNK_SIZE = 256;
+
+
+    /** DRefの名前やDObjectStorageのキーに使用する共有のプールを返します
+     */
+    static DStringPool* shared();
+
+
+    explicit DStringPool(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    ~DStringPool();
+
+
+    /** strと等しい文字列をプールから探し、なければ追加して返します
+     *
+     *  strがnullの場合はnullを返します。
+     */
+    const char* intern(const char* str);
+
+
+    /** str[0, len)と等しい文字列をプールから探し、なければ追加して返します
+     *
+     *  strはヌル終端されていなくても構いません。
+     */
+    const char* intern(const char* str, size_t len);
+
+
+    /** strと等しい文字列がプールにあればそれを返し、なければnullを返します
+     *
+     *  プールに追加しないので、キーの検索などに使用します。
+     */
+    const char* find(const char* str) const;
+
+
+    /** プールにある文字列の数を返します
+     */
+    size_t count() const;
+
+
+    /** 文字列の保存に使用しているバイト数を返します
+     */
+    size_t usedBytes() const;
+
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DStringPool);
+
+    struct Chunk
+    {
+        Chunk* next;
+        size_t size;
+        size_t used;
+    };
+
+    struct Slot
+    {
+        uint32_t hash;
+        const char* str;
+    };
+
+    const Slot* Find(const char* str, size_t len, uint32_t hash) const;
+    const char* Store(const char* str, size_t len);
+    void Grow();
+
+    Chunk* m_chunk;
+    Slot* m_slots;
+    size_t m_capacity;
+    size_t m_count;
+    size_t m_chunkSize;
+    size_t m_usedBytes;
+    mutable PlatformMutex m_mutex;
+};
+
+
+#endif /* end of include guard: dandy_DStringPool_hpp_ */
@@ -0,0 +1,482 @@
+/**
+ *       @file  DBlockDeviceScheduler.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/block_device/DBlockDeviceScheduler.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+
+
+/* 順序を比較する時にシーケンス番号の一巡を考慮する */
+#define D__SEQUENCE_BEFORE(a, b)  (static_cast<int32_t>((a) - (b)) < 0)
+
+
+/* 同期版のread()などで完了を待つためのコンテキスト */
+struct D__SyncContext
+{
+    volatile bool done;
+    int result;
+#ifdef MBED_CONF_RTOS_PRESENT
+    rtos::Semaphore semaphore;
+
+    D__SyncContext() : done(false), result(0), semaphore(0) {}
+#else
+    D__SyncContext() : done(false), result(0) {}
+#endif
+
+    void onComplete(DBlockDeviceRequest*, int r)
+    {
+        result = r;
+        done = true;
+#ifdef MBED_CONF_RTOS_PRESENT
+        semaphore.release();
+#endif
+    }
+};
+
+
+static bool D__overlapped(const DBlockDeviceRequest* a, const DBlockDeviceRequest* b)
+{
+    return (a->address < b->address + b->size) && (b->address < a->address + a->size);
+}
+
+
+DBlockDeviceScheduler::DBlockDeviceScheduler(BlockDevice* blockDevice, void* mergeBuffer, size_t mergeBufferSize)
+    : m_blockDevice(blockDevice)
+    , m_mergeBuffer(static_cast<uint8_t*>(mergeBuffer))
+    , m_mergeBufferSize(mergeBuffer ? mergeBufferSize : 0)
+    , m_programSliceSize(DEFAULT_PROGRAM_SLICE_SIZE)
+    , m_eraseSliceSize(DEFAULT_ERASE_SLICE_SIZE)
+    , m_active(nullptr)
+    , m_position(0)
+    , m_sequence(0)
+    , m_pendingCount(0)
+#ifdef MBED_CONF_RTOS_PRESENT
+    , m_event(0)
+#endif
+{
+    X_ASSERT(m_blockDevice);
+    for (int i = 0; i < D_BD_PRIORITY_COUNT; i++)
+        m_queues[i] = nullptr;
+}
+
+
+DBlockDeviceScheduler::~DBlockDeviceScheduler()
+{
+    X_ASSERT(m_pendingCount == 0);
+}
+
+
+int DBlockDeviceScheduler::submit(DBlockDeviceRequest* request)
+{
+    X_ASSERT(request);
+    X_ASSERT(request->priority < D_BD_PRIORITY_COUNT);
+
+    switch (request->type)
+    {
+    case D_BD_REQUEST_READ:
+        if (!m_blockDevice->is_valid_read(request->address, request->size) || !request->buffer)
+            return BD_ERROR_DEVICE_ERROR;
+        break;
+    case D_BD_REQUEST_PROGRAM:
+        if (!m_blockDevice->is_valid_program(request->address, request->size) || !request->buffer)
+            return BD_ERROR_DEVICE_ERROR;
+        break;
+    case D_BD_REQUEST_ERASE:
+        if (!m_blockDevice->is_valid_erase(request->address, request->size))
+            return BD_ERROR_DEVICE_ERROR;
+        break;
+    default:
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    m_mutex.lock();
+    request->sequence = m_sequence++;
+    request->done = 0;
+
+    /* 同じ優先度のキューはアドレスの昇順に並べておく */
+    DBlockDeviceRequest** link = &m_queues[request->priority];
+    while (*link && ((*link)->address <= request->address))
+        link = &(*link)->next;
+    request->next = *link;
+    *link = request;
+    m_pendingCount++;
+    m_mutex.unlock();
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    m_event.release();
+#endif
+
+    return BD_ERROR_OK;
+}
+
+
+bool DBlockDeviceScheduler::process()
+{
+    m_mutex.lock();
+    DBlockDeviceRequest* request = this->SelectRequest();
+    if (!request)
+    {
+        m_mutex.unlock();
+        return false;
+    }
+
+    this->Unlink(request);
+    m_active = request;
+
+    if (request->type == D_BD_REQUEST_READ)
+    {
+        DBlockDeviceRequest* completed;
+        const int result = this->ProcessRead(request, &completed);
+
+        /* コールバックの中で再び要求を投入できるように、ロックを解放してから呼
+         * び出す。
+         */
+        m_mutex.unlock();
+        while (completed)
+        {
+            DBlockDeviceRequest* next = completed->next;
+            completed->callback(completed, result);
+            completed = next;
+        }
+        return true;
+    }
+
+    /* 書き込みと消去は一区切りだけ処理して、次の要求を選び直す */
+    const bd_addr_t address = request->address + request->done;
+    const bd_size_t sliceSize = this->GetSliceSize(request, address);
+    m_mutex.unlock();
+
+    int result;
+    if (request->type == D_BD_REQUEST_PROGRAM)
+    {
+        result = m_blockDevice->program(static_cast<const uint8_t*>(request->buffer) + request->done,
+                                        address, sliceSize);
+    }
+    else
+    {
+        result = m_blockDevice->erase(address, sliceSize);
+    }
+
+    m_mutex.lock();
+    m_active = nullptr;
+    m_position = address + sliceSize;
+    request->done += sliceSize;
+    if ((result == BD_ERROR_OK) && (request->done < request->size))
+    {
+        /* シーケンス番号はそのままなので、後から来た重なる要求を追い越される
+         * ことはない。
+         */
+        DBlockDeviceRequest** link = &m_queues[request->priority];
+        while (*link && ((*link)->address <= request->address))
+            link = &(*link)->next;
+        request->next = *link;
+        *link = request;
+        m_mutex.unlock();
+        return true;
+    }
+
+    m_pendingCount--;
+    m_mutex.unlock();
+    request->callback(request, result);
+
+    return true;
+}
+
+
+#ifdef MBED_CONF_RTOS_PRESENT
+void DBlockDeviceScheduler::run()
+{
+    for (;;)
+    {
+        if (!this->process())
+            m_event.wait();
+    }
+}
+#endif
+
+
+int DBlockDeviceScheduler::read(void* dst, bd_addr_t address, bd_size_t size, DBlockDeviceRequestPriority priority)
+{
+    DBlockDeviceRequest request;
+    request.type = D_BD_REQUEST_READ;
+    request.priority = priority;
+    request.address = address;
+    request.size = size;
+    request.buffer = dst;
+    return this->SubmitAndWait(&request);
+}
+
+
+int DBlockDeviceScheduler::program(const void* src, bd_addr_t address, bd_size_t size, DBlockDeviceRequestPriority priority)
+{
+    DBlockDeviceRequest request;
+    request.type = D_BD_REQUEST_PROGRAM;
+    request.priority = priority;
+    request.address = address;
+    request.size = size;
+    request.buffer = const_cast<void*>(src);
+    return this->SubmitAndWait(&request);
+}
+
+
+int DBlockDeviceScheduler::erase(bd_addr_t address, bd_size_t size, DBlockDeviceRequestPriority priority)
+{
+    DBlockDeviceRequest request;
+    request.type = D_BD_REQUEST_ERASE;
+    request.priority = priority;
+    request.address = address;
+    request.size = size;
+    request.buffer = NULL;
+    return this->SubmitAndWait(&request);
+}
+
+
+void DBlockDeviceScheduler::setProgramSliceSize(bd_size_t size)
+{
+    m_mutex.lock();
+    m_programSliceSize = size;
+    m_mutex.unlock();
+}
+
+
+void DBlockDeviceScheduler::setEraseSliceSize(bd_size_t size)
+{
+    m_mutex.lock();
+    m_eraseSliceSize = size;
+    m_mutex.unlock();
+}
+
+
+size_t DBlockDeviceScheduler::pendingCount() const
+{
+    m_mutex.lock();
+    const size_t count = m_pendingCount;
+    m_mutex.unlock();
+
+    return count;
+}
+
+
+bd_size_t DBlockDeviceScheduler::GetSliceSize(const DBlockDeviceRequest* request, bd_addr_t address) const
+{
+    const bd_size_t remaining = request->size - request->done;
+
+    /* 区切りのサイズはデバイスの書き込み単位に切り捨てる。init()前は単位が分か
+     * らないデバイスもあるので、設定時ではなくここで丸める。
+     */
+    if (request->type == D_BD_REQUEST_PROGRAM)
+    {
+        const bd_size_t programSize = m_blockDevice->get_program_size();
+        const bd_size_t sliceSize = d_max<bd_size_t>(m_programSliceSize - m_programSliceSize % programSize,
+                                                     programSize);
+        return d_min<bd_size_t>(remaining, sliceSize);
+    }
+
+    /* 消去は、アドレスが揃っていて範囲に収まる最大の単位(消去単位の2のべき乗
+     * 倍)で区切る。SPIフラッシュなどは大きな単位のブロック消去が使えるので、
+     * 消去単位ごとに区切るより全体の消去時間が短くなる。
+     */
+    bd_size_t sliceSize = m_blockDevice->get_erase_size();
+    while ((sliceSize * 2 <= m_eraseSliceSize) &&
+           (sliceSize * 2 <= remaining) &&
+           ((address % (sliceSize * 2)) == 0))
+    {
+        sliceSize *= 2;
+    }
+
+    return d_min<bd_size_t>(remaining, sliceSize);
+}
+
+
+DBlockDeviceRequest* DBlockDeviceScheduler::SelectRequest()
+{
+    DBlockDeviceRequest* candidate = nullptr;
+    for (int i = 0; (i < D_BD_PRIORITY_COUNT) && !candidate; i++)
+    {
+        /* 前回処理したアドレス以降で最初の要求。なければ先頭に戻る */
+        DBlockDeviceRequest* request = m_queues[i];
+        candidate = request;
+        while (request && (request->address < m_position))
+            request = request->next;
+        if (request)
+            candidate = request;
+    }
+
+    if (!candidate)
+        return nullptr;
+
+    /* 先に投入された重なる要求があれば、そちらを先に処理する */
+    DBlockDeviceRequest* conflict;
+    while ((conflict = this->FindConflict(candidate)) != nullptr)
+        candidate = conflict;
+
+    /* 処理中の要求と重なる場合は、それが終わるまで待つ */
+    if (m_active && D__overlapped(candidate, m_active) &&
+        ((candidate->type != D_BD_REQUEST_READ) || (m_active->type != D_BD_REQUEST_READ)))
+        return nullptr;
+
+    return candidate;
+}
+
+
+DBlockDeviceRequest* DBlockDeviceScheduler::FindConflict(const DBlockDeviceRequest* request) const
+{
+    DBlockDeviceRequest* oldest = nullptr;
+    for (int i = 0; i < D_BD_PRIORITY_COUNT; i++)
+    {
+        for (DBlockDeviceRequest* p = m_queues[i]; p; p = p->next)
+        {
+            if (!D__SEQUENCE_BEFORE(p->sequence, request->sequence))
+                continue;
+            if ((p->type == D_BD_REQUEST_READ) && (request->type == D_BD_REQUEST_READ))
+                continue;
+            if (!D__overlapped(p, request))
+                continue;
+            if (!oldest || D__SEQUENCE_BEFORE(p->sequence, oldest->sequence))
+                oldest = p;
+        }
+    }
+
+    return oldest;
+}
+
+
+bool DBlockDeviceScheduler::Unlink(DBlockDeviceRequest* request)
+{
+    DBlockDeviceRequest** link = &m_queues[request->priority];
+    while (*link)
+    {
+        if (*link == request)
+        {
+            *link = request->next;
+            request->next = nullptr;
+            return true;
+        }
+        link = &(*link)->next;
+    }
+
+    return false;
+}
+
+
+int DBlockDeviceScheduler::ProcessRead(DBlockDeviceRequest* head, DBlockDeviceRequest** completed)
+{
+    /* 同じ優先度のキューはアドレス順に並んでいるので、headの次から連続するアド
+     * レスの読み出しを集める。読み出し先のバッファがメモリ上でも連続していれば
+     * そのまま、そうでなければ作業領域に収まる範囲でまとめる。
+     */
+    DBlockDeviceRequest* tail = head;
+    bd_size_t total = head->size;
+    bool contiguous = true;
+
+    DBlockDeviceRequest** link = &m_queues[head->priority];
+    while (*link && ((*link)->address < head->address + head->size))
+        link = &(*link)->next;
+
+    while (*link)
+    {
+        DBlockDeviceRequest* request = *link;
+        if ((request->type != D_BD_REQUEST_READ) ||
+            (request->address != tail->address + tail->size))
+            break;
+        if (this->FindConflict(request))
+            break;
+
+        const bool stillContiguous = contiguous &&
+            (static_cast<uint8_t*>(request->buffer) == static_cast<uint8_t*>(tail->buffer) + tail->size);
+        if (!stillContiguous && (total + request->size > m_mergeBufferSize))
+            break;
+
+        *link = request->next;
+        tail->next = request;
+        request->next = nullptr;
+        tail = request;
+        total += request->size;
+        contiguous = stillContiguous;
+    }
+
+    const bd_addr_t address = head->address;
+    m_pendingCount -= 1;
+    for (DBlockDeviceRequest* p = head->next; p; p = p->next)
+        m_pendingCount--;
+
+    /* デバイスへのアクセス中は、他のスレッドが要求を投入できるようにする */
+    m_mutex.unlock();
+    int result;
+    if (contiguous)
+    {
+        result = m_blockDevice->read(head->buffer, address, total);
+    }
+    else
+    {
+        result = m_blockDevice->read(m_mergeBuffer, address, total);
+        if (result == BD_ERROR_OK)
+        {
+            for (DBlockDeviceRequest* p = head; p; p = p->next)
+                memcpy(p->buffer, m_mergeBuffer + (p->address - address), p->size);
+        }
+    }
+    m_mutex.lock();
+
+    m_active = nullptr;
+    m_position = address + total;
+    *completed = head;
+
+    return result;
+}
+
+
+int DBlockDeviceScheduler::SubmitAndWait(DBlockDeviceRequest* request)
+{
+    D__SyncContext context;
+
+    request->callback = callback(&context, &D__SyncContext::onComplete);
+    const int ret = this->submit(request);
+    if (ret)
+        return ret;
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    while (!context.done)
+        context.semaphore.wait();
+#else
+    while (!context.done)
+        this->process();
+#endif
+
+    return context.result;
+}
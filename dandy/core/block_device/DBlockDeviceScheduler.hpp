@@ -0,0 +1,231 @@
+/**
+ *       @file  DBlockDeviceScheduler.hpp
+ *      @brief  消去を先行して行うBlockDeviceラッパーです
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DBlockDeviceScheduler_hpp_
+#define dandy_DBlockDeviceScheduler_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include "platform/PlatformMutex.h"
+#ifdef MBED_CONF_RTOS_PRESENT
+#include "rtos/Semaphore.h"
+#endif
+
+
+/** I/O要求の種類です
+ */
+typedef enum DBlockDeviceRequestType
+{
+    D_BD_REQUEST_READ,
+    D_BD_REQUEST_PROGRAM,
+    D_BD_REQUEST_ERASE,
+} DBlockDeviceRequestType;
+
+
+/** I/O要求の優先度です
+ *
+ *  値が小さいほど優先度が高くなります。
+ */
+typedef enum DBlockDeviceRequestPriority
+{
+    D_BD_PRIORITY_HIGH,         /* UIなど応答時間が重要な読み出し */
+    D_BD_PRIORITY_NORMAL,
+    D_BD_PRIORITY_BACKGROUND,   /* ログの書き込みや先行消去など */
+    D_BD_PRIORITY_COUNT,
+} DBlockDeviceRequestPriority;
+
+
+struct DBlockDeviceRequest;
+typedef Callback<void(DBlockDeviceRequest*, int)> DBlockDeviceRequestCallback;
+
+
+/** DBlockDeviceSchedulerに渡すI/O要求です
+ *
+ *  要求のメモリは呼び出し元が用意し、完了のコールバックが呼ばれるまで解放しては
+ *  いけません。コールバックの第2引数は結果のエラーコードです。
+ */
+struct DBlockDeviceRequest
+{
+    DBlockDeviceRequestType type;
+    DBlockDeviceRequestPriority priority;
+    bd_addr_t address;
+    bd_size_t size;
+    void* buffer;       /* 読み出し先、または書き込むデータ。消去ではNULL */
+    DBlockDeviceRequestCallback callback;
+
+    /* 以下はDBlockDeviceSchedulerが使用します */
+    DBlockDeviceRequest* next;
+    uint32_t sequence;
+    bd_size_t done;
+};
+
+
+/** 複数のスレッドからのBlockDeviceへのI/O要求を調停します
+ *
+ *  SPIフラッシュのように1つのバスを共有するデバイスでは、先に呼び出した方がバス
+ *  を占有するので、応答時間が重要な読み出しが大量の書き込みや消去の後ろで待たさ
+ *  れてしまいます。このクラスは要求をキューに入れ、次の規則で1つずつデバイスに
+ *  発行します。
+ *
+ *  + 優先度の高い要求から処理する
+ *  + 同じ優先度の中では、前回のアドレスから昇順に処理する(一巡したら先頭に戻る)
+ *  + 連続するアドレスの読み出しは1回の読み出しにまとめる
+ *  + 書き込みと消去は一定のサイズごとに区切り、その間に優先度の高い要求を割り込
+ *    ませる
+ *
+ *  並び替えによって結果が変わらないように、範囲が重なっていて一方が書き込みか消
+ *  去である要求同士は、投入した順に処理します。
+ *
+ *  デバイスへのアクセスはprocess()を呼び出したスレッドで行います。RTOSがある場合
+ *  はrun()を専用のスレッドで実行してください。優先度の高い要求が途切れない場合、
+ *  優先度の低い要求は処理されないことに注意してください。
+ *
+ *  @code
+ *  DBlockDeviceScheduler scheduler(&flash, mergeBuffer, sizeof(mergeBuffer));
+ *  Thread thread(osPriorityBelowNormal);
+ *  thread.start(callback(&scheduler, &DBlockDeviceScheduler::run));
+ *
+ *  // UIスレッド
+ *  scheduler.read(bitmap, address, size, D_BD_PRIORITY_HIGH);
+ *  @endcode
+ */
+class DBlockDeviceScheduler
+{
+public:
+
+    /** 書き込みを区切るサイズのデフォルト値です
+     */
+    static const bd_size_t DEFAULT_PROGRAM_SLICE_SIZE = 1024;
+
+
+    /** 消去を区切るサイズの上限のデフォルト値です
+     */
+    static const bd_size_t DEFAULT_ERASE_SLICE_SIZE = 64 * 1024;
+
+
+    /** コンストラクタ
+     *
+     *  mergeBufferは連続する読み出しをまとめるための作業領域です。NULLの場合、
+     *  読み出し先のバッファがメモリ上でも連続している要求だけをまとめます。
+     */
+    DBlockDeviceScheduler(BlockDevice* blockDevice, void* mergeBuffer = NULL, size_t mergeBufferSize = 0);
+    ~DBlockDeviceScheduler();
+
+
+    /** 要求をキューに追加します
+     *
+     *  要求は非同期に処理され、完了するとrequest->callbackが呼び出されます。
+     *  コールバックはprocess()を呼び出したスレッドで実行されます。
+     */
+    int submit(DBlockDeviceRequest* request);
+
+
+    /** 要求を1つ(書き込みと消去は1区切り)処理します
+     *
+     *  処理を行った場合はtrueを、キューが空だった場合はfalseを返します。
+     */
+    bool process();
+
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    /** 要求を待ち、処理し続けます
+     *
+     *  この関数は戻りません。専用のスレッドで実行してください。
+     */
+    void run();
+#endif
+
+
+    /** 要求を投入して完了を待ちます
+     *
+     *  RTOSがない場合は、完了するまでこの関数の中でprocess()を呼び出します。
+     */
+    int read(void* dst, bd_addr_t address, bd_size_t size, DBlockDeviceRequestPriority priority = D_BD_PRIORITY_NORMAL);
+    int program(const void* src, bd_addr_t address, bd_size_t size, DBlockDeviceRequestPriority priority = D_BD_PRIORITY_NORMAL);
+    int erase(bd_addr_t address, bd_size_t size, DBlockDeviceRequestPriority priority = D_BD_PRIORITY_BACKGROUND);
+
+
+    /** 書き込みを区切るサイズを設定します
+     *
+     *  デバイスの書き込み単位の倍数に切り捨てて使用します。
+     */
+    void setProgramSliceSize(bd_size_t size);
+
+
+    /** 消去を区切るサイズの上限を設定します
+     *
+     *  消去は、アドレスが揃っていて範囲に収まる、消去単位の2のべき乗倍のうち、
+     *  この値を超えない最大のサイズで区切ります。消去単位より小さい値を指定す
+     *  ると、消去単位ごとに区切ります。
+     */
+    void setEraseSliceSize(bd_size_t size);
+
+
+    /** キューに入っている要求の数を返します
+     */
+    size_t pendingCount() const;
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DBlockDeviceScheduler);
+
+    DBlockDeviceRequest* SelectRequest();
+    DBlockDeviceRequest* FindConflict(const DBlockDeviceRequest* request) const;
+    bool Unlink(DBlockDeviceRequest* request);
+    int ProcessRead(DBlockDeviceRequest* head, DBlockDeviceRequest** completed);
+    int SubmitAndWait(DBlockDeviceRequest* request);
+    bd_size_t GetSliceSize(const DBlockDeviceRequest* request, bd_addr_t address) const;
+
+    BlockDevice* m_blockDevice;
+    uint8_t* m_mergeBuffer;
+    size_t m_mergeBufferSize;
+    bd_size_t m_programSliceSize;
+    bd_size_t m_eraseSliceSize;
+    DBlockDeviceRequest* m_queues[D_BD_PRIORITY_COUNT];
+    DBlockDeviceRequest* m_active;
+    bd_addr_t m_position;
+    uint32_t m_sequence;
+    size_t m_pendingCount;
+    mutable PlatformMutex m_mutex;
+#ifdef MBED_CONF_RTOS_PRESENT
+    rtos::Semaphore m_event;
+#endif
+};
+
+
+#endif /* end of include guard: dandy_DBlockDeviceScheduler_hpp_ */
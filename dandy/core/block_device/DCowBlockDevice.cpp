@@ -0,0 +1,624 @@
+/**
+ *       @file  DCowBlockDevice.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/block_device/DCowBlockDevice.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+
+
+#define D__COW_LOG_MAGIC        (0x57434F44UL) /* "DOCW" */
+#define D__NO_SLOT              (0xFFFF)
+#define D__MAX_SLOTS            (0xFFFE)
+#define D__MAX_BLOCKS           (0x0FFFFFFF)
+#define D__TYPE_SHIFT           (28)
+#define D__BLOCK_MASK           (0x0FFFFFFFUL)
+#define D__COPY_CHUNK_SIZE      (256)
+
+
+DCowBlockDevice::DCowBlockDevice(BlockDevice* base,
+                                 BlockDevice* delta, bd_addr_t deltaAddress, bd_size_t deltaSize,
+                                 bd_size_t logSize)
+    : m_base(base)
+    , m_delta(delta)
+    , m_deltaAddress(deltaAddress)
+    , m_deltaSize(deltaSize)
+    , m_logSize(logSize)
+    , m_blockSize(0)
+    , m_recordStride(0)
+    , m_blockCount(0)
+    , m_slotCount(0)
+    , m_entries(nullptr)
+    , m_usedSlots(nullptr)
+    , m_slotCursor(0)
+    , m_area(0)
+    , m_seq(0)
+    , m_logTail(0)
+    , m_initialized(false)
+{
+    X_ASSERT(m_base);
+    X_ASSERT(m_delta);
+    X_ASSERT(m_logSize > 0);
+}
+
+DCowBlockDevice::~DCowBlockDevice()
+{
+    this->deinit();
+}
+
+int DCowBlockDevice::init()
+{
+    if (m_initialized)
+        return BD_ERROR_OK;
+
+    int result = m_base->init();
+    if (result != BD_ERROR_OK)
+        return result;
+    result = m_delta->init();
+    if (result != BD_ERROR_OK)
+        return result;
+
+    const bd_size_t deltaEraseSize = m_delta->get_erase_size();
+    const bd_size_t deltaProgramSize = m_delta->get_program_size();
+    if ((m_deltaAddress % deltaEraseSize) || (m_logSize % deltaEraseSize) ||
+        (m_deltaAddress + m_deltaSize > m_delta->size()) ||
+        (m_deltaSize < m_logSize * 2))
+        return BD_ERROR_DEVICE_ERROR;
+
+    m_blockSize = d_max<bd_size_t>(m_base->get_erase_size(), deltaEraseSize);
+    if ((m_blockSize % m_base->get_erase_size()) || (m_blockSize % deltaEraseSize))
+        return BD_ERROR_DEVICE_ERROR;
+
+    m_recordStride = ((sizeof(Record) + deltaProgramSize - 1) / deltaProgramSize) * deltaProgramSize;
+    m_blockCount = d_min<bd_size_t>(m_base->size() / m_blockSize, D__MAX_BLOCKS);
+    m_slotCount = d_min<bd_size_t>((m_deltaSize - m_logSize * 2) / m_blockSize, D__MAX_SLOTS);
+    if (!m_blockCount || !m_slotCount)
+        return BD_ERROR_DEVICE_ERROR;
+
+    m_entries = D_NEW(Entry[m_blockCount]);
+    m_usedSlots = D_NEW(uint8_t[(m_slotCount + 7) / 8]);
+    if (!m_entries || !m_usedSlots)
+    {
+        D_SAFE_DELETE_ARRAY(m_entries);
+        D_SAFE_DELETE_ARRAY(m_usedSlots);
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    m_mutex.lock();
+    result = this->Mount();
+    m_mutex.unlock();
+    if (result != BD_ERROR_OK)
+    {
+        D_SAFE_DELETE_ARRAY(m_entries);
+        D_SAFE_DELETE_ARRAY(m_usedSlots);
+        return result;
+    }
+
+    m_initialized = true;
+
+    return BD_ERROR_OK;
+}
+
+int DCowBlockDevice::deinit()
+{
+    if (!m_initialized)
+        return BD_ERROR_OK;
+
+    D_SAFE_DELETE_ARRAY(m_entries);
+    D_SAFE_DELETE_ARRAY(m_usedSlots);
+    m_initialized = false;
+
+    const int result = m_delta->deinit();
+    const int baseResult = m_base->deinit();
+
+    return (result != BD_ERROR_OK) ? result : baseResult;
+}
+
+int DCowBlockDevice::read(void* dst, bd_addr_t address, bd_size_t size)
+{
+    if (!this->is_valid_read(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    uint8_t* p = static_cast<uint8_t*>(dst);
+    int result = BD_ERROR_OK;
+
+    m_mutex.lock();
+    while (size && (result == BD_ERROR_OK))
+    {
+        const uint32_t block = address / m_blockSize;
+        const bd_size_t offset = address % m_blockSize;
+        const bd_size_t n = d_min<bd_size_t>(size, m_blockSize - offset);
+        const uint16_t slot = m_entries[block].current;
+
+        if (slot == D__NO_SLOT)
+            result = m_base->read(p, address, n);
+        else
+            result = m_delta->read(p, this->SlotAddress(slot) + offset, n);
+
+        p += n;
+        address += n;
+        size -= n;
+    }
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DCowBlockDevice::program(const void* src, bd_addr_t address, bd_size_t size)
+{
+    if (!this->is_valid_program(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    const uint8_t* p = static_cast<const uint8_t*>(src);
+    int result = BD_ERROR_OK;
+
+    m_mutex.lock();
+    while (size && (result == BD_ERROR_OK))
+    {
+        const uint32_t block = address / m_blockSize;
+        const bd_size_t offset = address % m_blockSize;
+        const bd_size_t n = d_min<bd_size_t>(size, m_blockSize - offset);
+        bd_addr_t slotAddress;
+
+        /* 初めて書き換えるブロックは、元の内容をコピーしたスロットに書き込む */
+        result = this->PrepareSlot(block, true, &slotAddress);
+        if (result == BD_ERROR_OK)
+            result = m_delta->program(p, slotAddress + offset, n);
+
+        p += n;
+        address += n;
+        size -= n;
+    }
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DCowBlockDevice::erase(bd_addr_t address, bd_size_t size)
+{
+    if (!this->is_valid_erase(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    int result = BD_ERROR_OK;
+
+    m_mutex.lock();
+    for (; size && (result == BD_ERROR_OK); address += m_blockSize, size -= m_blockSize)
+    {
+        bd_addr_t slotAddress;
+        result = this->PrepareSlot(address / m_blockSize, false, &slotAddress);
+    }
+    m_mutex.unlock();
+
+    return result;
+}
+
+bd_size_t DCowBlockDevice::get_read_size() const
+{
+    return d_max<bd_size_t>(m_base->get_read_size(), m_delta->get_read_size());
+}
+
+bd_size_t DCowBlockDevice::get_program_size() const
+{
+    return d_max<bd_size_t>(m_base->get_program_size(), m_delta->get_program_size());
+}
+
+bd_size_t DCowBlockDevice::get_erase_size() const
+{
+    return m_blockSize;
+}
+
+int DCowBlockDevice::get_erase_value() const
+{
+    const int value = m_delta->get_erase_value();
+    return (m_base->get_erase_value() == value) ? value : -1;
+}
+
+bd_size_t DCowBlockDevice::size() const
+{
+    return static_cast<bd_size_t>(m_blockCount) * m_blockSize;
+}
+
+int DCowBlockDevice::commit()
+{
+    X_ASSERT(m_initialized);
+
+    m_mutex.lock();
+    const int result = this->CommitEntries();
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DCowBlockDevice::discard()
+{
+    X_ASSERT(m_initialized);
+
+    m_mutex.lock();
+    this->DiscardEntries();
+    const int result = this->AppendRecord(RECORD_DISCARD, 0, 0);
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DCowBlockDevice::reset()
+{
+    X_ASSERT(m_initialized);
+
+    m_mutex.lock();
+    for (uint32_t i = 0; i < m_blockCount; i++)
+    {
+        m_entries[i].current = D__NO_SLOT;
+        m_entries[i].committed = D__NO_SLOT;
+    }
+    memset(m_usedSlots, 0, (m_slotCount + 7) / 8);
+    const int result = this->WriteArea(1 - m_area, m_seq + 1, false);
+    m_mutex.unlock();
+
+    return result;
+}
+
+size_t DCowBlockDevice::freeSlotCount() const
+{
+    size_t count = 0;
+    for (uint16_t i = 0; i < m_slotCount; i++)
+    {
+        if (!(m_usedSlots[i / 8] & (1 << (i % 8))))
+            count++;
+    }
+
+    return count;
+}
+
+int DCowBlockDevice::Mount()
+{
+    /* ヘッダが有効で、シーケンス番号が新しい方のログ領域を使用する */
+    int area = -1;
+    uint32_t seq = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        LogHeader header;
+        const int result = m_delta->read(&header, this->AreaAddress(i), sizeof(header));
+        if (result != BD_ERROR_OK)
+            return result;
+
+        if ((header.magic != D__COW_LOG_MAGIC) || (header.seq != ~header.seqInv))
+            continue;
+
+        if ((area < 0) || (static_cast<int32_t>(header.seq - seq) > 0))
+        {
+            area = i;
+            seq = header.seq;
+        }
+    }
+
+    for (uint32_t i = 0; i < m_blockCount; i++)
+    {
+        m_entries[i].current = D__NO_SLOT;
+        m_entries[i].committed = D__NO_SLOT;
+    }
+    memset(m_usedSlots, 0, (m_slotCount + 7) / 8);
+
+    if (area < 0)
+        return this->WriteArea(0, 1, false);
+
+    m_area = area;
+    m_seq = seq;
+
+    bool pending;
+    bool torn;
+    const int result = this->Replay(area, &pending, &torn);
+    if (result != BD_ERROR_OK)
+        return result;
+
+    /* commit()されていない書き換えは破棄する */
+    this->DiscardEntries();
+    for (uint32_t i = 0; i < m_blockCount; i++)
+    {
+        const uint16_t slot = m_entries[i].committed;
+        if (slot != D__NO_SLOT)
+            m_usedSlots[slot / 8] |= (1 << (slot % 8));
+    }
+
+    /* 書き込み途中のレコードがあれば、その後ろには追記できないので作り直す */
+    if (torn)
+        return this->WriteArea(1 - m_area, m_seq + 1, false);
+    if (pending)
+        return this->AppendRecord(RECORD_DISCARD, 0, 0);
+
+    return BD_ERROR_OK;
+}
+
+int DCowBlockDevice::Replay(int area, bool* pending, bool* torn)
+{
+    const bd_addr_t areaAddress = this->AreaAddress(area);
+
+    *pending = false;
+    *torn = false;
+    for (m_logTail = m_recordStride; m_logTail + m_recordStride <= m_logSize; m_logTail += m_recordStride)
+    {
+        Record record;
+        const int result = m_delta->read(&record, areaAddress + m_logTail, sizeof(record));
+        if (result != BD_ERROR_OK)
+            return result;
+
+        if ((record.typeAndBlock == 0xFFFFFFFFUL) && (record.slot == 0xFFFFFFFFUL) &&
+            (record.check == 0xFFFFFFFFUL))
+            break;
+
+        if (record.check != ~(record.typeAndBlock ^ record.slot))
+        {
+            *torn = true;
+            break;
+        }
+
+        const uint32_t type = record.typeAndBlock >> D__TYPE_SHIFT;
+        const uint32_t block = record.typeAndBlock & D__BLOCK_MASK;
+        switch (type)
+        {
+        case RECORD_MAP:
+            if ((block < m_blockCount) && (record.slot < m_slotCount))
+            {
+                m_entries[block].current = record.slot;
+                *pending = true;
+            }
+            break;
+        case RECORD_COMMIT:
+            for (uint32_t i = 0; i < m_blockCount; i++)
+                m_entries[i].committed = m_entries[i].current;
+            *pending = false;
+            break;
+        case RECORD_DISCARD:
+            for (uint32_t i = 0; i < m_blockCount; i++)
+                m_entries[i].current = m_entries[i].committed;
+            *pending = false;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return BD_ERROR_OK;
+}
+
+int DCowBlockDevice::WriteArea(int area, uint32_t seq, bool keepPending)
+{
+    const bd_addr_t areaAddress = this->AreaAddress(area);
+    int result = m_delta->erase(areaAddress, m_logSize);
+    if (result != BD_ERROR_OK)
+        return result;
+
+    m_area = area;
+    m_seq = seq;
+    m_logTail = m_recordStride;
+
+    /* 確定済みの対応、COMMIT、未確定の対応の順に書き、最後にヘッダを書く。ヘ
+     * ッダを書くまでは古い方のログ領域が有効なままになる。
+     */
+    for (int pass = 0; pass < 3; pass++)
+    {
+        if (pass == 1)
+        {
+            result = this->ProgramRecord(RECORD_COMMIT, 0, 0);
+            if (result != BD_ERROR_OK)
+                return result;
+            continue;
+        }
+        if ((pass == 2) && !keepPending)
+            break;
+
+        for (uint32_t i = 0; i < m_blockCount; i++)
+        {
+            const Entry& entry = m_entries[i];
+            const uint16_t slot = (pass == 0) ? entry.committed : entry.current;
+            if ((slot == D__NO_SLOT) || ((pass == 2) && (entry.current == entry.committed)))
+                continue;
+
+            result = this->ProgramRecord(RECORD_MAP, i, slot);
+            if (result != BD_ERROR_OK)
+                return result;
+        }
+    }
+
+    uint8_t header[D__COPY_CHUNK_SIZE];
+    X_ASSERT(m_recordStride <= sizeof(header));
+    memset(header, 0xFF, m_recordStride);
+
+    LogHeader* h = reinterpret_cast<LogHeader*>(header);
+    h->magic = D__COW_LOG_MAGIC;
+    h->seq = seq;
+    h->seqInv = ~seq;
+
+    return m_delta->program(header, areaAddress, m_recordStride);
+}
+
+int DCowBlockDevice::AppendRecord(RecordType type, uint32_t block, uint32_t slot)
+{
+    /* ログ領域が一杯になったら、もう一方の領域に現在の状態を書き直す。RAM上の
+     * 状態は呼び出し元で更新済みなので、このレコードを追記する必要はない。
+     */
+    if (m_logTail + m_recordStride > m_logSize)
+        return this->WriteArea(1 - m_area, m_seq + 1, true);
+
+    return this->ProgramRecord(type, block, slot);
+}
+
+int DCowBlockDevice::ProgramRecord(RecordType type, uint32_t block, uint32_t slot)
+{
+    if (m_logTail + m_recordStride > m_logSize)
+        return -ENOSPC;
+
+    uint8_t buffer[D__COPY_CHUNK_SIZE];
+    X_ASSERT(m_recordStride <= sizeof(buffer));
+    memset(buffer, 0xFF, m_recordStride);
+
+    Record* record = reinterpret_cast<Record*>(buffer);
+    record->typeAndBlock = (static_cast<uint32_t>(type) << D__TYPE_SHIFT) | (block & D__BLOCK_MASK);
+    record->slot = slot;
+    record->check = ~(record->typeAndBlock ^ record->slot);
+
+    const int result = m_delta->program(buffer, this->AreaAddress(m_area) + m_logTail, m_recordStride);
+    m_logTail += m_recordStride;
+
+    return result;
+}
+
+int DCowBlockDevice::CommitEntries()
+{
+    for (uint32_t i = 0; i < m_blockCount; i++)
+    {
+        Entry& entry = m_entries[i];
+        if (entry.current == entry.committed)
+            continue;
+
+        /* 置き換えられたスロットはCOMMITを書いた後は参照されない */
+        if (entry.committed != D__NO_SLOT)
+            this->FreeSlot(entry.committed);
+        entry.committed = entry.current;
+    }
+
+    return this->AppendRecord(RECORD_COMMIT, 0, 0);
+}
+
+void DCowBlockDevice::DiscardEntries()
+{
+    for (uint32_t i = 0; i < m_blockCount; i++)
+    {
+        Entry& entry = m_entries[i];
+        if (entry.current == entry.committed)
+            continue;
+
+        if (entry.current != D__NO_SLOT)
+            this->FreeSlot(entry.current);
+        entry.current = entry.committed;
+    }
+}
+
+int DCowBlockDevice::AllocateSlot(uint16_t* slot)
+{
+    for (uint16_t n = 0; n < m_slotCount; n++)
+    {
+        const uint16_t i = m_slotCursor;
+        m_slotCursor = (m_slotCursor + 1) % m_slotCount;
+
+        if (!(m_usedSlots[i / 8] & (1 << (i % 8))))
+        {
+            m_usedSlots[i / 8] |= (1 << (i % 8));
+            *slot = i;
+            return BD_ERROR_OK;
+        }
+    }
+
+    return -ENOSPC;
+}
+
+void DCowBlockDevice::FreeSlot(uint16_t slot)
+{
+    X_ASSERT(slot < m_slotCount);
+    m_usedSlots[slot / 8] &= ~(1 << (slot % 8));
+}
+
+int DCowBlockDevice::PrepareSlot(uint32_t block, bool copy, bd_addr_t* address)
+{
+    Entry& entry = m_entries[block];
+
+    /* commit()前に割り当てたスロットはそのまま書き換えてよい */
+    if ((entry.current != D__NO_SLOT) && (entry.current != entry.committed))
+    {
+        *address = this->SlotAddress(entry.current);
+        if (copy)
+            return BD_ERROR_OK;
+        return m_delta->erase(*address, m_blockSize);
+    }
+
+    uint16_t slot;
+    int result = this->AllocateSlot(&slot);
+    if (result != BD_ERROR_OK)
+        return result;
+
+    *address = this->SlotAddress(slot);
+    result = m_delta->erase(*address, m_blockSize);
+    if ((result == BD_ERROR_OK) && copy)
+        result = this->CopyToSlot(block, slot);
+    if (result != BD_ERROR_OK)
+    {
+        this->FreeSlot(slot);
+        return result;
+    }
+
+    entry.current = slot;
+
+    return this->AppendRecord(RECORD_MAP, block, slot);
+}
+
+int DCowBlockDevice::CopyToSlot(uint32_t block, uint16_t slot)
+{
+    const Entry& entry = m_entries[block];
+    const bd_addr_t dst = this->SlotAddress(slot);
+    const bd_size_t programSize = this->get_program_size();
+    const bd_size_t chunkSize = (D__COPY_CHUNK_SIZE / programSize) * programSize;
+    X_ASSERT(chunkSize > 0);
+
+    uint8_t chunk[D__COPY_CHUNK_SIZE];
+    for (bd_size_t offset = 0; offset < m_blockSize; offset += chunkSize)
+    {
+        const bd_size_t n = d_min<bd_size_t>(chunkSize, m_blockSize - offset);
+        int result;
+        if (entry.current == D__NO_SLOT)
+            result = m_base->read(chunk, static_cast<bd_addr_t>(block) * m_blockSize + offset, n);
+        else
+            result = m_delta->read(chunk, this->SlotAddress(entry.current) + offset, n);
+        if (result != BD_ERROR_OK)
+            return result;
+
+        result = m_delta->program(chunk, dst + offset, n);
+        if (result != BD_ERROR_OK)
+            return result;
+    }
+
+    return BD_ERROR_OK;
+}
+
+bd_addr_t DCowBlockDevice::SlotAddress(uint16_t slot) const
+{
+    return m_deltaAddress + m_logSize * 2 + static_cast<bd_addr_t>(slot) * m_blockSize;
+}
+
+bd_addr_t DCowBlockDevice::AreaAddress(int area) const
+{
+    return m_deltaAddress + m_logSize * area;
+}
@@ -0,0 +1,182 @@
+/**
+ *       @file  DCowBlockDevice.hpp
+ *      @brief  消去を先行して行うBlockDeviceラッパーです
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DCowBlockDevice_hpp_
+#define dandy_DCowBlockDevice_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include "platform/PlatformMutex.h"
+
+
+/** 読み出し専用のベースイメージに差分領域を重ねるコピーオンライトのBlockDeviceです
+ *
+ *  読み出しは、書き換えられたブロックは差分領域から、それ以外はベースデバイスか
+ *  ら行います。書き込みと消去は差分領域に割り当てたスロットに対して行い、ベース
+ *  デバイスには一切書き込みません。ブロックを最初に書き換える時だけ、元の内容を
+ *  スロットにコピーします。
+ *
+ *  書き換えはcommit()するまで仮のもので、discard()を呼ぶか、commit()せずに再起
+ *  動すると直前のcommit()の状態に戻ります。どちらも差分領域のログに1レコードを追
+ *  記するだけなので、すぐに完了します。reset()は差分をすべて捨ててベースイメー
+ *  ジの状態に戻します。
+ *
+ *  差分領域の先頭にはブロックとスロットの対応を記録するログ領域を2面(logSize×2)
+ *  置き、残りをブロックサイズのスロットに分割します。ブロックサイズはベースと差
+ *  分のデバイスの消去サイズの大きい方です。対応表はRAM上にも展開し、ブロック1つ
+ *  につき4バイトを使用します。
+ *
+ *  @code
+ *  DCowBlockDevice bd(&golden, &flash, 0x100000, 0x100000, 4096);
+ *  bd.init();
+ *  DBlockDeviceUtils::replace(&bd, config, 0x2000, sizeof(config));
+ *  if (verified)
+ *      bd.commit();
+ *  else
+ *      bd.discard();
+ *  @endcode
+ */
+class DCowBlockDevice : public BlockDevice
+{
+public:
+    DCowBlockDevice(BlockDevice* base,
+                    BlockDevice* delta, bd_addr_t deltaAddress, bd_size_t deltaSize,
+                    bd_size_t logSize);
+    virtual ~DCowBlockDevice() override;
+
+    /** 差分領域のログを読み込み、直前のcommit()の状態を復元します
+     *
+     *  ログがない場合は、ベースイメージの状態で初期化します。
+     */
+    virtual int init() override;
+    virtual int deinit() override;
+    virtual int read(void* dst, bd_addr_t address, bd_size_t size) override;
+    virtual int program(const void* src, bd_addr_t address, bd_size_t size) override;
+    virtual int erase(bd_addr_t address, bd_size_t size) override;
+    virtual bd_size_t get_read_size() const override;
+    virtual bd_size_t get_program_size() const override;
+    virtual bd_size_t get_erase_size() const override;
+    virtual int get_erase_value() const override;
+    virtual bd_size_t size() const override;
+
+
+    /** ここまでの書き換えを確定します
+     */
+    int commit();
+
+
+    /** 前回のcommit()以降の書き換えを破棄します
+     */
+    int discard();
+
+
+    /** すべての差分を破棄して、ベースイメージの状態に戻します
+     */
+    int reset();
+
+
+    /** 空いているスロットの数を返します
+     */
+    size_t freeSlotCount() const;
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DCowBlockDevice);
+
+    enum RecordType
+    {
+        RECORD_MAP     = 1,
+        RECORD_COMMIT  = 2,
+        RECORD_DISCARD = 3,
+    };
+
+    struct LogHeader
+    {
+        uint32_t magic;
+        uint32_t seq;
+        uint32_t seqInv;
+    };
+
+    struct Record
+    {
+        uint32_t typeAndBlock;  /* 上位4ビットが種類、残りがブロック番号 */
+        uint32_t slot;
+        uint32_t check;         /* ~(typeAndBlock ^ slot) */
+    };
+
+    struct Entry
+    {
+        uint16_t current;       /* 現在のスロット */
+        uint16_t committed;     /* commit()済みのスロット */
+    };
+
+    int Mount();
+    int Replay(int area, bool* pending, bool* torn);
+    int WriteArea(int area, uint32_t seq, bool keepPending);
+    int AppendRecord(RecordType type, uint32_t block, uint32_t slot);
+    int ProgramRecord(RecordType type, uint32_t block, uint32_t slot);
+    int CommitEntries();
+    void DiscardEntries();
+    int AllocateSlot(uint16_t* slot);
+    void FreeSlot(uint16_t slot);
+    int PrepareSlot(uint32_t block, bool copy, bd_addr_t* address);
+    int CopyToSlot(uint32_t block, uint16_t slot);
+    bd_addr_t SlotAddress(uint16_t slot) const;
+    bd_addr_t AreaAddress(int area) const;
+
+    BlockDevice* m_base;
+    BlockDevice* m_delta;
+    bd_addr_t m_deltaAddress;
+    bd_size_t m_deltaSize;
+    bd_size_t m_logSize;
+    bd_size_t m_blockSize;
+    bd_size_t m_recordStride;
+    uint32_t m_blockCount;
+    uint16_t m_slotCount;
+    Entry* m_entries;
+    uint8_t* m_usedSlots;   /* スロットの使用中ビットマップ */
+    uint16_t m_slotCursor;  /* 次に探し始めるスロット。書き込みを分散させる */
+    int m_area;             /* 現在のログ領域(0 or 1) */
+    uint32_t m_seq;
+    bd_size_t m_logTail;    /* ログ領域内の次のレコードの位置 */
+    bool m_initialized;
+    PlatformMutex m_mutex;
+};
+
+
+#endif /* end of include guard: dandy_DCowBlockDevice_hpp_ */
@@ -0,0 +1,378 @@
+/**
+ *       @file  DEraseAheadBlockDevice.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/block_device/DEraseAheadBlockDevice.hpp>
+
+
+#define D__BLOCKS_PER_BYTE  (4)
+#define D__STATE_BITS       (2)
+#define D__STATE_MASK       (0x03)
+#define D__NO_BLOCK         (static_cast<size_t>(-1))
+
+
+DEraseAheadBlockDevice::DEraseAheadBlockDevice(BlockDevice* blockDevice)
+    : m_blockDevice(blockDevice)
+    , m_states(nullptr)
+    , m_blockSize(0)
+    , m_blockCount(0)
+    , m_cursor(0)
+    , m_erasing(D__NO_BLOCK)
+#ifdef MBED_CONF_RTOS_PRESENT
+    , m_erasingWaiters(0)
+    , m_erased(0)
+#endif
+{
+    X_ASSERT(m_blockDevice);
+}
+
+DEraseAheadBlockDevice::~DEraseAheadBlockDevice()
+{
+    D_SAFE_DELETE_ARRAY(m_states);
+}
+
+int DEraseAheadBlockDevice::init()
+{
+    int result = m_blockDevice->init();
+    if (result != 0)
+        return result;
+
+    m_mutex.lock();
+    this->WaitForErasing(0, m_blockDevice->size());
+
+    m_blockSize = m_blockDevice->get_erase_size();
+    X_ASSERT(m_blockSize > 0);
+    m_blockCount = m_blockDevice->size() / m_blockSize;
+    m_cursor = 0;
+    m_erasing = D__NO_BLOCK;
+
+    /* 内容が分からないので、全ブロックを使用中として扱う */
+    const size_t bytes = (m_blockCount + D__BLOCKS_PER_BYTE - 1) / D__BLOCKS_PER_BYTE;
+    D_SAFE_DELETE_ARRAY(m_states);
+    m_states = D_NEW(uint8_t[bytes]);
+    if (m_states)
+        ::memset(m_states, 0, bytes);
+    else
+        result = BD_ERROR_DEVICE_ERROR;
+
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DEraseAheadBlockDevice::deinit()
+{
+    m_mutex.lock();
+    this->WaitForErasing(0, this->size());
+    D_SAFE_DELETE_ARRAY(m_states);
+    m_blockCount = 0;
+    m_mutex.unlock();
+
+    return m_blockDevice->deinit();
+}
+
+int DEraseAheadBlockDevice::sync()
+{
+    m_mutex.lock();
+    const int result = m_blockDevice->sync();
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DEraseAheadBlockDevice::read(void* dst, bd_addr_t address, bd_size_t size)
+{
+    m_mutex.lock();
+    const int result = m_blockDevice->read(dst, address, size);
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DEraseAheadBlockDevice::program(const void* src, bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(this->is_valid_program(address, size));
+
+    m_mutex.lock();
+    this->WaitForErasing(address, size);
+    const int result = m_blockDevice->program(src, address, size);
+
+    /* 書き込みに失敗した場合も、ブロックの内容は消去済みではなくなっている */
+    const bd_addr_t begin = address / m_blockSize * m_blockSize;
+    const bd_addr_t end = x_roundup_multiple(address + size, m_blockSize);
+    this->SetStates(begin, end - begin, BLOCK_IN_USE);
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DEraseAheadBlockDevice::erase(bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(this->is_valid_erase(address, size));
+
+    int result = 0;
+    size_t block = address / m_blockSize;
+    const size_t end = block + size / m_blockSize;
+
+    m_mutex.lock();
+    this->WaitForErasing(address, size);
+    while ((block < end) && (result == 0))
+    {
+        const BlockState state = this->GetState(block);
+        if ((state == BLOCK_ERASED) || (state == BLOCK_ACQUIRED))
+        {
+            /* 呼び出し元がこれから書き込むので、acquire()の対象から外す */
+            this->SetState(block, BLOCK_ACQUIRED);
+            block++;
+            continue;
+        }
+
+        /* 未消去のブロックが連続する範囲はまとめて消去して、下位のデバイスが大
+         * きな単位の消去コマンドを使えるようにする。
+         */
+        size_t last = block + 1;
+        while (last < end)
+        {
+            const BlockState s = this->GetState(last);
+            if ((s == BLOCK_ERASED) || (s == BLOCK_ACQUIRED))
+                break;
+            last++;
+        }
+
+        result = m_blockDevice->erase(block * m_blockSize, (last - block) * m_blockSize);
+        if (result == 0)
+            this->SetStates(block * m_blockSize, (last - block) * m_blockSize, BLOCK_ACQUIRED);
+        block = last;
+    }
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DEraseAheadBlockDevice::trim(bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(this->is_valid_erase(address, size));
+
+    m_mutex.lock();
+    this->WaitForErasing(address, size);
+    const size_t end = (address + size) / m_blockSize;
+    for (size_t block = address / m_blockSize; block < end; block++)
+    {
+        const BlockState state = this->GetState(block);
+        if (state == BLOCK_IN_USE)
+            this->SetState(block, BLOCK_FREE);
+        else if (state == BLOCK_ACQUIRED)
+            this->SetState(block, BLOCK_ERASED);
+    }
+    m_mutex.unlock();
+
+    return 0;
+}
+
+bd_size_t DEraseAheadBlockDevice::get_read_size() const
+{
+    return m_blockDevice->get_read_size();
+}
+
+bd_size_t DEraseAheadBlockDevice::get_program_size() const
+{
+    return m_blockDevice->get_program_size();
+}
+
+bd_size_t DEraseAheadBlockDevice::get_erase_size() const
+{
+    return m_blockDevice->get_erase_size();
+}
+
+int DEraseAheadBlockDevice::get_erase_value() const
+{
+    return m_blockDevice->get_erase_value();
+}
+
+bd_size_t DEraseAheadBlockDevice::size() const
+{
+    return m_blockDevice->size();
+}
+
+bool DEraseAheadBlockDevice::process()
+{
+    size_t block = D__NO_BLOCK;
+
+    m_mutex.lock();
+    for (size_t n = 0; (n < m_blockCount) && (m_erasing == D__NO_BLOCK); n++)
+    {
+        const size_t candidate = m_cursor;
+        m_cursor = (m_cursor + 1) % m_blockCount;
+
+        if (this->GetState(candidate) == BLOCK_FREE)
+        {
+            block = candidate;
+            m_erasing = block;
+        }
+    }
+    const bd_size_t blockSize = m_blockSize;
+    m_mutex.unlock();
+
+    if (block == D__NO_BLOCK)
+        return false;
+
+    /* 消去中はロックを外して、フォアグラウンドの読み出しを待たせない。このブ
+     * ロックへの書き込みや消去はWaitForErasing()で完了を待つので、状態は
+     * BLOCK_FREEのまま変わらない。
+     */
+    const int result = m_blockDevice->erase(block * blockSize, blockSize);
+
+    m_mutex.lock();
+    X_ASSERT(this->GetState(block) == BLOCK_FREE);
+    if (result == 0)
+    {
+        this->SetState(block, BLOCK_ERASED);
+    }
+    else
+    {
+        /* 消去できないブロックは、何度も再試行しないように使用中に戻す */
+        X_LOG_WARN(("DEraseAheadBlockDevice", "erase failed at 0x%08X", static_cast<unsigned>(block * blockSize)));
+        this->SetState(block, BLOCK_IN_USE);
+    }
+    m_erasing = D__NO_BLOCK;
+#ifdef MBED_CONF_RTOS_PRESENT
+    for (; m_erasingWaiters > 0; m_erasingWaiters--)
+        m_erased.release();
+#endif
+    m_mutex.unlock();
+
+    return result == 0;
+}
+
+int DEraseAheadBlockDevice::acquire(bd_size_t size, bd_addr_t* address)
+{
+    X_ASSERT(address);
+
+    const size_t count = x_roundup_multiple(size, m_blockSize) / m_blockSize;
+    if ((count == 0) || (count > m_blockCount))
+        return -EINVAL;
+
+    int result = -ENOSPC;
+    size_t run = 0;
+
+    m_mutex.lock();
+    for (size_t block = 0; block < m_blockCount; block++)
+    {
+        run = (this->GetState(block) == BLOCK_ERASED) ? run + 1 : 0;
+        if (run == count)
+        {
+            const size_t first = block + 1 - count;
+            *address = first * m_blockSize;
+            this->SetStates(*address, count * m_blockSize, BLOCK_ACQUIRED);
+            result = 0;
+            break;
+        }
+    }
+    m_mutex.unlock();
+
+    return result;
+}
+
+bd_size_t DEraseAheadBlockDevice::pendingSize() const
+{
+    return this->CountState(BLOCK_FREE) * m_blockSize;
+}
+
+bd_size_t DEraseAheadBlockDevice::erasedSize() const
+{
+    return this->CountState(BLOCK_ERASED) * m_blockSize;
+}
+
+DEraseAheadBlockDevice::BlockState DEraseAheadBlockDevice::GetState(size_t block) const
+{
+    const unsigned shift = (block % D__BLOCKS_PER_BYTE) * D__STATE_BITS;
+    return static_cast<BlockState>((m_states[block / D__BLOCKS_PER_BYTE] >> shift) & D__STATE_MASK);
+}
+
+void DEraseAheadBlockDevice::SetState(size_t block, BlockState state)
+{
+    const unsigned shift = (block % D__BLOCKS_PER_BYTE) * D__STATE_BITS;
+    uint8_t& b = m_states[block / D__BLOCKS_PER_BYTE];
+    b = (b & ~(D__STATE_MASK << shift)) | (state << shift);
+}
+
+void DEraseAheadBlockDevice::SetStates(bd_addr_t address, bd_size_t size, BlockState state)
+{
+    const size_t end = (address + size) / m_blockSize;
+    for (size_t block = address / m_blockSize; block < end; block++)
+        this->SetState(block, state);
+}
+
+size_t DEraseAheadBlockDevice::CountState(BlockState state) const
+{
+    size_t count = 0;
+    for (size_t block = 0; block < m_blockCount; block++)
+    {
+        if (this->GetState(block) == state)
+            count++;
+    }
+
+    return count;
+}
+
+void DEraseAheadBlockDevice::WaitForErasing(bd_addr_t address, bd_size_t size)
+{
+    /* ロックを保持した状態で呼び出す。process()が消去中のブロックに書き込むと、
+     * 後から実行される消去で書き込んだデータが消えてしまうので、消去の完了を待
+     * つ。RTOSがなければprocess()と並行して呼ばれることはない。
+     */
+#ifdef MBED_CONF_RTOS_PRESENT
+    for (;;)
+    {
+        if (m_erasing == D__NO_BLOCK)
+            return;
+
+        const bd_addr_t begin = m_erasing * m_blockSize;
+        if ((address >= begin + m_blockSize) || (begin >= address + size))
+            return;
+
+        m_erasingWaiters++;
+        m_mutex.unlock();
+        m_erased.wait();
+        m_mutex.lock();
+    }
+#else
+    X_UNUSED(address);
+    X_UNUSED(size);
+#endif
+}
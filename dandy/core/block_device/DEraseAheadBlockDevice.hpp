@@ -0,0 +1,171 @@
+/**
+ *       @file  DEraseAheadBlockDevice.hpp
+ *      @brief  消去を先行して行うBlockDeviceラッパーです
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DEraseAheadBlockDevice_hpp_
+#define dandy_DEraseAheadBlockDevice_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include "platform/PlatformMutex.h"
+#ifdef MBED_CONF_RTOS_PRESENT
+#include "rtos/Semaphore.h"
+#endif
+
+
+/** 空き領域の消去を先行して行うBlockDeviceラッパーです
+ *
+ *  SPIフラッシュのセクタ消去は数十〜数百msかかり、その間呼び出し元をブロックし
+ *  ます。このクラスはtrim()で不要になったと通知された領域を覚えておき、
+ *  process()が呼ばれた時に1ブロックずつ消去しておきます。消去済みのブロックに対
+ *  するerase()は何もせずに即座に戻るので、書き込み側は書き込み時間だけを待てば
+ *  よくなります。
+ *
+ *  process()はアイドルフックや低優先度のスレッドから呼び出してください。1回の呼
+ *  び出しで消去するのはget_erase_size()の1ブロックだけなので、フォアグラウンド
+ *  の読み書きが待たされるのは最大で1ブロックの消去時間です。消去中はこのクラ
+ *  スのロックを外しているので、下位のデバイスが消去サスペンドに対応していれば、
+ *  読み出しは消去の完了を待ちません。消去中のブロックに対するprogram(), erase(),
+ *  trim()は、消去の完了を待ってから行います。
+ *
+ *  acquire()を使用すると、消去済みの連続領域を確保することができます。
+ *
+ *  消去済みかどうかの判定はこのクラスを通した書き込みだけで管理しているので、下
+ *  位のBlockDeviceに直接書き込んではいけません。
+ *
+ *  @code
+ *  DEraseAheadBlockDevice bd(&flash);
+ *  bd.init();
+ *  bd.trim(0, bd.size());
+ *
+ *  // 低優先度スレッド
+ *  for (;;)
+ *  {
+ *      if (!bd.process())
+ *          wait_ms(10);
+ *  }
+ *  @endcode
+ */
+class DEraseAheadBlockDevice : public BlockDevice
+{
+public:
+    explicit DEraseAheadBlockDevice(BlockDevice* blockDevice);
+    virtual ~DEraseAheadBlockDevice() override;
+
+    virtual int init() override;
+    virtual int deinit() override;
+    virtual int sync() override;
+    virtual int read(void* dst, bd_addr_t address, bd_size_t size) override;
+    virtual int program(const void* src, bd_addr_t address, bd_size_t size) override;
+
+    /** 指定範囲を消去します
+     *
+     *  消去済み、またはacquire()で確保したばかりのブロックは消去を省略します。
+     */
+    virtual int erase(bd_addr_t address, bd_size_t size) override;
+
+    /** 指定範囲を未使用として登録し、process()での消去の対象にします
+     */
+    virtual int trim(bd_addr_t address, bd_size_t size) override;
+
+    virtual bd_size_t get_read_size() const override;
+    virtual bd_size_t get_program_size() const override;
+    virtual bd_size_t get_erase_size() const override;
+    virtual int get_erase_value() const override;
+    virtual bd_size_t size() const override;
+
+
+    /** 未使用ブロックを1つ消去します
+     *
+     *  消去を行った場合はtrueを、消去待ちのブロックがなかった場合はfalseを返しま
+     *  す。
+     */
+    bool process();
+
+
+    /** 消去済みの連続領域をsizeバイト確保します
+     *
+     *  確保した領域は消去済みなので、erase()は即座に戻り、そのまま書き込むことが
+     *  できます。十分な消去済み領域がない場合は-ENOSPCを返します。
+     */
+    int acquire(bd_size_t size, bd_addr_t* address);
+
+
+    /** 消去待ちのサイズを返します
+     */
+    bd_size_t pendingSize() const;
+
+
+    /** 消去済みで未確保のサイズを返します
+     */
+    bd_size_t erasedSize() const;
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DEraseAheadBlockDevice);
+
+    enum BlockState
+    {
+        BLOCK_IN_USE,    /* 書き込み済みか内容が不明 */
+        BLOCK_FREE,      /* 未使用で消去待ち */
+        BLOCK_ERASED,    /* 消去済み */
+        BLOCK_ACQUIRED,  /* 消去済みでacquire()で確保済み */
+    };
+
+    BlockState GetState(size_t block) const;
+    void SetState(size_t block, BlockState state);
+    void SetStates(bd_addr_t address, bd_size_t size, BlockState state);
+    size_t CountState(BlockState state) const;
+    void WaitForErasing(bd_addr_t address, bd_size_t size);
+
+    BlockDevice* m_blockDevice;
+    PlatformMutex m_mutex;
+    uint8_t* m_states;
+    bd_size_t m_blockSize;
+    size_t m_blockCount;
+    size_t m_cursor;
+
+    /* process()がロックを外して消去中のブロックと、その完了を待っている数 */
+    size_t m_erasing;
+#ifdef MBED_CONF_RTOS_PRESENT
+    int m_erasingWaiters;
+    rtos::Semaphore m_erased;
+#endif
+};
+
+
+#endif /* end of include guard: dandy_DEraseAheadBlockDevice_hpp_ */
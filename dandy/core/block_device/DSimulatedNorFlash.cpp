@@ -0,0 +1,501 @@
+/**
+ *       @file  DSimulatedNorFlash.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/block_device/DSimulatedNorFlash.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+
+
+#define D__ERASE_VALUE  (0xFF)
+
+
+/* 各値はデータシートの標準値です。読み出しはFast Read(コマンド、アドレス3バ
+ * イト、ダミー1バイト)を想定しています。
+ */
+static const DSimulatedNorFlash::Region D__sst26Regions[] = {
+    { 32 * 1024, 0x03 },    /* 4KB, 8KB */
+    { 32 * 1024, 0x05 },    /* 4KB, 32KB */
+    { 0,         0x09 },    /* 4KB, 64KB */
+    { 32 * 1024, 0x05 },
+    { 32 * 1024, 0x03 },
+};
+
+
+static const DSimulatedNorFlash::Profile D__sst26vf064b = {
+    "SST26VF064B",
+    8 * 1024 * 1024,
+    256,
+    104000000,
+    5,
+    1000,
+    {
+        { 4 * 1024,  18000 },
+        { 8 * 1024,  18000 },
+        { 32 * 1024, 18000 },
+        { 64 * 1024, 18000 },
+    },
+    D__sst26Regions,
+    D_COUNT_OF(D__sst26Regions),
+};
+
+
+static const DSimulatedNorFlash::Region D__is25Regions[] = {
+    { 0, 0x07 },            /* 4KB, 32KB, 64KB */
+};
+
+
+static const DSimulatedNorFlash::Profile D__is25lp064a = {
+    "IS25LP064A",
+    8 * 1024 * 1024,
+    256,
+    133000000,
+    5,
+    200,
+    {
+        { 4 * 1024,  70000 },
+        { 32 * 1024, 100000 },
+        { 64 * 1024, 150000 },
+        { 0, 0 },
+    },
+    D__is25Regions,
+    D_COUNT_OF(D__is25Regions),
+};
+
+
+const DSimulatedNorFlash::Profile& DSimulatedNorFlash::sst26vf064b()
+{
+    return D__sst26vf064b;
+}
+
+
+const DSimulatedNorFlash::Profile& DSimulatedNorFlash::is25lp064a()
+{
+    return D__is25lp064a;
+}
+
+
+DSimulatedNorFlash::DSimulatedNorFlash(const Profile& profile)
+    : m_profile(profile)
+    , m_memory(nullptr)
+    , m_eraseCounts(nullptr)
+    , m_sectorSize(0)
+    , m_sectorCount(0)
+    , m_strict(false)
+    , m_powerCutEnabled(false)
+    , m_operationsBeforeCut(0)
+    , m_elapsedNs(0)
+    , m_programViolations(0)
+    , m_readCount(0)
+    , m_pageProgramCount(0)
+    , m_eraseOperationCount(0)
+{
+    X_ASSERT(m_profile.size > 0);
+    X_ASSERT(m_profile.pageSize > 0);
+    X_ASSERT(m_profile.spiFrequency > 0);
+    X_ASSERT(m_profile.eraseTypes[0].size > 0);
+    X_ASSERT(m_profile.regionCount > 0);
+
+    /* 消去回数は最小の消去単位ごとに記録する */
+    m_sectorSize = m_profile.eraseTypes[0].size;
+    for (int i = 1; i < MAX_ERASE_TYPES; i++)
+    {
+        if (m_profile.eraseTypes[i].size)
+            m_sectorSize = d_min<bd_size_t>(m_sectorSize, m_profile.eraseTypes[i].size);
+    }
+    X_ASSERT((m_profile.size % m_sectorSize) == 0);
+    m_sectorCount = m_profile.size / m_sectorSize;
+}
+
+
+DSimulatedNorFlash::~DSimulatedNorFlash()
+{
+    this->deinit();
+    D_SAFE_DELETE_ARRAY(m_eraseCounts);
+}
+
+
+int DSimulatedNorFlash::init()
+{
+    if (m_memory)
+        return BD_ERROR_OK;
+
+    m_memory = D_NEW(uint8_t[m_profile.size]);
+    if (!m_memory)
+        return BD_ERROR_DEVICE_ERROR;
+
+    /* 出荷時の状態と同じく、全域消去済みとして開始する */
+    memset(m_memory, D__ERASE_VALUE, m_profile.size);
+
+    if (!m_eraseCounts)
+    {
+        m_eraseCounts = D_NEW(uint32_t[m_sectorCount]);
+        if (!m_eraseCounts)
+        {
+            D_SAFE_DELETE_ARRAY(m_memory);
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        memset(m_eraseCounts, 0, sizeof(uint32_t) * m_sectorCount);
+    }
+
+    return BD_ERROR_OK;
+}
+
+
+int DSimulatedNorFlash::deinit()
+{
+    D_SAFE_DELETE_ARRAY(m_memory);
+    return BD_ERROR_OK;
+}
+
+
+int DSimulatedNorFlash::read(void* dst, bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(m_memory);
+    if (!this->is_valid_read(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    memcpy(dst, m_memory + address, size);
+    this->AddTransferTime(m_profile.commandBytes + size);
+    m_readCount++;
+
+    return BD_ERROR_OK;
+}
+
+
+int DSimulatedNorFlash::program(const void* src, bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(m_memory);
+    if (!this->is_valid_program(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    const uint8_t* p = static_cast<const uint8_t*>(src);
+
+    /* strictモードでは、途中のページで失敗して一部だけ書き込まれることがないよ
+     * うに、先に全体を検査する */
+    if (m_strict)
+    {
+        bd_size_t violations = 0;
+        for (bd_size_t checked = 0; checked < size; )
+        {
+            const bd_addr_t a = address + checked;
+            const bd_size_t n = d_min<bd_size_t>(size - checked, m_profile.pageSize - (a % m_profile.pageSize));
+            violations += this->CountViolations(p + checked, a, n);
+            checked += n;
+        }
+
+        if (violations)
+        {
+            m_programViolations += violations;
+            return BD_ERROR_DEVICE_ERROR;
+        }
+    }
+
+    while (size)
+    {
+        const bd_size_t n = d_min<bd_size_t>(size, m_profile.pageSize - (address % m_profile.pageSize));
+        const int ret = this->pageProgram(p, address, n);
+        if (ret)
+            return ret;
+
+        p += n;
+        address += n;
+        size -= n;
+    }
+
+    return BD_ERROR_OK;
+}
+
+
+int DSimulatedNorFlash::pageProgram(const void* src, bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(m_memory);
+    X_ASSERT(size <= m_profile.pageSize);
+    if (address >= m_profile.size)
+        return BD_ERROR_DEVICE_ERROR;
+
+    if (!this->ConsumeOperation())
+        return BD_ERROR_DEVICE_ERROR;
+
+    const uint8_t* p = static_cast<const uint8_t*>(src);
+    const bd_size_t violations = this->CountViolations(p, address, size);
+    m_programViolations += violations;
+    if (violations && m_strict)
+        return BD_ERROR_DEVICE_ERROR;
+
+    /* デバイスに転送されたデータは、ページの末尾に達するとページの先頭に折り返
+     * して書き込まれる。
+     */
+    const bd_addr_t page = address - (address % m_profile.pageSize);
+    bd_size_t offset = address - page;
+    for (bd_size_t i = 0; i < size; i++)
+    {
+        m_memory[page + offset] &= p[i];
+        offset = (offset + 1) % m_profile.pageSize;
+    }
+
+    this->AddTransferTime(m_profile.commandBytes - 1 + size);
+    m_elapsedNs += static_cast<uint64_t>(m_profile.programPageUs) * 1000;
+    m_pageProgramCount++;
+
+    return BD_ERROR_OK;
+}
+
+
+int DSimulatedNorFlash::erase(bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(m_memory);
+    if (!this->is_valid_erase(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    const bd_addr_t end = address + size;
+    while (address < end)
+    {
+        const int type = this->FindEraseType(address, end);
+        if (type < 0)
+            return BD_ERROR_DEVICE_ERROR;
+        if (!this->ConsumeOperation())
+            return BD_ERROR_DEVICE_ERROR;
+
+        this->EraseUnit(address, type);
+        address += m_profile.eraseTypes[type].size;
+    }
+
+    return BD_ERROR_OK;
+}
+
+
+int DSimulatedNorFlash::eraseCommand(bd_addr_t address, uint8_t typeMask)
+{
+    X_ASSERT(m_memory);
+    if (address >= m_profile.size)
+        return BD_ERROR_DEVICE_ERROR;
+
+    bd_addr_t regionEnd;
+    const uint8_t available = this->FindRegion(address, &regionEnd) & typeMask;
+    int type = -1;
+    for (int i = 0; i < MAX_ERASE_TYPES; i++)
+    {
+        if ((available & (1 << i)) && m_profile.eraseTypes[i].size)
+        {
+            /* 1つのコマンドが同じ領域で複数の大きさを持つことはない */
+            X_ASSERT(type < 0);
+            type = i;
+        }
+    }
+
+    if (type < 0)
+        return BD_ERROR_DEVICE_ERROR;
+    if (!this->ConsumeOperation())
+        return BD_ERROR_DEVICE_ERROR;
+
+    const bd_size_t eraseSize = m_profile.eraseTypes[type].size;
+    this->EraseUnit(address - (address % eraseSize), type);
+
+    return BD_ERROR_OK;
+}
+
+
+bd_size_t DSimulatedNorFlash::get_read_size() const
+{
+    return 1;
+}
+
+
+bd_size_t DSimulatedNorFlash::get_program_size() const
+{
+    return 1;
+}
+
+
+bd_size_t DSimulatedNorFlash::get_erase_size() const
+{
+    return m_sectorSize;
+}
+
+
+int DSimulatedNorFlash::get_erase_value() const
+{
+    return D__ERASE_VALUE;
+}
+
+
+bd_size_t DSimulatedNorFlash::size() const
+{
+    return m_profile.size;
+}
+
+
+uint32_t DSimulatedNorFlash::eraseCount(bd_addr_t address) const
+{
+    X_ASSERT(address < m_profile.size);
+    if (!m_eraseCounts)
+        return 0;
+
+    return m_eraseCounts[address / m_sectorSize];
+}
+
+
+uint32_t DSimulatedNorFlash::maxEraseCount() const
+{
+    uint32_t maxCount = 0;
+    if (!m_eraseCounts)
+        return 0;
+
+    for (size_t i = 0; i < m_sectorCount; i++)
+        maxCount = d_max<uint32_t>(maxCount, m_eraseCounts[i]);
+
+    return maxCount;
+}
+
+
+void DSimulatedNorFlash::setPowerCutAfter(uint64_t operations)
+{
+    m_powerCutEnabled = true;
+    m_operationsBeforeCut = operations;
+}
+
+
+void DSimulatedNorFlash::resetStatistics()
+{
+    m_elapsedNs = 0;
+    m_programViolations = 0;
+    m_readCount = 0;
+    m_pageProgramCount = 0;
+    m_eraseOperationCount = 0;
+}
+
+
+int DSimulatedNorFlash::FindEraseType(bd_addr_t address, bd_addr_t end) const
+{
+    bd_addr_t regionEnd;
+    const uint8_t typeMask = this->FindRegion(address, &regionEnd);
+
+    /* 消去単位が2のべき乗であれば、アライメントが合って範囲に収まる最大の単位を
+     * 選ぶことで消去回数が最小になる。
+     */
+    int found = -1;
+    for (int i = 0; i < MAX_ERASE_TYPES; i++)
+    {
+        const bd_size_t eraseSize = m_profile.eraseTypes[i].size;
+        if (!(typeMask & (1 << i)) || !eraseSize)
+            continue;
+        if ((address % eraseSize) || (address + eraseSize > end) || (address + eraseSize > regionEnd))
+            continue;
+        if ((found < 0) || (eraseSize > m_profile.eraseTypes[found].size))
+            found = i;
+    }
+
+    return found;
+}
+
+
+uint8_t DSimulatedNorFlash::FindRegion(bd_addr_t address, bd_addr_t* regionEnd) const
+{
+    /* addressを含む領域を探す */
+    bd_size_t fixedSize = 0;
+    for (int i = 0; i < m_profile.regionCount; i++)
+        fixedSize += m_profile.regions[i].size;
+    X_ASSERT(fixedSize <= m_profile.size);
+
+    bd_addr_t end = 0;
+    for (int i = 0; i < m_profile.regionCount; i++)
+    {
+        const bd_size_t regionSize = m_profile.regions[i].size
+                                   ? m_profile.regions[i].size
+                                   : m_profile.size - fixedSize;
+        end += regionSize;
+        if (address < end)
+        {
+            *regionEnd = end;
+            return m_profile.regions[i].typeMask;
+        }
+    }
+
+    *regionEnd = end;
+    return 0;
+}
+
+
+void DSimulatedNorFlash::EraseUnit(bd_addr_t address, int type)
+{
+    const EraseType& eraseType = m_profile.eraseTypes[type];
+    memset(m_memory + address, D__ERASE_VALUE, eraseType.size);
+    for (bd_addr_t a = address; a < address + eraseType.size; a += m_sectorSize)
+        m_eraseCounts[a / m_sectorSize]++;
+
+    /* コマンドとアドレスの転送 */
+    this->AddTransferTime(m_profile.commandBytes - 1);
+    m_elapsedNs += static_cast<uint64_t>(eraseType.typicalUs) * 1000;
+    m_eraseOperationCount++;
+}
+
+
+void DSimulatedNorFlash::AddTransferTime(bd_size_t bytes)
+{
+    m_elapsedNs += (static_cast<uint64_t>(bytes) * 8 * 1000000000) / m_profile.spiFrequency;
+}
+
+
+bd_size_t DSimulatedNorFlash::CountViolations(const uint8_t* src, bd_addr_t address, bd_size_t size) const
+{
+    /* ページ内で折り返す書き込みと同じ順にアドレスを辿る */
+    bd_size_t violations = 0;
+    const bd_addr_t page = address - (address % m_profile.pageSize);
+    bd_size_t offset = address - page;
+    for (bd_size_t i = 0; i < size; i++)
+    {
+        if ((m_memory[page + offset] & src[i]) != src[i])
+            violations++;
+
+        offset = (offset + 1) % m_profile.pageSize;
+    }
+
+    return violations;
+}
+
+
+bool DSimulatedNorFlash::ConsumeOperation()
+{
+    if (!m_powerCutEnabled)
+        return true;
+    if (m_operationsBeforeCut == 0)
+        return false;
+
+    m_operationsBeforeCut--;
+    return true;
+}
@@ -0,0 +1,255 @@
+/**
+ *       @file  DSimulatedNorFlash.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DSimulatedNorFlash_hpp_
+#define dandy_DSimulatedNorFlash_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+
+
+/** NORフラッシュの動作をRAM上で模擬するBlockDeviceです
+ *
+ *  ホスト環境でブロックデバイスを使うコードの試験や性能評価を行うためのもので、
+ *  次のようなNORフラッシュの性質を再現します。
+ *
+ *  + 書き込みはビットを0にすることしかできない
+ *  + 消去はセクタやブロック単位で、消去後は0xFFになる
+ *  + 1回のページプログラムはページ境界で折り返す
+ *
+ *  また、プロファイルに設定した読み出し、書き込み、消去の時間から、実機で掛かる
+ *  はずの時間を積算し、セクタごとの消去回数を記録します。
+ *
+ *  プロファイルはSST26VF064BとIS25LP064Aのデータシートの標準値を用意していま
+ *  す。SST26のプロファイルは、DSST26と同じく先頭と末尾の64KBが8KB/32KBブロック
+ *  になっている不均一なブロック構成を再現します。
+ *
+ *  ホストではtest/host/CMakeLists.txtのdandy-hostライブラリとしてビルドできま
+ *  す(DPlatform.hppのホスト向けの定義を使用します)。
+ *
+ *  @code
+ *  DSimulatedNorFlash flash(DSimulatedNorFlash::sst26vf064b());
+ *  flash.init();
+ *  DBlockDeviceUtils::replace(&flash, 0, data, sizeof(data));
+ *  printf("%llu us\n", flash.elapsedMicroSeconds());
+ *  @endcode
+ */
+class DSimulatedNorFlash : public BlockDevice
+{
+public:
+
+    /** 消去コマンドの種類の最大数です
+     */
+    static const int MAX_ERASE_TYPES = 4;
+
+
+    /** 消去コマンドの種類です
+     */
+    struct EraseType
+    {
+        bd_size_t size;
+        uint32_t typicalUs;
+    };
+
+
+    /** ブロック構成の領域です
+     *
+     *  sizeが0の領域は、他の領域を除いた残りすべてを表します。typeMaskは
+     *  Profile::eraseTypesのうち、この領域で使用可能なもののビットマスクです。
+     */
+    struct Region
+    {
+        bd_size_t size;
+        uint8_t typeMask;
+    };
+
+
+    /** デバイスの構成と時間の設定です
+     */
+    struct Profile
+    {
+        const char* name;
+        bd_size_t size;
+        bd_size_t pageSize;
+        uint32_t spiFrequency;     /* 読み出し時間の計算に使用するSPIクロック */
+        uint32_t commandBytes;     /* コマンド、アドレス、ダミーのバイト数 */
+        uint32_t programPageUs;    /* 1ページの書き込み時間 */
+        EraseType eraseTypes[MAX_ERASE_TYPES];
+        const Region* regions;
+        int regionCount;
+    };
+
+
+    /** SST26VF064B (8MB, 不均一ブロック構成)のプロファイルを返します
+     */
+    static const Profile& sst26vf064b();
+
+
+    /** IS25LP064A (8MB)のプロファイルを返します
+     */
+    static const Profile& is25lp064a();
+
+
+    explicit DSimulatedNorFlash(const Profile& profile);
+    virtual ~DSimulatedNorFlash() override;
+    virtual int init() override;
+    virtual int deinit() override;
+    virtual int read(void* dst, bd_addr_t address, bd_size_t size) override;
+
+    /** ページ境界で分割して書き込みます
+     */
+    virtual int program(const void* src, bd_addr_t address, bd_size_t size) override;
+
+    /** 範囲を最も少ない回数で消去できる消去コマンドを選択して消去します
+     */
+    virtual int erase(bd_addr_t address, bd_size_t size) override;
+    virtual bd_size_t get_read_size() const override;
+    virtual bd_size_t get_program_size() const override;
+    virtual bd_size_t get_erase_size() const override;
+    virtual int get_erase_value() const override;
+    virtual bd_size_t size() const override;
+
+
+    /** 1回のページプログラムコマンドを模擬します
+     *
+     *  sizeはページサイズ以下でなければなりません。ページの末尾を越えたデータは
+     *  ページの先頭に折り返して書き込まれます。
+     */
+    int pageProgram(const void* src, bd_addr_t address, bd_size_t size);
+
+
+    /** 1回の消去コマンドを模擬します
+     *
+     *  typeMaskはコマンドが消去するProfile::eraseTypesのビットマスクです。SST26の
+     *  ブロック消去のように、1つのコマンドの消去サイズが領域ごとに変わる場合は
+     *  複数のビットを指定します。addressを含む領域で使用可能な種類で消去し、実機
+     *  と同じくアドレスの下位ビットは無視して消去単位の先頭から消去します。その
+     *  領域で使用できる種類がなければエラーを返します。
+     */
+    int eraseCommand(bd_addr_t address, uint8_t typeMask);
+
+
+    /** 消去されていないビットを1にしようとした時にエラーにするかどうかを設定します
+     *
+     *  デフォルトは無効で、その場合は実機と同じく該当ビットは0のままになり、
+     *  programViolations()に加算されます。有効な場合は、違反があるとメモリを変更
+     *  せずにエラーを返します。
+     */
+    void setStrict(bool strict) { m_strict = strict; }
+
+
+    /** operations回のページプログラムと消去コマンドの後で電源断を模擬します
+     *
+     *  電源断の後のページプログラムと消去は、メモリを変更せずにエラーを返しま
+     *  す。メモリの内容は保持されるので、restorePower()の後に再マウントすること
+     *  で、書き込みの途中で電源が落ちた場合の復旧を試験できます。
+     */
+    void setPowerCutAfter(uint64_t operations);
+
+
+    /** setPowerCutAfter()を解除します
+     */
+    void restorePower() { m_powerCutEnabled = false; }
+
+
+    /** 電源断の状態かどうかを返します
+     */
+    bool isPowerCut() const { return m_powerCutEnabled && (m_operationsBeforeCut == 0); }
+
+
+    /** 積算した時間をマイクロ秒単位で返します
+     */
+    uint64_t elapsedMicroSeconds() const { return m_elapsedNs / 1000; }
+
+
+    /** addressを含むセクタの消去回数を返します
+     */
+    uint32_t eraseCount(bd_addr_t address) const;
+
+
+    /** 全セクタの中で最大の消去回数を返します
+     */
+    uint32_t maxEraseCount() const;
+
+
+    /** 消去されていないビットを1にしようとしたバイト数を返します
+     */
+    uint64_t programViolations() const { return m_programViolations; }
+
+
+    /** 発行したコマンドの回数です
+     */
+    uint64_t readCount() const { return m_readCount; }
+    uint64_t pageProgramCount() const { return m_pageProgramCount; }
+    uint64_t eraseOperationCount() const { return m_eraseOperationCount; }
+
+
+    /** 時間と回数の統計をクリアします
+     *
+     *  セクタごとの消去回数はクリアしません。
+     */
+    void resetStatistics();
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DSimulatedNorFlash);
+
+    int FindEraseType(bd_addr_t address, bd_addr_t end) const;
+    uint8_t FindRegion(bd_addr_t address, bd_addr_t* regionEnd) const;
+    void EraseUnit(bd_addr_t address, int type);
+    void AddTransferTime(bd_size_t bytes);
+    bd_size_t CountViolations(const uint8_t* src, bd_addr_t address, bd_size_t size) const;
+    bool ConsumeOperation();
+
+    const Profile& m_profile;
+    uint8_t* m_memory;
+    uint32_t* m_eraseCounts;
+    bd_size_t m_sectorSize;
+    size_t m_sectorCount;
+    bool m_strict;
+    bool m_powerCutEnabled;
+    uint64_t m_operationsBeforeCut;
+    uint64_t m_elapsedNs;
+    uint64_t m_programViolations;
+    uint64_t m_readCount;
+    uint64_t m_pageProgramCount;
+    uint64_t m_eraseOperationCount;
+};
+
+
+#endif /* end of include guard: dandy_DSimulatedNorFlash_hpp_ */
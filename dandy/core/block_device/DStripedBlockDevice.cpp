@@ -0,0 +1,397 @@
+/**
+ *       @file  DStripedBlockDevice.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/block_device/DStripedBlockDevice.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+
+
+DStripedBlockDevice::DStripedBlockDevice(BlockDevice* const* devices, int count, bd_size_t stripeSize,
+                                         uint32_t stackSize)
+    : m_devices(nullptr)
+    , m_count(count)
+    , m_stripeSize(stripeSize)
+    , m_stackSize(stackSize)
+    , m_size(0)
+    , m_readSize(0)
+    , m_programSize(0)
+    , m_eraseSize(0)
+    , m_initialized(false)
+    , m_jobType(JOB_READ)
+    , m_jobBuffer(nullptr)
+    , m_jobAddress(0)
+    , m_jobSize(0)
+    , m_results(nullptr)
+#ifdef MBED_CONF_RTOS_PRESENT
+    , m_workers(nullptr)
+    , m_done(0)
+#endif
+{
+    X_ASSERT(devices);
+    X_ASSERT(m_count > 0);
+    X_ASSERT(m_stripeSize > 0);
+
+    m_devices = D_NEW(BlockDevice*[m_count]);
+    m_results = D_NEW(int[m_count]);
+    for (int i = 0; i < m_count; i++)
+    {
+        X_ASSERT(devices[i]);
+        m_devices[i] = devices[i];
+    }
+}
+
+DStripedBlockDevice::~DStripedBlockDevice()
+{
+    this->deinit();
+    D_SAFE_DELETE_ARRAY(m_results);
+    D_SAFE_DELETE_ARRAY(m_devices);
+}
+
+int DStripedBlockDevice::init()
+{
+    if (m_initialized)
+        return BD_ERROR_OK;
+
+    for (int i = 0; i < m_count; i++)
+    {
+        const int result = m_devices[i]->init();
+        if (result != BD_ERROR_OK)
+        {
+            this->DeinitDevices(i);
+            return result;
+        }
+    }
+
+    /* 各デバイスの読み書きの単位は最大のものに合わせ、容量は最小のものに合わせ
+     * る
+     */
+    bd_size_t deviceSize = m_devices[0]->size();
+    bd_size_t deviceEraseSize = 0;
+    m_readSize = 1;
+    m_programSize = 1;
+    for (int i = 0; i < m_count; i++)
+    {
+        deviceSize = d_min<bd_size_t>(deviceSize, m_devices[i]->size());
+        deviceEraseSize = d_max<bd_size_t>(deviceEraseSize, m_devices[i]->get_erase_size());
+        m_readSize = d_max<bd_size_t>(m_readSize, m_devices[i]->get_read_size());
+        m_programSize = d_max<bd_size_t>(m_programSize, m_devices[i]->get_program_size());
+    }
+
+    if ((m_stripeSize % m_readSize) || (m_stripeSize % m_programSize))
+    {
+        this->DeinitDevices(m_count);
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    if ((m_stripeSize % deviceEraseSize) == 0)
+        m_eraseSize = m_stripeSize;
+    else if ((deviceEraseSize % m_stripeSize) == 0)
+        m_eraseSize = deviceEraseSize * m_count;
+    else
+    {
+        this->DeinitDevices(m_count);
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    const bd_size_t rowSize = d_max<bd_size_t>(m_stripeSize, deviceEraseSize);
+    m_size = (deviceSize / rowSize) * rowSize * m_count;
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    /* 1番目のデバイスは呼び出し元のスレッドで処理する */
+    if (m_count > 1)
+    {
+        m_workers = D_NEW(Worker[m_count - 1]);
+        for (int i = 0; i < m_count - 1; i++)
+            m_workers[i].thread = nullptr;
+
+        for (int i = 0; i < m_count - 1; i++)
+        {
+            Worker& worker = m_workers[i];
+            worker.owner = this;
+            worker.index = i + 1;
+            worker.thread = D_NEW(rtos::Thread(osPriorityNormal, m_stackSize));
+            if (worker.thread->start(callback(&worker, &Worker::run)) != osOK)
+            {
+                /* 起動できたスレッドだけを終了させる */
+                this->StopWorkers(i);
+                this->DeinitDevices(m_count);
+                return BD_ERROR_DEVICE_ERROR;
+            }
+        }
+    }
+#endif
+
+    m_initialized = true;
+
+    return BD_ERROR_OK;
+}
+
+int DStripedBlockDevice::deinit()
+{
+    if (!m_initialized)
+        return BD_ERROR_OK;
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    if (m_workers)
+        this->StopWorkers(m_count - 1);
+#endif
+
+    const int result = this->DeinitDevices(m_count);
+    m_initialized = false;
+
+    return result;
+}
+
+int DStripedBlockDevice::sync()
+{
+    int result = BD_ERROR_OK;
+    for (int i = 0; i < m_count; i++)
+    {
+        const int ret = m_devices[i]->sync();
+        if (result == BD_ERROR_OK)
+            result = ret;
+    }
+
+    return result;
+}
+
+int DStripedBlockDevice::read(void* dst, bd_addr_t address, bd_size_t size)
+{
+    if (!this->is_valid_read(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    return this->Execute(JOB_READ, dst, address, size);
+}
+
+int DStripedBlockDevice::program(const void* src, bd_addr_t address, bd_size_t size)
+{
+    if (!this->is_valid_program(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    return this->Execute(JOB_PROGRAM, const_cast<void*>(src), address, size);
+}
+
+int DStripedBlockDevice::erase(bd_addr_t address, bd_size_t size)
+{
+    if (!this->is_valid_erase(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    return this->Execute(JOB_ERASE, NULL, address, size);
+}
+
+int DStripedBlockDevice::trim(bd_addr_t address, bd_size_t size)
+{
+    if (!this->is_valid_erase(address, size))
+        return BD_ERROR_DEVICE_ERROR;
+
+    return this->Execute(JOB_TRIM, NULL, address, size);
+}
+
+bd_size_t DStripedBlockDevice::get_read_size() const
+{
+    return m_readSize;
+}
+
+bd_size_t DStripedBlockDevice::get_program_size() const
+{
+    return m_programSize;
+}
+
+bd_size_t DStripedBlockDevice::get_erase_size() const
+{
+    return m_eraseSize;
+}
+
+int DStripedBlockDevice::get_erase_value() const
+{
+    const int value = m_devices[0]->get_erase_value();
+    for (int i = 1; i < m_count; i++)
+    {
+        if (m_devices[i]->get_erase_value() != value)
+            return -1;
+    }
+
+    return value;
+}
+
+bd_size_t DStripedBlockDevice::size() const
+{
+    return m_size;
+}
+
+#ifdef MBED_CONF_RTOS_PRESENT
+void DStripedBlockDevice::Worker::run()
+{
+    for (;;)
+    {
+        start.wait();
+        if (owner->m_jobType == JOB_QUIT)
+        {
+            owner->m_done.release();
+            return;
+        }
+
+        owner->m_results[index] = owner->RunJob(index);
+        owner->m_done.release();
+    }
+}
+
+void DStripedBlockDevice::StopWorkers(int started)
+{
+    m_mutex.lock();
+    m_jobType = JOB_QUIT;
+    for (int i = 0; i < started; i++)
+        m_workers[i].start.release();
+    for (int i = 0; i < started; i++)
+        m_done.wait();
+    m_mutex.unlock();
+
+    /* 起動に失敗したスレッドや、まだ生成していないスレッドも破棄する */
+    for (int i = 0; i < m_count - 1; i++)
+    {
+        if (i < started)
+            m_workers[i].thread->join();
+        D_DELETE(m_workers[i].thread);
+    }
+    D_SAFE_DELETE_ARRAY(m_workers);
+}
+#endif
+
+int DStripedBlockDevice::DeinitDevices(int count)
+{
+    int result = BD_ERROR_OK;
+    for (int i = 0; i < count; i++)
+    {
+        const int ret = m_devices[i]->deinit();
+        if (result == BD_ERROR_OK)
+            result = ret;
+    }
+
+    return result;
+}
+
+int DStripedBlockDevice::Execute(JobType type, void* buffer, bd_addr_t address, bd_size_t size)
+{
+    if (!size && (type != JOB_QUIT))
+        return BD_ERROR_OK;
+
+    m_mutex.lock();
+    m_jobType = type;
+    m_jobBuffer = static_cast<uint8_t*>(buffer);
+    m_jobAddress = address;
+    m_jobSize = size;
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    for (int i = 0; i < m_count - 1; i++)
+        m_workers[i].start.release();
+
+    if (type != JOB_QUIT)
+        m_results[0] = this->RunJob(0);
+
+    for (int i = 0; i < m_count - 1; i++)
+        m_done.wait();
+#else
+    for (int i = 0; i < m_count; i++)
+        m_results[i] = this->RunJob(i);
+#endif
+
+    int result = BD_ERROR_OK;
+    if (type != JOB_QUIT)
+    {
+        for (int i = 0; (i < m_count) && (result == BD_ERROR_OK); i++)
+            result = m_results[i];
+    }
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DStripedBlockDevice::RunJob(int index)
+{
+    BlockDevice* const device = m_devices[index];
+    const bd_addr_t end = m_jobAddress + m_jobSize;
+
+    /* 同じデバイスに割り当てられたストライプは、デバイス上では連続している。消
+     * 去はその範囲をまとめて1回で行う。
+     */
+    bd_addr_t eraseBegin = 0;
+    bd_addr_t eraseEnd = 0;
+
+    bd_addr_t address = m_jobAddress;
+    while (address < end)
+    {
+        const bd_size_t stripe = address / m_stripeSize;
+        const bd_size_t offset = address % m_stripeSize;
+        const bd_size_t n = d_min<bd_size_t>(m_stripeSize - offset, end - address);
+
+        if (static_cast<int>(stripe % m_count) == index)
+        {
+            const bd_addr_t deviceAddress = (stripe / m_count) * m_stripeSize + offset;
+            uint8_t* const p = m_jobBuffer + (address - m_jobAddress);
+            int result = BD_ERROR_OK;
+
+            switch (m_jobType)
+            {
+            case JOB_READ:
+                result = device->read(p, deviceAddress, n);
+                break;
+            case JOB_PROGRAM:
+                result = device->program(p, deviceAddress, n);
+                break;
+            default:
+                if (eraseBegin == eraseEnd)
+                    eraseBegin = deviceAddress;
+                eraseEnd = deviceAddress + n;
+                break;
+            }
+
+            if (result != BD_ERROR_OK)
+                return result;
+        }
+
+        address += n;
+    }
+
+    if (eraseBegin == eraseEnd)
+        return BD_ERROR_OK;
+
+    if (m_jobType == JOB_ERASE)
+        return device->erase(eraseBegin, eraseEnd - eraseBegin);
+
+    return device->trim(eraseBegin, eraseEnd - eraseBegin);
+}
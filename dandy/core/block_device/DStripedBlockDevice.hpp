@@ -0,0 +1,160 @@
+/**
+ *       @file  DStripedBlockDevice.hpp
+ *      @brief  消去を先行して行うBlockDeviceラッパーです
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DStripedBlockDevice_hpp_
+#define dandy_DStripedBlockDevice_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include "platform/PlatformMutex.h"
+#ifdef MBED_CONF_RTOS_PRESENT
+#include "rtos/Semaphore.h"
+#include "rtos/Thread.h"
+#endif
+
+
+/** 複数のBlockDeviceにストライプ単位でデータを分散するBlockDeviceです(RAID-0)
+ *
+ *  仮想アドレスをstripeSizeごとに区切り、順番に各デバイスに割り当てます。デバ
+ *  イスごとに別のSPIバスに接続されていれば、大きな読み書きを複数のデバイスで同
+ *  時に行えるので、連続アクセスの速度がデバイスの数に比例して向上します。
+ *
+ *  RTOSがある場合は、2番目以降のデバイスごとにワーカースレッドを作成し、1番目の
+ *  デバイスは呼び出し元のスレッドで処理します。RTOSがない場合は順番に処理しま
+ *  す。
+ *
+ *  stripeSizeはデバイスの消去サイズの倍数か約数でなければなりません。前者の場合
+ *  の消去サイズはstripeSize、後者の場合はデバイスの消去サイズ×デバイス数になり
+ *  ます。
+ *
+ *  @code
+ *  DSST26 flash0(SPI1_MOSI, SPI1_MISO, SPI1_SCK, SPI1_CS, 40000000);
+ *  DSST26 flash1(SPI2_MOSI, SPI2_MISO, SPI2_SCK, SPI2_CS, 40000000);
+ *  BlockDevice* devices[] = { &flash0, &flash1 };
+ *  DStripedBlockDevice bd(devices, 2, 4096);
+ *  bd.init();
+ *  @endcode
+ */
+class DStripedBlockDevice : public BlockDevice
+{
+public:
+
+    /** ワーカースレッドのスタックサイズのデフォルト値です
+     */
+    static const uint32_t DEFAULT_STACK_SIZE = 1024;
+
+
+    /** コンストラクタ
+     *
+     *  devicesの内容はコピーするので、配列自体は破棄してもかまいません。
+     */
+    DStripedBlockDevice(BlockDevice* const* devices, int count, bd_size_t stripeSize,
+                        uint32_t stackSize = DEFAULT_STACK_SIZE);
+    virtual ~DStripedBlockDevice() override;
+
+    virtual int init() override;
+    virtual int deinit() override;
+    virtual int sync() override;
+    virtual int read(void* dst, bd_addr_t address, bd_size_t size) override;
+    virtual int program(const void* src, bd_addr_t address, bd_size_t size) override;
+    virtual int erase(bd_addr_t address, bd_size_t size) override;
+    virtual int trim(bd_addr_t address, bd_size_t size) override;
+    virtual bd_size_t get_read_size() const override;
+    virtual bd_size_t get_program_size() const override;
+    virtual bd_size_t get_erase_size() const override;
+    virtual int get_erase_value() const override;
+    virtual bd_size_t size() const override;
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DStripedBlockDevice);
+
+    enum JobType
+    {
+        JOB_READ,
+        JOB_PROGRAM,
+        JOB_ERASE,
+        JOB_TRIM,
+        JOB_QUIT,
+    };
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    struct Worker
+    {
+        DStripedBlockDevice* owner;
+        int index;
+        rtos::Thread* thread;
+        rtos::Semaphore start;
+
+        void run();
+    };
+#endif
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    void StopWorkers(int started);
+#endif
+    int DeinitDevices(int count);
+    int Execute(JobType type, void* buffer, bd_addr_t address, bd_size_t size);
+    int RunJob(int index);
+
+    BlockDevice** m_devices;
+    int m_count;
+    bd_size_t m_stripeSize;
+    uint32_t m_stackSize;
+    bd_size_t m_size;
+    bd_size_t m_readSize;
+    bd_size_t m_programSize;
+    bd_size_t m_eraseSize;
+    bool m_initialized;
+
+    /* 実行中の要求。各デバイスは自分に割り当てられたストライプだけを処理する */
+    PlatformMutex m_mutex;
+    JobType m_jobType;
+    uint8_t* m_jobBuffer;
+    bd_addr_t m_jobAddress;
+    bd_size_t m_jobSize;
+    int* m_results;
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    Worker* m_workers;
+    rtos::Semaphore m_done;
+#endif
+};
+
+
+#endif /* end of include guard: dandy_DStripedBlockDevice_hpp_ */
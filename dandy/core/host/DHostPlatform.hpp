@@ -0,0 +1,412 @@
+/**
+ *       @file  DHostPlatform.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DHostPlatform_hpp_
+#define dandy_DHostPlatform_hpp_
+
+
+#include <stdint.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <cstdarg>
+#include <cstring>
+
+
+/** ホスト(Linux, macOS)でビルドする際にmbedの代わりに使用する定義です
+ *
+ *  ホスト上で試験するクラス(DSimulatedNorFlash, DFlashKV, SPIフラッシュのドラ
+ *  イバなど)が必要とする、mbedのBlockDeviceとbd_*の型、MbedCRC、FileHandle、
+ *  SPI、DigitalOut、PlatformMutex、us_tickerだけを、mbed-os 5と同じインター
+ *  フェースで定義します。
+ *
+ *  ホストの試験はシングルスレッドで実行するので、PlatformMutexとクリティカルセ
+ *  クションは何もしません。スレッド、Callback、非同期SPIなどは用意しないので、
+ *  それらを使うクラスはホストではビルドできません。
+ *
+ *  SPIはDHostSPIDeviceでCSのピンに接続したデバイスとバイト単位で送受信します。
+ */
+
+
+enum bd_error
+{
+    BD_ERROR_OK                 = 0,
+    BD_ERROR_DEVICE_ERROR       = -4001,
+};
+
+typedef uint64_t bd_addr_t;
+typedef uint64_t bd_size_t;
+
+
+class BlockDevice
+{
+public:
+    virtual ~BlockDevice() {}
+    virtual int init() = 0;
+    virtual int deinit() = 0;
+    virtual int sync() { return 0; }
+    virtual int read(void* buffer, bd_addr_t addr, bd_size_t size) = 0;
+    virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size) = 0;
+    virtual int erase(bd_addr_t /*addr*/, bd_size_t /*size*/) { return 0; }
+    virtual int trim(bd_addr_t /*addr*/, bd_size_t /*size*/) { return 0; }
+    virtual bd_size_t get_read_size() const = 0;
+    virtual bd_size_t get_program_size() const = 0;
+    virtual bd_size_t get_erase_size() const { return get_program_size(); }
+    virtual int get_erase_value() const { return -1; }
+    virtual bd_size_t size() const = 0;
+
+    bool is_valid_read(bd_addr_t addr, bd_size_t size) const
+    {
+        return (addr % get_read_size() == 0) &&
+               (size % get_read_size() == 0) &&
+               (addr + size <= this->size());
+    }
+
+    bool is_valid_program(bd_addr_t addr, bd_size_t size) const
+    {
+        return (addr % get_program_size() == 0) &&
+               (size % get_program_size() == 0) &&
+               (addr + size <= this->size());
+    }
+
+    bool is_valid_erase(bd_addr_t addr, bd_size_t size) const
+    {
+        return (addr % get_erase_size() == 0) &&
+               (size % get_erase_size() == 0) &&
+               (addr + size <= this->size());
+    }
+};
+
+
+enum crc_polynomial
+{
+    POLY_32BIT_ANSI = 0x04C11DB7,
+};
+
+typedef unsigned long long crc_data_size_t;
+
+
+/** mbedのMbedCRCと同じ結果を返すCRCです
+ *
+ *  POLY_32BIT_ANSI(32ビット、入出力反転、初期値と最終XORが0xFFFFFFFF)にのみ
+ *  対応します。
+ */
+template <uint32_t polynomial = POLY_32BIT_ANSI, uint8_t width = 32>
+class MbedCRC
+{
+public:
+    int32_t compute(void* buffer, crc_data_size_t size, uint32_t* crc)
+    {
+        compute_partial_start(crc);
+        compute_partial(buffer, size, crc);
+        return compute_partial_stop(crc);
+    }
+
+    int32_t compute_partial(void* buffer, crc_data_size_t size, uint32_t* crc)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(buffer);
+        uint32_t c = *crc;
+        for (crc_data_size_t i = 0; i < size; i++)
+        {
+            c ^= p[i];
+            for (int bit = 0; bit < 8; bit++)
+                c = (c >> 1) ^ ((c & 1) ? 0xEDB88320UL : 0);
+        }
+        *crc = c;
+        return 0;
+    }
+
+    int32_t compute_partial_start(uint32_t* crc)
+    {
+        *crc = 0xFFFFFFFFUL;
+        return 0;
+    }
+
+    int32_t compute_partial_stop(uint32_t* crc)
+    {
+        *crc ^= 0xFFFFFFFFUL;
+        return 0;
+    }
+};
+
+
+inline void core_util_critical_section_enter() {}
+inline void core_util_critical_section_exit() {}
+
+
+class PlatformMutex
+{
+public:
+    void lock() {}
+    void unlock() {}
+};
+
+
+typedef struct
+{
+    int unused;
+} ticker_data_t;
+
+
+inline uint32_t us_ticker_read()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<uint32_t>(tv.tv_sec * 1000000ULL + tv.tv_usec);
+}
+
+
+inline const ticker_data_t* get_us_ticker_data()
+{
+    static const ticker_data_t ticker = { 0 };
+    return &ticker;
+}
+
+
+inline uint32_t ticker_read(const ticker_data_t* /*ticker*/)
+{
+    return us_ticker_read();
+}
+
+
+namespace mbed {
+
+
+class FileHandle
+{
+public:
+    virtual ~FileHandle() {}
+    virtual ssize_t read(void* buffer, size_t size) = 0;
+    virtual ssize_t write(const void* buffer, size_t size) = 0;
+    virtual off_t seek(off_t offset, int whence = SEEK_SET) = 0;
+    virtual int close() = 0;
+    virtual int sync() { return 0; }
+    virtual int isatty() { return 0; }
+    virtual off_t tell() { return seek(0, SEEK_CUR); }
+    virtual void rewind() { seek(0, SEEK_SET); }
+    virtual off_t size() { return -EINVAL; }
+};
+
+
+} // namespace mbed
+
+
+using mbed::FileHandle;
+
+
+typedef int PinName;
+
+enum
+{
+    NC = -1,
+};
+
+
+/** ホストのSPIバスに接続するデバイスです
+ *
+ *  attach()でCSのピンに接続すると、そのピンのDigitalOutをLowにしている間に
+ *  SPIで送受信したバイトが1バイトずつexchange()に渡されます。デバイスを接続し
+ *  ていないピンを選択した場合は、受信データは0xFFになります。
+ */
+class DHostSPIDevice
+{
+public:
+    virtual ~DHostSPIDevice() {}
+
+
+    /** CSがLowになった時に呼び出されます
+     */
+    virtual void select() = 0;
+
+
+    /** CSがHighになった時に呼び出されます
+     */
+    virtual void deselect() = 0;
+
+
+    /** 1バイトを送受信します
+     */
+    virtual uint8_t exchange(uint8_t tx) = 0;
+
+
+    /** csのピンにdeviceを接続します。NULLを指定すると切断します
+     */
+    static void attach(PinName cs, DHostSPIDevice* device)
+    {
+        Connection* const connections = Connections();
+        for (int i = 0; i < MAX_CONNECTIONS; i++)
+        {
+            if (connections[i].device && (connections[i].cs != cs))
+                continue;
+
+            connections[i].cs = cs;
+            connections[i].device = device;
+            return;
+        }
+    }
+
+
+    /// @cond IGNORE
+    static void setChipSelect(PinName cs, bool active)
+    {
+        DHostSPIDevice* device = NULL;
+        Connection* const connections = Connections();
+        for (int i = 0; i < MAX_CONNECTIONS; i++)
+        {
+            if (connections[i].device && (connections[i].cs == cs))
+                device = connections[i].device;
+        }
+
+        if (!device)
+            return;
+
+        if (active)
+        {
+            *Selected() = device;
+            device->select();
+        }
+        else
+        {
+            device->deselect();
+            if (*Selected() == device)
+                *Selected() = NULL;
+        }
+    }
+
+    static uint8_t transfer(uint8_t tx)
+    {
+        DHostSPIDevice* const device = *Selected();
+        return device ? device->exchange(tx) : 0xFF;
+    }
+    /// @endcond IGNORE
+
+private:
+    static const int MAX_CONNECTIONS = 4;
+
+    struct Connection
+    {
+        PinName cs;
+        DHostSPIDevice* device;
+    };
+
+    static Connection* Connections()
+    {
+        static Connection connections[MAX_CONNECTIONS];
+        return connections;
+    }
+
+    static DHostSPIDevice** Selected()
+    {
+        static DHostSPIDevice* selected;
+        return &selected;
+    }
+};
+
+
+class DigitalOut
+{
+public:
+    explicit DigitalOut(PinName pin, int value = 0)
+        : m_pin(pin)
+        , m_value(1)
+    {
+        this->write(value);
+    }
+
+    void write(int value)
+    {
+        value = value ? 1 : 0;
+        if (value != m_value)
+            DHostSPIDevice::setChipSelect(m_pin, value == 0);
+        m_value = value;
+    }
+
+    int read() { return m_value; }
+
+    DigitalOut& operator=(int value)
+    {
+        this->write(value);
+        return *this;
+    }
+
+private:
+    PinName m_pin;
+    int m_value;
+};
+
+
+class SPI
+{
+public:
+    SPI(PinName /*mosi*/, PinName /*miso*/, PinName /*sclk*/, PinName /*ssel*/ = NC)
+        : m_frequency(1000000)
+    {
+    }
+
+    void frequency(int hz = 1000000) { m_frequency = hz; }
+
+    int write(int value)
+    {
+        return DHostSPIDevice::transfer(static_cast<uint8_t>(value));
+    }
+
+    /** mbedと同じく、長い方の長さだけ送受信し、送信データが足りない分は0xFFを送
+     *  ります
+     */
+    int write(const char* txBuffer, int txLength, char* rxBuffer, int rxLength)
+    {
+        const int total = (txLength > rxLength) ? txLength : rxLength;
+        for (int i = 0; i < total; i++)
+        {
+            const uint8_t tx = (i < txLength) ? static_cast<uint8_t>(txBuffer[i]) : 0xFF;
+            const uint8_t rx = DHostSPIDevice::transfer(tx);
+            if (i < rxLength)
+                rxBuffer[i] = static_cast<char>(rx);
+        }
+
+        return total;
+    }
+
+private:
+    int m_frequency;
+};
+
+
+#endif /* end of include guard: dandy_DHostPlatform_hpp_ */
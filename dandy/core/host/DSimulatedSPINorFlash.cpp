@@ -0,0 +1,500 @@
+/**
+ *       @file  DSimulatedSPINorFlash.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/host/DSimulatedSPINorFlash.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+
+
+/* アドレスを伴わないコマンドです */
+#define D__CMD_WRSR             (0x01) /* Write Status Register */
+#define D__CMD_WRDI             (0x04) /* Write Disable */
+#define D__CMD_RDSR             (0x05) /* Read Status Register */
+#define D__CMD_WREN             (0x06) /* Write Enable */
+#define D__CMD_WRRE             (0x30) /* Write Resume (SST26) */
+#define D__CMD_RDCR             (0x35) /* Read Configuration Register (SST26) */
+#define D__CMD_RDFR             (0x48) /* Read Function Register (IS25) */
+#define D__CMD_SFDP             (0x5A) /* Read SFDP */
+#define D__CMD_CE_60            (0x60) /* Chip Erase */
+#define D__CMD_PERSUS           (0x75) /* Program/Erase Suspend (IS25) */
+#define D__CMD_PERRSM           (0x7A) /* Program/Erase Resume (IS25) */
+#define D__CMD_ULBPR            (0x98) /* Global Block Protection Unlock (SST26) */
+#define D__CMD_JEDEC_ID         (0x9F) /* Read JEDEC ID */
+#define D__CMD_WRSU             (0xB0) /* Write Suspend (SST26) */
+#define D__CMD_CE               (0xC7) /* Chip Erase */
+
+#define D__SR_BIT_WEL           (1U << 1)
+
+#define D__SFDP_BASIC_ADDRESS   (0x30)
+#define D__SFDP_BASIC_DWORDS    (16)
+#define D__SFDP_MAP_ADDRESS     (D__SFDP_BASIC_ADDRESS + D__SFDP_BASIC_DWORDS * 4)
+
+
+static const DSimulatedSPINorFlash::Command D__sst26Commands[] = {
+    { 0x03, DSimulatedSPINorFlash::COMMAND_READ,         3, 0, 0 },     /* Read */
+    { 0x0B, DSimulatedSPINorFlash::COMMAND_READ,         3, 1, 0 },     /* High-Speed Read */
+    { 0x02, DSimulatedSPINorFlash::COMMAND_PAGE_PROGRAM, 3, 0, 0 },     /* Page Program */
+    { 0x20, DSimulatedSPINorFlash::COMMAND_ERASE,        3, 0, 0x01 },  /* 4KB */
+    { 0xD8, DSimulatedSPINorFlash::COMMAND_ERASE,        3, 0, 0x0E },  /* 8KB, 32KB, 64KB */
+};
+
+
+static const DSimulatedSPINorFlash::Device D__sst26vf064b = {
+    &DSimulatedNorFlash::sst26vf064b(),
+    { 0xBF, 0x26, 0x43 },
+    true,
+    D__sst26Commands,
+    D_COUNT_OF(D__sst26Commands),
+};
+
+
+static const DSimulatedSPINorFlash::Command D__is25Commands[] = {
+    { 0x03, DSimulatedSPINorFlash::COMMAND_READ,         3, 0, 0 },     /* NORD */
+    { 0x0B, DSimulatedSPINorFlash::COMMAND_READ,         3, 1, 0 },     /* FRD */
+    { 0x13, DSimulatedSPINorFlash::COMMAND_READ,         4, 0, 0 },     /* 4NORD */
+    { 0x0C, DSimulatedSPINorFlash::COMMAND_READ,         4, 1, 0 },     /* 4FRD */
+    { 0x02, DSimulatedSPINorFlash::COMMAND_PAGE_PROGRAM, 3, 0, 0 },     /* PP */
+    { 0x12, DSimulatedSPINorFlash::COMMAND_PAGE_PROGRAM, 4, 0, 0 },     /* 4PP */
+    { 0x20, DSimulatedSPINorFlash::COMMAND_ERASE,        3, 0, 0x01 },  /* SER */
+    { 0xD7, DSimulatedSPINorFlash::COMMAND_ERASE,        3, 0, 0x01 },  /* SER */
+    { 0x52, DSimulatedSPINorFlash::COMMAND_ERASE,        3, 0, 0x02 },  /* BER32 */
+    { 0xD8, DSimulatedSPINorFlash::COMMAND_ERASE,        3, 0, 0x04 },  /* BER64 */
+    { 0x21, DSimulatedSPINorFlash::COMMAND_ERASE,        4, 0, 0x01 },  /* 4SER */
+    { 0x5C, DSimulatedSPINorFlash::COMMAND_ERASE,        4, 0, 0x02 },  /* 4BER32 */
+    { 0xDC, DSimulatedSPINorFlash::COMMAND_ERASE,        4, 0, 0x04 },  /* 4BER64 */
+};
+
+
+static const DSimulatedSPINorFlash::Device D__is25lp064a = {
+    &DSimulatedNorFlash::is25lp064a(),
+    { 0x9D, 0x60, 0x17 },
+    false,
+    D__is25Commands,
+    D_COUNT_OF(D__is25Commands),
+};
+
+
+static void D__StoreLE32(uint8_t* p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+
+static uint32_t D__EncodeTime(uint32_t us, const uint32_t* units, int unitCount)
+{
+    /* SFDPの時間は(count + 1) * unitで、countは5ビット */
+    for (int i = 0; i < unitCount; i++)
+    {
+        const uint32_t count = (us + units[i] - 1) / units[i];
+        if (count <= 32)
+            return (static_cast<uint32_t>(i) << 5) | (count ? count - 1 : 0);
+    }
+
+    return (static_cast<uint32_t>(unitCount - 1) << 5) | 0x1F;
+}
+
+
+static int D__Log2(bd_size_t size)
+{
+    int exponent = 0;
+    while ((static_cast<bd_size_t>(1) << exponent) < size)
+        exponent++;
+
+    return exponent;
+}
+
+
+const DSimulatedSPINorFlash::Device& DSimulatedSPINorFlash::sst26vf064b()
+{
+    return D__sst26vf064b;
+}
+
+
+const DSimulatedSPINorFlash::Device& DSimulatedSPINorFlash::is25lp064a()
+{
+    return D__is25lp064a;
+}
+
+
+DSimulatedSPINorFlash::DSimulatedSPINorFlash(const Device& device)
+    : m_device(device)
+    , m_flash(*device.profile)
+    , m_sectorMapEnabled(true)
+    , m_state(STATE_IDLE)
+    , m_opcode(0)
+    , m_command(nullptr)
+    , m_addressBytes(0)
+    , m_dummyBytes(0)
+    , m_address(0)
+    , m_dataCount(0)
+    , m_pageBuffer(nullptr)
+    , m_writeEnabled(false)
+    , m_protected(device.protectedAtPowerOn)
+    , m_protocolErrors(0)
+{
+    const int result = m_flash.init();
+    X_ASSERT(result == BD_ERROR_OK);
+    X_UNUSED(result);
+
+    m_pageBuffer = D_NEW(uint8_t[device.profile->pageSize]);
+    ::memset(m_commandCounts, 0, sizeof(m_commandCounts));
+    this->BuildSFDP();
+}
+
+
+DSimulatedSPINorFlash::~DSimulatedSPINorFlash()
+{
+    D_SAFE_DELETE_ARRAY(m_pageBuffer);
+}
+
+
+void DSimulatedSPINorFlash::select()
+{
+    m_state = STATE_OPCODE;
+}
+
+
+void DSimulatedSPINorFlash::deselect()
+{
+    if (m_state != STATE_IDLE)
+        this->FinishCommand();
+
+    m_state = STATE_IDLE;
+}
+
+
+uint8_t DSimulatedSPINorFlash::exchange(uint8_t tx)
+{
+    const DSimulatedNorFlash::Profile& profile = *m_device.profile;
+
+    switch (m_state)
+    {
+        case STATE_IDLE:
+            return 0xFF;
+
+        case STATE_OPCODE:
+            this->StartCommand(tx);
+            return 0xFF;
+
+        case STATE_ADDRESS:
+            m_address = (m_address << 8) | tx;
+            if (--m_addressBytes == 0)
+                m_state = m_dummyBytes ? STATE_DUMMY : STATE_DATA;
+            return 0xFF;
+
+        case STATE_DUMMY:
+            if (--m_dummyBytes == 0)
+                m_state = STATE_DATA;
+            return 0xFF;
+
+        case STATE_DATA:
+            break;
+    }
+
+    uint8_t rx = 0xFF;
+    if (m_command && (m_command->type == COMMAND_READ))
+    {
+        /* 読み出しはCSをLowにしている間アドレスが進み、末尾の次は先頭に戻る */
+        m_flash.read(&rx, m_address % profile.size, 1);
+        m_address++;
+    }
+    else if (m_command && (m_command->type == COMMAND_PAGE_PROGRAM))
+    {
+        if (m_dataCount < profile.pageSize)
+            m_pageBuffer[m_dataCount] = tx;
+    }
+    else if (m_opcode == D__CMD_SFDP)
+    {
+        rx = (m_address < SFDP_SIZE) ? m_sfdp[m_address] : 0xFF;
+        m_address++;
+    }
+    else if (m_opcode == D__CMD_RDSR)
+    {
+        rx = m_writeEnabled ? D__SR_BIT_WEL : 0;
+    }
+    else if (m_opcode == D__CMD_JEDEC_ID)
+    {
+        rx = m_device.jedecId[m_dataCount % 3];
+    }
+    else if ((m_opcode == D__CMD_RDCR) || (m_opcode == D__CMD_RDFR))
+    {
+        rx = 0;
+    }
+
+    m_dataCount++;
+
+    return rx;
+}
+
+
+void DSimulatedSPINorFlash::setSectorMapEnabled(bool enabled)
+{
+    m_sectorMapEnabled = enabled;
+    this->BuildSFDP();
+}
+
+
+void DSimulatedSPINorFlash::BuildSFDP()
+{
+    /* see [JESD216B 6.2 SFDP Header, 6.4 Basic Flash Parameter Table,
+     *      6.5 Sector Map Parameter Table]
+     */
+    const DSimulatedNorFlash::Profile& profile = *m_device.profile;
+    ::memset(m_sfdp, 0xFF, sizeof(m_sfdp));
+
+    /* 消去コマンドの種類は、プロファイルと同じ順に3バイトアドレスのコマンドを
+     * 並べる
+     */
+    uint8_t eraseOpcodes[DSimulatedNorFlash::MAX_ERASE_TYPES] = { 0 };
+    uint8_t sectorEraseOpcode = 0;
+    for (int i = 0; i < DSimulatedNorFlash::MAX_ERASE_TYPES; i++)
+    {
+        for (int c = m_device.commandCount - 1; c >= 0; c--)
+        {
+            const Command& command = m_device.commands[c];
+            if ((command.type == COMMAND_ERASE) && (command.addressBytes == 3) &&
+                (command.eraseTypeMask & (1U << i)))
+                eraseOpcodes[i] = command.opcode;
+        }
+
+        if (profile.eraseTypes[i].size == 4096)
+            sectorEraseOpcode = eraseOpcodes[i];
+    }
+
+    uint32_t dw[D__SFDP_BASIC_DWORDS];
+    ::memset(dw, 0, sizeof(dw));
+
+    /* 1st: 4KB消去, 書き込みバッファ64バイト以上, 3バイトアドレスのみ */
+    dw[0] = 0xFF800000UL | (static_cast<uint32_t>(sectorEraseOpcode) << 8) | 0x04 |
+            (sectorEraseOpcode ? 0x01 : 0x03);
+
+    /* 2nd: 容量(bit単位 - 1) */
+    dw[1] = static_cast<uint32_t>(profile.size * 8 - 1);
+
+    /* 8th, 9th: 消去コマンドの種類, 10th: 消去の標準時間 */
+    static const uint32_t eraseUnits[] = { 1000, 16000, 128000, 1000000 };
+    dw[9] = 0x01;
+    for (int i = 0; i < DSimulatedNorFlash::MAX_ERASE_TYPES; i++)
+    {
+        const DSimulatedNorFlash::EraseType& e = profile.eraseTypes[i];
+        if (!e.size || !eraseOpcodes[i])
+            continue;
+
+        const uint32_t field = (static_cast<uint32_t>(eraseOpcodes[i]) << 8) | D__Log2(e.size);
+        dw[7 + i / 2] |= field << ((i % 2) * 16);
+        dw[9] |= D__EncodeTime(e.typicalUs, eraseUnits, D_COUNT_OF(eraseUnits)) << (4 + 7 * i);
+    }
+
+    /* 11th: ページサイズと書き込みの標準時間 */
+    static const uint32_t programUnits[] = { 8, 64 };
+    dw[10] = 0x01 | (D__Log2(profile.pageSize) << 4) |
+             (D__EncodeTime(profile.programPageUs, programUnits, D_COUNT_OF(programUnits)) << 8);
+
+    for (int i = 0; i < D__SFDP_BASIC_DWORDS; i++)
+        D__StoreLE32(&m_sfdp[D__SFDP_BASIC_ADDRESS + i * 4], dw[i]);
+
+    /* Sector Map: 構成が1つだけのマップディスクリプタ */
+    bd_size_t fixedSize = 0;
+    for (int i = 0; i < profile.regionCount; i++)
+        fixedSize += profile.regions[i].size;
+
+    D__StoreLE32(&m_sfdp[D__SFDP_MAP_ADDRESS], 0x03 | (static_cast<uint32_t>(profile.regionCount - 1) << 16));
+    for (int i = 0; i < profile.regionCount; i++)
+    {
+        const bd_size_t size = profile.regions[i].size ? profile.regions[i].size : profile.size - fixedSize;
+        D__StoreLE32(&m_sfdp[D__SFDP_MAP_ADDRESS + (i + 1) * 4],
+                     (static_cast<uint32_t>(size / 256 - 1) << 8) | profile.regions[i].typeMask);
+    }
+    X_ASSERT(static_cast<size_t>(D__SFDP_MAP_ADDRESS + (profile.regionCount + 1) * 4) <= SFDP_SIZE);
+
+    /* ヘッダとパラメータヘッダ */
+    const uint8_t header[] = {
+        'S', 'F', 'D', 'P', 0x06, 0x01, static_cast<uint8_t>(m_sectorMapEnabled ? 1 : 0), 0xFF,
+        0x00, 0x06, 0x01, D__SFDP_BASIC_DWORDS, D__SFDP_BASIC_ADDRESS, 0x00, 0x00, 0xFF,
+        0x81, 0x00, 0x01, static_cast<uint8_t>(profile.regionCount + 1), D__SFDP_MAP_ADDRESS, 0x00, 0x00, 0xFF,
+    };
+    ::memcpy(m_sfdp, header, m_sectorMapEnabled ? 24 : 16);
+}
+
+
+void DSimulatedSPINorFlash::StartCommand(uint8_t opcode)
+{
+    m_opcode = opcode;
+    m_command = this->FindCommand(opcode);
+    m_address = 0;
+    m_dataCount = 0;
+    m_addressBytes = 0;
+    m_dummyBytes = 0;
+    m_commandCounts[opcode]++;
+
+    if (m_command)
+    {
+        m_addressBytes = m_command->addressBytes;
+        m_dummyBytes = m_command->dummyBytes;
+    }
+    else if (opcode == D__CMD_SFDP)
+    {
+        /* SFDPは常に3バイトアドレスと8クロックのダミーサイクル */
+        m_addressBytes = 3;
+        m_dummyBytes = 1;
+    }
+    else
+    {
+        switch (opcode)
+        {
+            case D__CMD_WRSR:
+            case D__CMD_WRDI:
+            case D__CMD_RDSR:
+            case D__CMD_WREN:
+            case D__CMD_WRRE:
+            case D__CMD_RDCR:
+            case D__CMD_RDFR:
+            case D__CMD_CE_60:
+            case D__CMD_PERSUS:
+            case D__CMD_PERRSM:
+            case D__CMD_JEDEC_ID:
+            case D__CMD_WRSU:
+            case D__CMD_CE:
+                break;
+            case D__CMD_ULBPR:
+                if (m_device.protectedAtPowerOn)
+                    break;
+                /* FALLTHROUGH */
+            default:
+                m_protocolErrors++;
+                break;
+        }
+    }
+
+    m_state = m_addressBytes ? STATE_ADDRESS : STATE_DATA;
+}
+
+
+void DSimulatedSPINorFlash::FinishCommand()
+{
+    if (m_state == STATE_OPCODE)
+        return;
+
+    /* アドレスやダミーの途中でCSがHighになったコマンドは実行しない */
+    if ((m_state == STATE_ADDRESS) || (m_state == STATE_DUMMY))
+    {
+        m_protocolErrors++;
+        return;
+    }
+
+    if (m_command && (m_command->type == COMMAND_PAGE_PROGRAM))
+    {
+        if (!this->WriteAllowed())
+            return;
+
+        /* ページサイズを越えて送るとページの先頭から上書きされるが、ドライバは
+         * ページ境界で分割するはずなので誤りとして扱う
+         */
+        if ((m_dataCount == 0) || (m_dataCount > m_device.profile->pageSize) ||
+            (m_flash.pageProgram(m_pageBuffer, m_address, m_dataCount) != 0))
+            m_protocolErrors++;
+    }
+    else if (m_command && (m_command->type == COMMAND_ERASE))
+    {
+        if (!this->WriteAllowed())
+            return;
+
+        if (m_dataCount || (m_flash.eraseCommand(m_address, m_command->eraseTypeMask) != 0))
+            m_protocolErrors++;
+    }
+    else
+    {
+        switch (m_opcode)
+        {
+            case D__CMD_WREN:
+                m_writeEnabled = true;
+                break;
+            case D__CMD_WRDI:
+                m_writeEnabled = false;
+                break;
+            case D__CMD_ULBPR:
+                if (!m_writeEnabled)
+                {
+                    m_protocolErrors++;
+                    break;
+                }
+                m_writeEnabled = false;
+                m_protected = false;
+                break;
+            case D__CMD_WRSR:
+            case D__CMD_CE:
+            case D__CMD_CE_60:
+                if (!this->WriteAllowed())
+                    break;
+                if (m_opcode != D__CMD_WRSR)
+                    m_flash.erase(0, m_device.profile->size);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+
+const DSimulatedSPINorFlash::Command* DSimulatedSPINorFlash::FindCommand(uint8_t opcode) const
+{
+    for (int i = 0; i < m_device.commandCount; i++)
+    {
+        if (m_device.commands[i].opcode == opcode)
+            return &m_device.commands[i];
+    }
+
+    return nullptr;
+}
+
+
+bool DSimulatedSPINorFlash::WriteAllowed()
+{
+    /* 実機はWELが0か保護されているとコマンドを無視する。実行してもしなくても
+     * WELは0に戻る
+     */
+    const bool allowed = m_writeEnabled && !m_protected;
+    m_writeEnabled = false;
+    if (!allowed)
+        m_protocolErrors++;
+
+    return allowed;
+}
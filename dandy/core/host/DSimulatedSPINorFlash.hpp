@@ -0,0 +1,193 @@
+/**
+ *       @file  DSimulatedSPINorFlash.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DSimulatedSPINorFlash_hpp_
+#define dandy_DSimulatedSPINorFlash_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include <dandy/core/block_device/DSimulatedNorFlash.hpp>
+
+
+/** SPIのコマンドを解釈してDSimulatedNorFlashを操作する、ホスト用のSPI NORフ
+ *  ラッシュです
+ *
+ *  DHostSPIDevice::attach()でCSのピンに接続すると、SPIフラッシュのドライバ
+ *  (DSPINorFlash, DSST26, DIS25)をホストでそのまま動かせます。CSをLowにしてか
+ *  らのオペコード、アドレス、ダミーバイト、データを実機と同じ順に解釈し、CSを
+ *  Highにした時点で書き込みと消去を実行します。
+ *
+ *  + 読み出しはアドレスとダミーバイトの数がコマンドと合わないとデータがずれる
+ *  + 書き込みと消去は、WRENでWELを立てていないと実行しない
+ *  + SST26はULBPRで保護を解除するまで書き込みと消去を実行しない
+ *  + SST26のブロック消去(0xD8)は、アドレスを含む領域によって8KB/32KB/64KBの
+ *    いずれかを消去する
+ *  + SFDPは、プロファイルの構成と消去コマンドから生成したものを返す
+ *
+ *  実行しなかったコマンドや、知らないオペコード、途中で終わったコマンドは
+ *  protocolErrors()に数えます。書き込みや消去は即座に完了するので、ステータス
+ *  レジスタのBUSYが1になることはありません。
+ *
+ *  @code
+ *  DSimulatedSPINorFlash device(DSimulatedSPINorFlash::sst26vf064b());
+ *  DHostSPIDevice::attach(CS_PIN, &device);
+ *  DSPINorFlash flash(MOSI_PIN, MISO_PIN, SCLK_PIN, CS_PIN, 40000000);
+ *  flash.init();
+ *  @endcode
+ */
+class DSimulatedSPINorFlash : public DHostSPIDevice
+{
+public:
+
+    /** アドレスを伴うコマンドの種類です
+     */
+    enum CommandType
+    {
+        COMMAND_READ,
+        COMMAND_PAGE_PROGRAM,
+        COMMAND_ERASE,
+    };
+
+
+    /** アドレスを伴うコマンドの定義です
+     *
+     *  eraseTypeMaskは消去コマンドが消去するProfile::eraseTypesのビットマスクで
+     *  す(DSimulatedNorFlash::eraseCommand()を参照)。
+     */
+    struct Command
+    {
+        uint8_t opcode;
+        uint8_t type;
+        uint8_t addressBytes;
+        uint8_t dummyBytes;
+        uint8_t eraseTypeMask;
+    };
+
+
+    /** デバイスの定義です
+     */
+    struct Device
+    {
+        const DSimulatedNorFlash::Profile* profile;
+        uint8_t jedecId[3];
+        bool protectedAtPowerOn;    /* ULBPRで保護を解除するまで書き込めない */
+        const Command* commands;
+        int commandCount;
+    };
+
+
+    /** SST26VF064Bの定義を返します
+     */
+    static const Device& sst26vf064b();
+
+
+    /** IS25LP064Aの定義を返します
+     */
+    static const Device& is25lp064a();
+
+
+    explicit DSimulatedSPINorFlash(const Device& device);
+    virtual ~DSimulatedSPINorFlash() override;
+    virtual void select() override;
+    virtual void deselect() override;
+    virtual uint8_t exchange(uint8_t tx) override;
+
+
+    /** SFDPにSector Map Parameter Tableを含めるかどうかを設定します
+     *
+     *  デフォルトは有効です。無効にすると、消去コマンドを使える領域が分からない
+     *  デバイスを模擬できます。
+     */
+    void setSectorMapEnabled(bool enabled);
+
+
+    /** メモリの内容と統計を持つDSimulatedNorFlashを返します
+     */
+    DSimulatedNorFlash& flash() { return m_flash; }
+
+
+    /** opcodeのコマンドを受け取った回数を返します
+     */
+    uint32_t commandCount(uint8_t opcode) const { return m_commandCounts[opcode]; }
+
+
+    /** 実行しなかったコマンドの数を返します
+     */
+    uint32_t protocolErrors() const { return m_protocolErrors; }
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DSimulatedSPINorFlash);
+
+    enum State
+    {
+        STATE_IDLE,
+        STATE_OPCODE,
+        STATE_ADDRESS,
+        STATE_DUMMY,
+        STATE_DATA,
+    };
+
+    static const size_t SFDP_SIZE = 256;
+
+    void BuildSFDP();
+    void StartCommand(uint8_t opcode);
+    void FinishCommand();
+    const Command* FindCommand(uint8_t opcode) const;
+    bool WriteAllowed();
+
+    const Device& m_device;
+    DSimulatedNorFlash m_flash;
+    uint8_t m_sfdp[SFDP_SIZE];
+    bool m_sectorMapEnabled;
+    State m_state;
+    uint8_t m_opcode;
+    const Command* m_command;
+    int m_addressBytes;
+    int m_dummyBytes;
+    bd_addr_t m_address;
+    bd_size_t m_dataCount;
+    uint8_t* m_pageBuffer;
+    bool m_writeEnabled;
+    bool m_protected;
+    uint32_t m_commandCounts[256];
+    uint32_t m_protocolErrors;
+};
+
+
+#endif /* end of include guard: dandy_DSimulatedSPINorFlash_hpp_ */
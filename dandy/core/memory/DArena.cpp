@@ -0,0 +1,210 @@
+/**
+ *       @file  DArena.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/memory/DArena.hpp>
+#include <new>
+
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    typedef osThreadId D__ThreadId;
+    #define D__CURRENT_THREAD() (Thread::gettid())
+    #define D__MAX_THREADS      (D_ARENA_MAX_THREADS)
+#else
+    typedef int D__ThreadId;
+    #define D__CURRENT_THREAD() (0)
+    #define D__MAX_THREADS      (1)
+#endif
+
+
+/* スレッドごとのスコープの連鎖の先頭です。scopeがNULLのスロットは空きです */
+struct D__ScopeSlot
+{
+    D__ThreadId thread;
+    DArenaScope* scope;
+};
+
+
+static D__ScopeSlot _scope_slots[D__MAX_THREADS];
+
+
+/* クリティカルセクション内で呼び出してください */
+static D__ScopeSlot* D__findSlot(D__ThreadId thread)
+{
+    for (int i = 0; i < D__MAX_THREADS; i++)
+    {
+        if (_scope_slots[i].scope && (_scope_slots[i].thread == thread))
+            return &_scope_slots[i];
+    }
+
+    return NULL;
+}
+
+
+static DArenaScope* D__currentScope()
+{
+    const D__ThreadId thread = D__CURRENT_THREAD();
+
+    core_util_critical_section_enter();
+    const D__ScopeSlot* const slot = D__findSlot(thread);
+    DArenaScope* const scope = slot ? slot->scope : NULL;
+    core_util_critical_section_exit();
+
+    return scope;
+}
+
+
+DArena::DArena(void* buffer, size_t size)
+    : m_buffer(static_cast<uint8_t*>(buffer))
+    , m_size(size)
+    , m_used(0)
+    , m_peak(0)
+{
+    X_ASSERT(buffer);
+}
+
+
+void* DArena::allocate(size_t size, size_t alignment)
+{
+    X_ASSERT(alignment > 0);
+
+    const uintptr_t top = reinterpret_cast<uintptr_t>(m_buffer) + m_used;
+    const size_t padding = (alignment - (top % alignment)) % alignment;
+    if ((padding > m_size - m_used) || (size > m_size - m_used - padding))
+        return NULL;
+
+    void* const ptr = m_buffer + m_used + padding;
+    m_used += padding + size;
+    if (m_used > m_peak)
+        m_peak = m_used;
+
+    return ptr;
+}
+
+
+void DArena::rewind(Marker marker)
+{
+    X_ASSERT(marker <= m_used);
+    m_used = marker;
+}
+
+
+bool DArena::contains(const void* ptr) const
+{
+    const uint8_t* const p = static_cast<const uint8_t*>(ptr);
+    return (p >= m_buffer) && (p < m_buffer + m_size);
+}
+
+
+DArena* DArena::current()
+{
+    DArenaScope* const scope = D__currentScope();
+    return scope ? scope->m_arena : NULL;
+}
+
+
+void* DArena::scopedAllocate(size_t size)
+{
+    DArena* const arena = current();
+    void* const ptr = arena ? arena->allocate(size) : NULL;
+    if (ptr)
+        return ptr;
+
+    return ::operator new(size);
+}
+
+
+void DArena::scopedDeallocate(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    for (DArenaScope* scope = D__currentScope(); scope; scope = scope->m_prev)
+    {
+        if (scope->m_arena->contains(ptr))
+            return;
+    }
+
+    ::operator delete(ptr);
+}
+
+
+DArenaScope::DArenaScope(DArena* arena)
+    : m_arena(arena)
+    , m_marker(0)
+    , m_prev(NULL)
+    , m_installed(false)
+{
+    if (!m_arena)
+        return;
+
+    const D__ThreadId thread = D__CURRENT_THREAD();
+
+    core_util_critical_section_enter();
+    D__ScopeSlot* slot = D__findSlot(thread);
+    for (int i = 0; !slot && (i < D__MAX_THREADS); i++)
+    {
+        if (!_scope_slots[i].scope)
+            slot = &_scope_slots[i];
+    }
+
+    if (slot)
+    {
+        m_prev = slot->scope;
+        m_marker = m_arena->mark();
+        slot->thread = thread;
+        slot->scope = this;
+        m_installed = true;
+    }
+    core_util_critical_section_exit();
+}
+
+
+DArenaScope::~DArenaScope()
+{
+    if (!m_installed)
+        return;
+
+    m_arena->rewind(m_marker);
+
+    core_util_critical_section_enter();
+    D__ScopeSlot* const slot = D__findSlot(D__CURRENT_THREAD());
+    X_ASSERT(slot && (slot->scope == this));
+    slot->scope = m_prev;
+    core_util_critical_section_exit();
+}
@@ -0,0 +1,190 @@
+/**
+ *       @file  DArena.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DArena_hpp_
+#define dandy_DArena_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+
+
+/** @def    D_ARENA_MAX_THREADS
+ *  @brief  同時にDArenaScopeを設定できるスレッド数です
+ *
+ *  RTOSを使用しない場合は常に1です。
+ */
+#ifndef D_ARENA_MAX_THREADS
+    #define D_ARENA_MAX_THREADS 4
+#endif
+
+
+/** ポインタを進めるだけで確保を行うアロケータです
+ *
+ *  個別の解放は行わず、mark()で取得した位置までrewind()するか、reset()で一度に
+ *  解放します。
+ *
+ *  DArenaScopeでスコープに設定すると、そのスコープの間のscopedAllocate()による
+ *  一時バッファの確保(DStream::getline()やDStringUtils::format()の作業バッファ
+ *  など)がアリーナから行われ、スコープを抜けるときにまとめて解放されます。
+ *
+ *  @code
+ *  static uint64_t arenaBuffer[1024 / 8];
+ *  DArena arena(arenaBuffer, sizeof(arenaBuffer));
+ *  {
+ *      DArenaScope scope(&arena);
+ *      const std::string s = DStringUtils::format("%d", 123);  // 作業バッファはarenaから
+ *  }   // arenaはスコープに入る前の状態に戻る
+ *  @endcode
+ */
+class DArena
+{
+public:
+    typedef size_t Marker;
+
+
+    /** buffer[0, size)から確保を行うアリーナを構築します
+     */
+    DArena(void* buffer, size_t size);
+
+
+    /** alignmentの倍数のアドレスからsizeバイトを確保します
+     *
+     *  空きが足りない場合はNULLを返します。
+     */
+    void* allocate(size_t size, size_t alignment = D_ALIGNMENT_OF(XMaxAlign));
+
+
+    /** 現在の確保位置を返します
+     */
+    Marker mark() const { return m_used; }
+
+
+    /** markerより後に確保したメモリをすべて解放します
+     */
+    void rewind(Marker marker);
+
+
+    /** すべてのメモリを解放します
+     */
+    void reset() { rewind(0); }
+
+
+    /** ptrがこのアリーナのメモリを指しているかどうかを返します
+     */
+    bool contains(const void* ptr) const;
+
+
+    size_t capacity() const { return m_size; }
+    size_t used() const { return m_used; }
+    size_t peak() const { return m_peak; }
+
+
+    /** 現在のスレッドで有効なスコープのアリーナを返します
+     *
+     *  スコープが設定されていなければNULLを返します。
+     */
+    static DArena* current();
+
+
+    /** 一時バッファを確保します
+     *
+     *  現在のスコープのアリーナから確保し、スコープが設定されていないか空きが足
+     *  りない場合は::operator newで確保します。確保したメモリはscopedDeallocate()
+     *  で解放してください。確保したスコープを抜けた後で使用してはいけません。
+     */
+    static void* scopedAllocate(size_t size);
+
+
+    /** scopedAllocate()で確保したメモリを解放します
+     *
+     *  アリーナから確保したメモリの場合は何もしません。
+     */
+    static void scopedDeallocate(void* ptr);
+
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DArena);
+
+    uint8_t* m_buffer;
+    size_t m_size;
+    size_t m_used;
+    size_t m_peak;
+};
+
+
+/** DArenaを現在のスレッドの確保スコープに設定します
+ *
+ *  構築時にアリーナの確保位置を記録し、破棄時にその位置までrewind()して、元の
+ *  スコープに戻します。スコープは入れ子にできます。
+ *
+ *  スコープはスレッドごとに管理されます。D_ARENA_MAX_THREADSを超えるスレッドで
+ *  構築したスコープは無効になり、そのスレッドのscopedAllocate()は::operator
+ *  newで確保します。arenaがNULLの場合も何もしません。1つのアリーナを複数のスレッ
+ *  ドのスコープに同時に設定してはいけません。
+ */
+class DArenaScope
+{
+public:
+    explicit DArenaScope(DArena* arena);
+    ~DArenaScope();
+
+private:
+    friend class DArena;
+
+    D_DISALLOW_COPY_AND_ASSIGN(DArenaScope);
+
+    DArena* m_arena;
+    DArena::Marker m_marker;
+    DArenaScope* m_prev;
+    bool m_installed;
+};
+
+
+/** DArena::scopedDeallocate()で解放するデリーターです
+ */
+struct DArenaScopedDeleter
+{
+    void operator()(void* ptr) const
+    {
+        DArena::scopedDeallocate(ptr);
+    }
+};
+
+
+#endif /* end of include guard: dandy_DArena_hpp_ */
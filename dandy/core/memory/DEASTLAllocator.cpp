@@ -0,0 +1,259 @@
+/**
+ *       @file  DEASTLAllocator.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/memory/DEASTLAllocator.hpp>
+#include <new>
+
+
+#if EASTL_NAME_ENABLED
+    #define D__INIT_NAME(name) , m_name(name)
+#else
+    #define D__INIT_NAME(name)
+#endif
+
+
+static uint32_t _fallback_count;
+
+
+DEASTLAllocator::DEASTLAllocator(const char* name)
+    : m_kind(KIND_HEAP)
+    , m_impl(NULL)
+    D__INIT_NAME(name)
+{
+    X_UNUSED(name);
+}
+
+
+DEASTLAllocator::DEASTLAllocator(XPicoAllocator* pico, const char* name)
+    : m_kind(KIND_PICO)
+    , m_impl(pico)
+    D__INIT_NAME(name)
+{
+    X_ASSERT(pico);
+    X_UNUSED(name);
+}
+
+
+DEASTLAllocator::DEASTLAllocator(XFixedAllocator* fixed, const char* name)
+    : m_kind(KIND_FIXED)
+    , m_impl(fixed)
+    D__INIT_NAME(name)
+{
+    X_ASSERT(fixed);
+    X_UNUSED(name);
+}
+
+
+DEASTLAllocator::DEASTLAllocator(XStackAllocator* stack, const char* name)
+    : m_kind(KIND_STACK)
+    , m_impl(stack)
+    D__INIT_NAME(name)
+{
+    X_ASSERT(stack);
+    X_UNUSED(name);
+}
+
+
+DEASTLAllocator::DEASTLAllocator(const DEASTLAllocator& x)
+    : m_kind(x.m_kind)
+    , m_impl(x.m_impl)
+    D__INIT_NAME(x.m_name)
+{
+}
+
+
+DEASTLAllocator::DEASTLAllocator(const DEASTLAllocator& x, const char* name)
+    : m_kind(x.m_kind)
+    , m_impl(x.m_impl)
+    D__INIT_NAME(name)
+{
+    X_UNUSED(name);
+}
+
+
+DEASTLAllocator& DEASTLAllocator::operator=(const DEASTLAllocator& x)
+{
+    /* EASTLのアロケータと同様に、名前はコピーしません */
+    m_kind = x.m_kind;
+    m_impl = x.m_impl;
+    return *this;
+}
+
+
+void* DEASTLAllocator::allocate(size_t n, int flags)
+{
+    X_UNUSED(flags);
+
+    void* ptr = NULL;
+    switch (m_kind)
+    {
+    case KIND_PICO:
+        ptr = xpalloc_allocate(static_cast<XPicoAllocator*>(m_impl), n);
+        break;
+    case KIND_FIXED:
+    {
+        XFixedAllocator* const fixed = static_cast<XFixedAllocator*>(m_impl);
+        X_ASSERT(n <= xfalloc_block_size(fixed));
+        if ((n <= xfalloc_block_size(fixed)) && (xfalloc_remain_blocks(fixed) > 0))
+            ptr = xfalloc_allocate(fixed);
+        break;
+    }
+    case KIND_STACK:
+    {
+        /* xsalloc_allocate()は空きが足りなくてもNULLを返さないので、先に調べます */
+        XStackAllocator* const stack = static_cast<XStackAllocator*>(m_impl);
+        if (x_roundup_alignment(n, xsalloc_alignment(stack)) <= xsalloc_reserve(stack))
+            ptr = xsalloc_allocate(stack, n);
+        break;
+    }
+    default:
+        return ::operator new(n);
+    }
+
+    /* EASTLのコンテナは確保の失敗を考慮しないので、::operator newで確保します */
+    if (!ptr)
+    {
+        core_util_critical_section_enter();
+        _fallback_count++;
+        core_util_critical_section_exit();
+        ptr = ::operator new(n);
+    }
+
+    return ptr;
+}
+
+
+void* DEASTLAllocator::allocate(size_t n, size_t alignment, size_t offset, int flags)
+{
+    /* picoxのアロケータのアラインメントは初期化時に決まるので、それを超える
+     * アラインメントには対応しません */
+    X_ASSERT(offset == 0);
+    X_ASSERT(alignment <= D_ALIGNMENT_OF(XMaxAlign));
+    X_UNUSED(alignment);
+    X_UNUSED(offset);
+
+    return allocate(n, flags);
+}
+
+
+void DEASTLAllocator::deallocate(void* p, size_t n)
+{
+    X_UNUSED(n);
+
+    if (!p)
+        return;
+
+    if (!this->IsOwner(p))
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    switch (m_kind)
+    {
+    case KIND_PICO:
+        xpalloc_deallocate(static_cast<XPicoAllocator*>(m_impl), p);
+        break;
+    case KIND_FIXED:
+        xfalloc_deallocate(static_cast<XFixedAllocator*>(m_impl), p);
+        break;
+    case KIND_STACK:
+        break;
+    default:
+        ::operator delete(p);
+        break;
+    }
+}
+
+
+uint32_t DEASTLAllocator::fallbackCount()
+{
+    return _fallback_count;
+}
+
+
+bool DEASTLAllocator::IsOwner(const void* p) const
+{
+    const uint8_t* begin;
+    const uint8_t* end;
+
+    switch (m_kind)
+    {
+    case KIND_PICO:
+        return xpalloc_is_owner(static_cast<const XPicoAllocator*>(m_impl), p);
+    case KIND_FIXED:
+    {
+        const XFixedAllocator* const fixed = static_cast<const XFixedAllocator*>(m_impl);
+        begin = static_cast<const uint8_t*>(X_ROUNDUP_MULTIPLE_PTR(xfalloc_heap(fixed), D_ALIGNMENT_OF(XMaxAlign)));
+        end = begin + xfalloc_block_size(fixed) * xfalloc_num_blocks(fixed);
+        break;
+    }
+    case KIND_STACK:
+    {
+        const XStackAllocator* const stack = static_cast<const XStackAllocator*>(m_impl);
+        begin = static_cast<const uint8_t*>(X_ROUNDUP_ALIGNMENT_PTR(xsalloc_heap(stack), xsalloc_alignment(stack)));
+        end = begin + xsalloc_capacity(stack);
+        break;
+    }
+    default:
+        return false;
+    }
+
+    return x_is_within_ptr(p, begin, end);
+}
+
+
+const char* DEASTLAllocator::get_name() const
+{
+#if EASTL_NAME_ENABLED
+    return m_name;
+#else
+    return "DEASTLAllocator";
+#endif
+}
+
+
+void DEASTLAllocator::set_name(const char* name)
+{
+#if EASTL_NAME_ENABLED
+    m_name = name;
+#else
+    X_UNUSED(name);
+#endif
+}
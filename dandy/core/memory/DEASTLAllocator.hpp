@@ -0,0 +1,133 @@
+/**
+ *       @file  DEASTLAllocator.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DEASTLAllocator_hpp_
+#define dandy_DEASTLAllocator_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include <picox/allocator/xpico_allocator.h>
+#include <picox/allocator/xfixed_allocator.h>
+#include <picox/allocator/xstack_allocator.h>
+#include <EASTL/internal/config.h>
+
+
+/** picoxのアロケータから確保を行うEASTLのアロケータです
+ *
+ *  EASTLのコンテナのテンプレート引数に指定して、サブシステムごとに専用のメモリ
+ *  領域を割り当てるために使用します。確保先は構築時に次のいずれかから選択します。
+ *
+ *  + XPicoAllocator: 任意サイズの確保を行う汎用のヒープ
+ *  + XFixedAllocator: 1ブロックずつの確保。list, mapなどのノードのサイズに合わ
+ *    せたブロックサイズで初期化してください(DShell::NODE_SIZEなど)
+ *  + XStackAllocator: 解放を行わないスタック。deallocate()は何もしないので、
+ *    コンテナを破棄した後にxsalloc_clear()でまとめて解放してください
+ *  + 指定なし: ::operator newとoperator deleteによるヒープ
+ *
+ *  picoxのアロケータに空きがない場合は、::operator newで確保します。その回数は
+ *  fallbackCount()で取得できます。
+ *
+ *  コピーしたアロケータは同じpicoxのアロケータを共有します。picoxのアロケータは
+ *  スレッドセーフではないので、同じアロケータを複数のスレッドのコンテナで共有
+ *  してはいけません。
+ *
+ *  EASTL_NAME_ENABLEDが有効なビルドでは、インスタンスごとに名前を持ちます。
+ *
+ *  @code
+ *  static uint8_t heap[2048];
+ *  XPicoAllocator pico;
+ *  xpalloc_init(&pico, heap, sizeof(heap), sizeof(void*));
+ *  eastl::vector<int, DEASTLAllocator> v(DEASTLAllocator(&pico, "sensor log"));
+ *  @endcode
+ */
+class DEASTLAllocator
+{
+public:
+    explicit DEASTLAllocator(const char* name = EASTL_NAME_VAL("DEASTLAllocator"));
+    explicit DEASTLAllocator(XPicoAllocator* pico, const char* name = EASTL_NAME_VAL("DEASTLAllocator"));
+    explicit DEASTLAllocator(XFixedAllocator* fixed, const char* name = EASTL_NAME_VAL("DEASTLAllocator"));
+    explicit DEASTLAllocator(XStackAllocator* stack, const char* name = EASTL_NAME_VAL("DEASTLAllocator"));
+    DEASTLAllocator(const DEASTLAllocator& x);
+    DEASTLAllocator(const DEASTLAllocator& x, const char* name);
+    DEASTLAllocator& operator=(const DEASTLAllocator& x);
+
+    void* allocate(size_t n, int flags = 0);
+    void* allocate(size_t n, size_t alignment, size_t offset, int flags = 0);
+    void deallocate(void* p, size_t n);
+
+    const char* get_name() const;
+    void set_name(const char* name);
+
+
+    /** picoxのアロケータに空きがなく、::operator newで確保した回数を返します
+     *
+     *  すべてのインスタンスの合計です。
+     */
+    static uint32_t fallbackCount();
+
+    friend bool operator==(const DEASTLAllocator& a, const DEASTLAllocator& b)
+    {
+        return (a.m_kind == b.m_kind) && (a.m_impl == b.m_impl);
+    }
+
+    friend bool operator!=(const DEASTLAllocator& a, const DEASTLAllocator& b)
+    {
+        return !(a == b);
+    }
+
+private:
+    bool IsOwner(const void* p) const;
+
+    enum Kind
+    {
+        KIND_HEAP,
+        KIND_PICO,
+        KIND_FIXED,
+        KIND_STACK
+    };
+
+    Kind m_kind;
+    void* m_impl;
+#if EASTL_NAME_ENABLED
+    const char* m_name;
+#endif
+};
+
+
+#endif /* end of include guard: dandy_DEASTLAllocator_hpp_ */
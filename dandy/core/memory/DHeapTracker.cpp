@@ -0,0 +1,491 @@
+/**
+ *       @file  DHeapTracker.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/memory/DHeapTracker.hpp>
+
+
+#if D_HEAP_TRACKING
+
+
+#include <new>
+#include <stdarg.h>
+#include "platform/mbed_error.h"
+#include "platform/mbed_mem_trace.h"
+
+
+#ifndef MBED_MEM_TRACING_ENABLED
+    #error "D_HEAP_TRACKING requires MBED_MEM_TRACING_ENABLED"
+#endif
+
+
+static const size_t D__MAX_ALLOCATIONS = D_HEAP_TRACKING_MAX_ALLOCATIONS;
+static const size_t D__MAX_SITES = D_HEAP_TRACKING_MAX_SITES;
+static const uint16_t D__NO_SITE = 0xFFFF;
+static const int D__MAX_PROBE_BLOCKS = 32;
+static const size_t D__PROBE_LIMIT = 1024 * 1024;
+
+static_assert((D__MAX_ALLOCATIONS & (D__MAX_ALLOCATIONS - 1)) == 0,
+              "D_HEAP_TRACKING_MAX_ALLOCATIONS must be a power of 2");
+static_assert((D__MAX_SITES & (D__MAX_SITES - 1)) == 0,
+              "D_HEAP_TRACKING_MAX_SITES must be a power of 2");
+
+
+struct D__Allocation
+{
+    void* ptr;
+    size_t size;
+    uint16_t site;
+};
+
+
+/* 静的初期化より前にoperator newが呼ばれても使えるように、すべてゼロ初期化の
+ * 変数だけで管理します */
+static D__Allocation _allocations[D__MAX_ALLOCATIONS];
+static DHeapTracker::Site _sites[D__MAX_SITES];
+static int _siteCount;
+static uint32_t _histogram[DHeapTracker::HISTOGRAM_BUCKETS];
+static DHeapTracker::Stats _stats;
+static bool _traceInstalled;
+
+
+static size_t D__AllocationIndex(const void* ptr)
+{
+    return ((reinterpret_cast<uintptr_t>(ptr) >> 3) * 2654435761U) & (D__MAX_ALLOCATIONS - 1);
+}
+
+
+static uint16_t D__FindSite(const DHeapSite& site)
+{
+    const size_t mask = D__MAX_SITES - 1;
+    size_t i = ((reinterpret_cast<uintptr_t>(site.file) >> 2) ^ (site.line * 2654435761U)) & mask;
+    for (size_t n = 0; n < D__MAX_SITES; n++, i = (i + 1) & mask)
+    {
+        DHeapTracker::Site& s = _sites[i];
+        if (!s.file)
+        {
+            /* テーブルを使い切らないように、1つは空けておきます */
+            if (_siteCount + 1 >= static_cast<int>(D__MAX_SITES))
+                return D__NO_SITE;
+
+            s.file = site.file;
+            s.line = site.line;
+            _siteCount++;
+            return static_cast<uint16_t>(i);
+        }
+
+        if ((s.line == site.line) &&
+            ((s.file == site.file) || (std::strcmp(s.file, site.file) == 0)))
+            return static_cast<uint16_t>(i);
+    }
+
+    return D__NO_SITE;
+}
+
+
+static int D__Bucket(size_t size)
+{
+    int bucket = 0;
+    for (size_t limit = 8; (size > limit) && (bucket < DHeapTracker::HISTOGRAM_BUCKETS - 1); limit <<= 1)
+        bucket++;
+
+    return bucket;
+}
+
+
+static void D__Track(void* ptr, size_t size, const DHeapSite& site)
+{
+    core_util_critical_section_enter();
+
+    _stats.allocations++;
+    _histogram[D__Bucket(size)]++;
+
+    if (_stats.liveBlocks + 1 >= D__MAX_ALLOCATIONS)
+    {
+        _stats.untracked++;
+        core_util_critical_section_exit();
+        return;
+    }
+
+    size_t i = D__AllocationIndex(ptr);
+    while (_allocations[i].ptr)
+        i = (i + 1) & (D__MAX_ALLOCATIONS - 1);
+
+    const uint16_t siteIndex = D__FindSite(site);
+    _allocations[i].ptr = ptr;
+    _allocations[i].size = size;
+    _allocations[i].site = siteIndex;
+
+    _stats.liveBlocks++;
+    _stats.liveBytes += size;
+    if (_stats.liveBytes > _stats.peakBytes)
+        _stats.peakBytes = _stats.liveBytes;
+
+    if (siteIndex != D__NO_SITE)
+    {
+        DHeapTracker::Site& s = _sites[siteIndex];
+        s.allocations++;
+        s.liveBlocks++;
+        s.liveBytes += size;
+    }
+
+    core_util_critical_section_exit();
+}
+
+
+static void D__Untrack(void* ptr)
+{
+    const size_t mask = D__MAX_ALLOCATIONS - 1;
+
+    core_util_critical_section_enter();
+
+    size_t hole = D__AllocationIndex(ptr);
+    while (_allocations[hole].ptr && (_allocations[hole].ptr != ptr))
+        hole = (hole + 1) & mask;
+
+    if (!_allocations[hole].ptr)
+    {
+        /* D_NEW()以外で確保されたブロックです */
+        core_util_critical_section_exit();
+        return;
+    }
+
+    const D__Allocation& found = _allocations[hole];
+    _stats.frees++;
+    _stats.liveBlocks--;
+    _stats.liveBytes -= found.size;
+    if (found.site != D__NO_SITE)
+    {
+        DHeapTracker::Site& s = _sites[found.site];
+        s.liveBlocks--;
+        s.liveBytes -= found.size;
+    }
+
+    /* 後続のエントリを詰めて、探索の連鎖が途切れないようにします */
+    size_t i = hole;
+    for (;;)
+    {
+        i = (i + 1) & mask;
+        const D__Allocation& entry = _allocations[i];
+        if (!entry.ptr)
+            break;
+
+        const size_t home = D__AllocationIndex(entry.ptr);
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            _allocations[hole] = entry;
+            hole = i;
+        }
+    }
+    _allocations[hole].ptr = NULL;
+
+    core_util_critical_section_exit();
+}
+
+
+static size_t D__LargestAllocatable()
+{
+    size_t lo = 0;
+    size_t hi = D__PROBE_LIMIT;
+    while (lo < hi)
+    {
+        const size_t mid = lo + (hi - lo + 1) / 2;
+        void* const p = std::malloc(mid);
+        if (p)
+        {
+            std::free(p);
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+
+    return lo;
+}
+
+
+/* mbedのmalloc()ラッパーが呼び出すトレースのコールバックです。delete式や
+ * free()で解放されたブロックをここで記録から外します */
+static void D__TraceCallback(uint8_t op, void* res, void* caller, ...)
+{
+    X_UNUSED(caller);
+
+    if ((op != MBED_MEM_TRACE_FREE) && (op != MBED_MEM_TRACE_REALLOC))
+        return;
+
+    va_list args;
+    va_start(args, caller);
+    void* const ptr = va_arg(args, void*);
+    va_end(args);
+
+    /* realloc()が失敗した場合は元のブロックがそのまま残っています */
+    if ((op == MBED_MEM_TRACE_REALLOC) && !res)
+        return;
+
+    if (ptr)
+        D__Untrack(ptr);
+}
+
+
+static const char* D__BaseName(const char* path)
+{
+    const char* const slash = std::strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+
+DHeapTracker::Stats DHeapTracker::stats()
+{
+    core_util_critical_section_enter();
+    const Stats ret = _stats;
+    core_util_critical_section_exit();
+
+    return ret;
+}
+
+
+int DHeapTracker::siteCount()
+{
+    return _siteCount;
+}
+
+
+DHeapTracker::Site DHeapTracker::site(int index)
+{
+    X_ASSERT((index >= 0) && (index < _siteCount));
+
+    Site ret = Site();
+    core_util_critical_section_enter();
+    for (size_t i = 0; i < D__MAX_SITES; i++)
+    {
+        if (_sites[i].file && (index-- == 0))
+        {
+            ret = _sites[i];
+            break;
+        }
+    }
+    core_util_critical_section_exit();
+
+    return ret;
+}
+
+
+uint32_t DHeapTracker::histogram(int bucket)
+{
+    X_ASSERT((bucket >= 0) && (bucket < HISTOGRAM_BUCKETS));
+    return _histogram[bucket];
+}
+
+
+void DHeapTracker::measureFreeSpace(size_t* largestFree, size_t* totalFree)
+{
+    struct Block
+    {
+        Block* next;
+    };
+
+    Block* head = NULL;
+    size_t largest = 0;
+    size_t total = 0;
+
+    for (int n = 0; n < D__MAX_PROBE_BLOCKS; n++)
+    {
+        const size_t size = D__LargestAllocatable();
+        if (size < sizeof(Block))
+            break;
+
+        Block* const block = static_cast<Block*>(std::malloc(size));
+        if (!block)
+            break;
+
+        block->next = head;
+        head = block;
+        total += size;
+        if (size > largest)
+            largest = size;
+    }
+
+    while (head)
+    {
+        Block* const next = head->next;
+        std::free(head);
+        head = next;
+    }
+
+    if (largestFree)
+        *largestFree = largest;
+    if (totalFree)
+        *totalFree = total;
+}
+
+
+void DHeapTracker::report(DStream* out)
+{
+    X_ASSERT(out);
+
+    const Stats s = stats();
+    out->printf("live %lu bytes in %lu blocks, peak %lu bytes\n",
+                static_cast<unsigned long>(s.liveBytes),
+                static_cast<unsigned long>(s.liveBlocks),
+                static_cast<unsigned long>(s.peakBytes));
+    out->printf("%lu allocations, %lu frees, %lu untracked\n",
+                static_cast<unsigned long>(s.allocations),
+                static_cast<unsigned long>(s.frees),
+                static_cast<unsigned long>(s.untracked));
+
+    out->printf("size histogram:\n");
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        if (i == HISTOGRAM_BUCKETS - 1)
+            out->printf("  >%6lu: %lu\n", 4UL << i, static_cast<unsigned long>(histogram(i)));
+        else
+            out->printf(" <=%6lu: %lu\n", 8UL << i, static_cast<unsigned long>(histogram(i)));
+    }
+
+    /* スタックに集計のコピーを置かないように、確保中のバイト数の多い順に1つず
+     * つ選んで出力します。出力中に集計が変わっても終わるように、選ぶ回数はテー
+     * ブルの大きさまでにします */
+    out->printf("sites:\n");
+    size_t prevBytes = SIZE_MAX;
+    size_t prevIndex = 0;
+    bool first = true;
+    for (size_t n = 0; n < D__MAX_SITES; n++)
+    {
+        Site site = Site();
+        size_t index = D__MAX_SITES;
+        core_util_critical_section_enter();
+        for (size_t i = 0; i < D__MAX_SITES; i++)
+        {
+            const Site& s = _sites[i];
+            if (!s.file)
+                continue;
+
+            /* 前回出力した位置より後に並ぶものだけが対象です */
+            if (!first && ((s.liveBytes > prevBytes) ||
+                           ((s.liveBytes == prevBytes) && (i <= prevIndex))))
+                continue;
+
+            if ((index == D__MAX_SITES) || (s.liveBytes > site.liveBytes))
+            {
+                site = s;
+                index = i;
+            }
+        }
+        core_util_critical_section_exit();
+
+        if (index == D__MAX_SITES)
+            break;
+
+        out->printf("  %s:%d allocs %lu live %lu blocks %lu bytes\n",
+                    D__BaseName(site.file), site.line,
+                    static_cast<unsigned long>(site.allocations),
+                    static_cast<unsigned long>(site.liveBlocks),
+                    static_cast<unsigned long>(site.liveBytes));
+
+        prevBytes = site.liveBytes;
+        prevIndex = index;
+        first = false;
+    }
+
+    size_t largestFree;
+    size_t totalFree;
+    measureFreeSpace(&largestFree, &totalFree);
+    out->printf("free %lu bytes, largest block %lu bytes\n",
+                static_cast<unsigned long>(totalFree),
+                static_cast<unsigned long>(largestFree));
+}
+
+
+void* DHeapTracker::allocate(size_t size, const DHeapSite& site)
+{
+    /* 確保と記録の間に他のスレッドが同じアドレスを解放して記録が前後しないよう
+     * に、mbedのmalloc()ラッパーと同じロックの中で記録します */
+    mbed_mem_trace_lock();
+    if (!_traceInstalled)
+    {
+        mbed_mem_trace_set_callback(D__TraceCallback);
+        _traceInstalled = true;
+    }
+
+    void* const ptr = std::malloc(size ? size : 1);
+    if (ptr)
+        D__Track(ptr, size, site);
+    mbed_mem_trace_unlock();
+
+    /* mbedのoperator newと同じく、確保できなければ停止します */
+    if (!ptr)
+        error("D_NEW out of memory\r\n");
+
+    return ptr;
+}
+
+
+void DHeapTracker::deallocate(void* ptr)
+{
+    /* 記録からはトレースのコールバックで外れます */
+    std::free(ptr);
+}
+
+
+void* operator new(size_t size, const DHeapSite& site)
+{
+    return DHeapTracker::allocate(size, site);
+}
+
+
+void* operator new[](size_t size, const DHeapSite& site)
+{
+    return DHeapTracker::allocate(size, site);
+}
+
+
+void operator delete(void* ptr, const DHeapSite&)
+{
+    DHeapTracker::deallocate(ptr);
+}
+
+
+void operator delete[](void* ptr, const DHeapSite&)
+{
+    DHeapTracker::deallocate(ptr);
+}
+
+
+#endif /* D_HEAP_TRACKING */
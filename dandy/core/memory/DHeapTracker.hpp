@@ -0,0 +1,170 @@
+/**
+ *       @file  DHeapTracker.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DHeapTracker_hpp_
+#define dandy_DHeapTracker_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include <dandy/core/stream/DStream.hpp>
+
+
+/** @def    D_HEAP_TRACKING_MAX_ALLOCATIONS
+ *  @brief  記録できる確保中のブロック数です(2のべき乗)
+ */
+#ifndef D_HEAP_TRACKING_MAX_ALLOCATIONS
+    #define D_HEAP_TRACKING_MAX_ALLOCATIONS 512
+#endif
+
+
+/** @def    D_HEAP_TRACKING_MAX_SITES
+ *  @brief  記録できるD_NEW()の呼び出し位置の数です(2のべき乗)
+ */
+#ifndef D_HEAP_TRACKING_MAX_SITES
+    #define D_HEAP_TRACKING_MAX_SITES 64
+#endif
+
+
+#if D_HEAP_TRACKING
+
+
+/** D_NEW()による動的メモリ確保を記録します
+ *
+ *  D_HEAP_TRACKINGに1を定義したビルドでのみ使用できます。D_NEW()で確保したブ
+ *  ロックを固定長のテーブルに記録し、確保中のバイト数とその最大値、呼び出し位
+ *  置(ファイルと行)ごとの確保数、サイズのヒストグラムを集計します。
+ *
+ *  グローバルなoperator new/deleteは置き換えません。解放はmbedのメモリトレー
+ *  スのコールバックで検出するので、MBED_MEM_TRACING_ENABLEDも定義する必要があ
+ *  ります。最初のD_NEW()でコールバックを登録するので、アプリケーションが
+ *  mbed_mem_trace_set_callback()で登録したコールバックは置き換えられます。
+ *  コールバックで解放を検出するので、D_DELETE()以外で解放しても集計されます。
+ *
+ *  テーブルが一杯の場合や、D_NEW()を使わずに確保したブロックは集計されません。
+ *  テーブルの更新はクリティカルセクションで保護します。
+ *
+ *  @code
+ *  DHeapTracker::report(stdOut);
+ *  @endcode
+ */
+class DHeapTracker
+{
+public:
+
+    /** ヒストグラムの区間の数です
+     *
+     *  区間iは(4 << i, 8 << i]バイトで、最初の区間は8バイト以下、最後の区間はそ
+     *  れより大きいすべてのサイズです。
+     */
+    static const int HISTOGRAM_BUCKETS = 12;
+
+
+    /** 全体の集計です
+     */
+    struct Stats
+    {
+        size_t liveBytes;
+        size_t liveBlocks;
+        size_t peakBytes;
+        uint32_t allocations;
+        uint32_t frees;
+        uint32_t untracked;     /* テーブルが一杯で記録できなかった確保の数 */
+    };
+
+
+    /** 呼び出し位置ごとの集計です
+     */
+    struct Site
+    {
+        const char* file;
+        int line;
+        uint32_t allocations;
+        size_t liveBlocks;
+        size_t liveBytes;
+    };
+
+
+    /** 全体の集計を返します
+     */
+    static Stats stats();
+
+
+    /** 記録されている呼び出し位置の数を返します
+     */
+    static int siteCount();
+
+
+    /** index番目の呼び出し位置の集計を返します
+     */
+    static Site site(int index);
+
+
+    /** bucket番目の区間の確保回数を返します
+     */
+    static uint32_t histogram(int bucket);
+
+
+    /** ヒープの空き容量を調べます
+     *
+     *  確保できる最大のブロックをmalloc()で二分探索しながら確保していき、その
+     *  合計を空き容量とします。largestFree / totalFreeが1から離れるほど断片化が
+     *  進んでいます。数百回のmalloc()/free()を行うので、診断用のコマンドなどか
+     *  ら呼び出してください。実行中は他のスレッドの確保が失敗することがあります。
+     */
+    static void measureFreeSpace(size_t* largestFree, size_t* totalFree);
+
+
+    /** 集計結果と空き容量をoutに出力します
+     *
+     *  呼び出し位置は確保中のバイト数の多い順に出力します。
+     */
+    static void report(DStream* out);
+
+
+    /// @cond IGNORE
+    static void* allocate(size_t size, const DHeapSite& site);
+    static void deallocate(void* ptr);
+    /// @endcond IGNORE
+};
+
+
+#endif /* D_HEAP_TRACKING */
+
+
+#endif /* end of include guard: dandy_DHeapTracker_hpp_ */
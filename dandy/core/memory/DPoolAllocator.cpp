@@ -0,0 +1,183 @@
+/**
+ *       @file  DPoolAllocator.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/memory/DPoolAllocator.hpp>
+#include <new>
+
+
+static SingletonPtr<DPoolAllocator> _shared_instance;
+
+
+DPoolAllocator* DPoolAllocator::shared()
+{
+    return _shared_instance.get();
+}
+
+
+DPoolAllocator::DPoolAllocator()
+    : m_poolCount(0)
+    , m_fallbackCount(0)
+{
+}
+
+
+bool DPoolAllocator::addPool(size_t blockSize, void* heap, size_t heapSize)
+{
+    X_ASSERT(heap);
+    X_ASSERT(blockSize > 0);
+
+    if (m_poolCount >= MAX_POOLS)
+        return false;
+
+    /* xfalloc_init()はポインタのアラインメントにしか切り上げないので、どのオブ
+     * ジェクトでも置けるように最大のアラインメントに切り上げます */
+    blockSize = X_ROUNDUP_MULTIPLE(blockSize, D_ALIGNMENT_OF(XMaxAlign));
+
+    int index = 0;
+    while ((index < m_poolCount) && (xfalloc_block_size(&m_pools[index].allocator) < blockSize))
+        index++;
+
+    Pool pool;
+    xfalloc_init(&pool.allocator, heap, heapSize, blockSize);
+    if ((xfalloc_num_blocks(&pool.allocator) == 0) ||
+        ((index < m_poolCount) &&
+         (xfalloc_block_size(&m_pools[index].allocator) == xfalloc_block_size(&pool.allocator))))
+        return false;
+
+    pool.begin = static_cast<const uint8_t*>(heap);
+    pool.end = pool.begin + heapSize;
+    pool.peakBlocks = 0;
+    pool.allocations = 0;
+    pool.failures = 0;
+
+    core_util_critical_section_enter();
+    for (int i = m_poolCount; i > index; i--)
+        m_pools[i] = m_pools[i - 1];
+    m_pools[index] = pool;
+    m_poolCount++;
+    core_util_critical_section_exit();
+
+    return true;
+}
+
+
+void* DPoolAllocator::allocate(size_t size)
+{
+    void* ptr = NULL;
+
+    core_util_critical_section_enter();
+    for (int i = 0; i < m_poolCount; i++)
+    {
+        Pool& pool = m_pools[i];
+        if (xfalloc_block_size(&pool.allocator) < size)
+            continue;
+
+        if (xfalloc_remain_blocks(&pool.allocator) == 0)
+        {
+            pool.failures++;
+            break;
+        }
+
+        ptr = xfalloc_allocate(&pool.allocator);
+        pool.allocations++;
+        const size_t used = xfalloc_num_blocks(&pool.allocator) - xfalloc_remain_blocks(&pool.allocator);
+        if (used > pool.peakBlocks)
+            pool.peakBlocks = used;
+        break;
+    }
+
+    if (!ptr)
+        m_fallbackCount++;
+    core_util_critical_section_exit();
+
+    if (!ptr)
+    {
+        /* ヒープはmutexで保護されているので、割り込みハンドラからは確保できない */
+        X_ASSERT(!core_util_is_isr_active());
+        if (core_util_is_isr_active())
+            return NULL;
+
+        ptr = ::operator new(size);
+    }
+
+    return ptr;
+}
+
+
+void DPoolAllocator::deallocate(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    const uint8_t* const p = static_cast<const uint8_t*>(ptr);
+    for (int i = 0; i < m_poolCount; i++)
+    {
+        Pool& pool = m_pools[i];
+        if ((p >= pool.begin) && (p < pool.end))
+        {
+            core_util_critical_section_enter();
+            xfalloc_deallocate(&pool.allocator, ptr);
+            core_util_critical_section_exit();
+            return;
+        }
+    }
+
+    X_ASSERT(!core_util_is_isr_active());
+    ::operator delete(ptr);
+}
+
+
+DPoolAllocator::Stats DPoolAllocator::stats(int index) const
+{
+    X_ASSERT((index >= 0) && (index < m_poolCount));
+
+    const Pool& pool = m_pools[index];
+    Stats ret;
+
+    core_util_critical_section_enter();
+    ret.blockSize = xfalloc_block_size(&pool.allocator);
+    ret.numBlocks = xfalloc_num_blocks(&pool.allocator);
+    ret.usedBlocks = ret.numBlocks - xfalloc_remain_blocks(&pool.allocator);
+    ret.peakBlocks = pool.peakBlocks;
+    ret.allocations = pool.allocations;
+    ret.failures = pool.failures;
+    core_util_critical_section_exit();
+
+    return ret;
+}
@@ -0,0 +1,208 @@
+/**
+ *       @file  DPoolAllocator.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DPoolAllocator_hpp_
+#define dandy_DPoolAllocator_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include <picox/allocator/xfixed_allocator.h>
+
+
+/** クラスのnew/deleteをDPoolAllocator::shared()から行うように宣言します
+ *
+ *  DRefやDObjectの派生クラスなど、実行時に同じ大きさのオブジェクトを大量に確保
+ *  するクラスの宣言の中に記述します。D_NEW()とD_DELETE()はクラスのoperator
+ *  new/deleteを使用するので、呼び出し側を変更する必要はありません。派生クラス
+ *  にも継承されます。
+ *
+ *  @code
+ *  class DMessage : public DRef
+ *  {
+ *      D_DECLARE_POOLED(DMessage);
+ *  public:
+ *      ...
+ *  };
+ *  @endcode
+ */
+#define D_DECLARE_POOLED(T)                                                  \
+    public:                                                                  \
+        static void* operator new(size_t size)                               \
+        {                                                                    \
+            X_ASSERT(size >= sizeof(T));                                     \
+            return DPoolAllocator::shared()->allocate(size);                 \
+        }                                                                    \
+        static void operator delete(void* ptr)                               \
+        {                                                                    \
+            DPoolAllocator::shared()->deallocate(ptr);                       \
+        }                                                                    \
+        static void* operator new(size_t, void* ptr) { return ptr; }         \
+        static void operator delete(void*, void*) {}                         \
+        D__DECLARE_POOLED_SITE_NEW()                                         \
+    private:
+
+
+/// @cond IGNORE
+#if D_HEAP_TRACKING
+    /* D_NEW()が使用するoperator newです。プールからの確保は記録しません */
+    #define D__DECLARE_POOLED_SITE_NEW()                                     \
+        static void* operator new(size_t size, const DHeapSite&)             \
+        {                                                                    \
+            return DPoolAllocator::shared()->allocate(size);                 \
+        }                                                                    \
+        static void operator delete(void* ptr, const DHeapSite&)             \
+        {                                                                    \
+            DPoolAllocator::shared()->deallocate(ptr);                       \
+        }
+#else
+    #define D__DECLARE_POOLED_SITE_NEW()
+#endif
+/// @endcond IGNORE
+
+
+/** サイズクラスごとの固定長ブロックプールから確保を行うアロケータです
+ *
+ *  addPool()で登録したプールのうち、要求サイズが収まる最小のブロックのプールか
+ *  ら確保します。該当するプールがない場合や、プールが空の場合は::operator new
+ *  で確保するので、プールの大きさは実際の使用量に合わせて調整できます。
+ *
+ *  各プールはpicoxのxfixed_allocatorで、確保と解放は数十命令のクリティカルセク
+ *  ション内で行います。割り込みハンドラから呼び出せるのは、プールから確保でき
+ *  る場合と、プールのブロックを解放する場合だけです。::operator newに回る確保
+ *  は割り込みハンドラではアサートに失敗し、アサートが無効な場合はNULLを返しま
+ *  す。::operator newで確保したブロックも割り込みハンドラで解放してはいけませ
+ *  ん。割り込みハンドラで使用するサイズのプールは十分な大きさにしてください。
+ *
+ *  @code
+ *  static uint64_t pool32[32 / 8 * 64];
+ *  static uint64_t pool64[64 / 8 * 32];
+ *  DPoolAllocator::shared()->addPool(32, pool32, sizeof(pool32));
+ *  DPoolAllocator::shared()->addPool(64, pool64, sizeof(pool64));
+ *  @endcode
+ */
+class DPoolAllocator
+{
+public:
+
+    /** 登録できるプールの最大数です
+     */
+    static const int MAX_POOLS = 8;
+
+
+    /** プールの統計情報です
+     */
+    struct Stats
+    {
+        size_t blockSize;
+        size_t numBlocks;
+        size_t usedBlocks;
+        size_t peakBlocks;
+        uint32_t allocations;
+        uint32_t failures;          /* 空きがなく::operator newに回した回数 */
+    };
+
+
+    /** D_DECLARE_POOLED()で使用する共有のアロケータを返します
+     */
+    static DPoolAllocator* shared();
+
+
+    DPoolAllocator();
+
+
+    /** blockSizeバイトのブロックのプールを登録します
+     *
+     *  blockSizeは最大のアラインメントの倍数に切り上げます。
+     *  heapは登録したアロケータより長く存在しなければなりません。同じブロック
+     *  サイズのプールがすでにあるか、MAX_POOLSを超える場合はfalseを返します。
+     *  オブジェクトを確保する前に登録してください。
+     */
+    bool addPool(size_t blockSize, void* heap, size_t heapSize);
+
+
+    /** sizeバイトのメモリを確保します
+     *
+     *  割り込みハンドラから呼び出した場合、プールから確保できなければNULLを返し
+     *  ます(アサートが有効な場合はアサートに失敗します)。
+     */
+    void* allocate(size_t size);
+
+
+    /** allocate()で確保したメモリを解放します
+     *
+     *  ptrがNULLの場合は何もしません。
+     */
+    void deallocate(void* ptr);
+
+
+    /** 登録されているプールの数を返します
+     */
+    int poolCount() const { return m_poolCount; }
+
+
+    /** index番目(ブロックサイズの昇順)のプールの統計情報を返します
+     */
+    Stats stats(int index) const;
+
+
+    /** ::operator newに回した確保の回数を返します
+     */
+    uint32_t fallbackCount() const { return m_fallbackCount; }
+
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DPoolAllocator);
+
+    struct Pool
+    {
+        XFixedAllocator allocator;
+        const uint8_t* begin;
+        const uint8_t* end;
+        size_t peakBlocks;
+        uint32_t allocations;
+        uint32_t failures;
+    };
+
+    Pool m_pools[MAX_POOLS];
+    int m_poolCount;
+    uint32_t m_fallbackCount;
+};
+
+
+#endif /* end of include guard: dandy_DPoolAllocator_hpp_ */
@@ -39,6 +39,7 @@
 
 
 #include <dandy/core/stream/DStream.hpp>
+#include <dandy/core/memory/DArena.hpp>
 
 
 X_IMPL_RTTI_TAG(D__DSTREAM_RTTI_TAG) = 0;
@@ -85,21 +86,35 @@ char* DStream::gets(char* dst, size_t size, bool* overflow)
 
 std::string DStream::getline(size_t maxLineSize)
 {
-    char* p = D_NEW(char[maxLineSize]);
+    char* p = static_cast<char*>(DArena::scopedAllocate(maxLineSize));
     X_ASSERT(p);
 
     if (!this->gets(p, maxLineSize, nullptr))
     {
-        D_DELETE_ARRAY(p);
+        DArena::scopedDeallocate(p);
         return std::string();
     }
 
     const std::string result(p);
-    D_DELETE_ARRAY(p);
+    DArena::scopedDeallocate(p);
 
     return result;
 }
 
+bool DStream::getline(DFixedStringBase* dst)
+{
+    X_ASSERT(dst);
+
+    bool overflow = false;
+    dst->clear();
+    if (!this->gets(dst->data(), dst->capacity() + 1, &overflow))
+        return false;
+
+    dst->updateLength(overflow);
+
+    return true;
+}
+
 static int D__WriteStream(void* self, const void* src, size_t size, size_t* nwritten)
 {
     const ssize_t ret = static_cast<DStream*>(self)->write(src, size);
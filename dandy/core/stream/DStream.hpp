@@ -42,6 +42,7 @@
 
 
 #include <dandy/core/DCore.hpp>
+#include <dandy/core/DFixedString.hpp>
 
 
 class DStream : public FileHandle
@@ -71,6 +72,14 @@ public:
     char* gets(char* dst, size_t size, bool* overflow);
     std::string getline(size_t maxLineSize = 1024);
 
+    /** 1行を読み込んでdstに設定します。動的メモリ確保は行いません
+     *
+     *  dstの容量を超える行は切り詰められ、dst->overflowed()がtrueになります。
+     *
+     *  @return 行を読み込めなかった場合はfalse
+     */
+    bool getline(DFixedStringBase* dst);
+
 private:
     D_DISALLOW_COPY_AND_ASSIGN(DStream);
 };
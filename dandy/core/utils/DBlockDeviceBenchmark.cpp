@@ -0,0 +1,337 @@
+/**
+ *       @file  DBlockDeviceBenchmark.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/utils/DBlockDeviceBenchmark.hpp>
+#include <dandy/core/utils/DBlockDeviceUtils.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+#include <algorithm>
+
+
+static bd_size_t D__roundUp(bd_size_t value, bd_size_t unit)
+{
+    return ((value + unit - 1) / unit) * unit;
+}
+
+
+uint32_t DBlockDeviceBenchmark::Result::kbytesPerSecond() const
+{
+    if (totalUs == 0)
+        return 0;
+
+    return static_cast<uint32_t>((transferSize * count * 1000000ULL / 1024) / totalUs);
+}
+
+
+DBlockDeviceBenchmark::DBlockDeviceBenchmark(BlockDevice* bd, bd_addr_t address, bd_size_t size)
+    : m_bd(bd)
+    , m_address(address)
+    , m_size(size)
+    , m_iterations(DEFAULT_ITERATIONS)
+    , m_samples(NULL)
+    , m_buffer(NULL)
+    , m_bufferSize(0)
+    , m_random(0x2545F491)
+{
+    X_ASSERT(m_bd);
+}
+
+
+DBlockDeviceBenchmark::~DBlockDeviceBenchmark()
+{
+    D_SAFE_DELETE_ARRAY(m_samples);
+    D_SAFE_DELETE_ARRAY(m_buffer);
+}
+
+
+void DBlockDeviceBenchmark::setIterations(int iterations)
+{
+    X_ASSERT(iterations > 0);
+    if (iterations == m_iterations)
+        return;
+
+    D_SAFE_DELETE_ARRAY(m_samples);
+    m_iterations = iterations;
+}
+
+
+int DBlockDeviceBenchmark::measureRead(bd_size_t transferSize, bool random, Result* result)
+{
+    X_ASSERT(result);
+
+    if (!m_bd->is_valid_read(m_address, transferSize) || transferSize > m_size)
+        return -EINVAL;
+
+    Prepare(transferSize);
+    int err;
+
+    const bd_size_t slots = m_size / transferSize;
+    uint64_t totalUs = 0;
+    for (int i = 0; i < m_iterations; i++)
+    {
+        const bd_size_t slot = random ? Random() % slots : i % slots;
+        const bd_addr_t addr = m_address + slot * transferSize;
+
+        const uint32_t start = us_ticker_read();
+        err = m_bd->read(m_buffer, addr, transferSize);
+        const uint32_t elapsed = us_ticker_read() - start;
+        if (err)
+            return err;
+
+        m_samples[i] = elapsed;
+        totalUs += elapsed;
+    }
+
+    Summarize(transferSize, totalUs, result);
+
+    return BD_ERROR_OK;
+}
+
+
+int DBlockDeviceBenchmark::measureProgram(bd_size_t transferSize, Result* result)
+{
+    X_ASSERT(result);
+
+    const bd_size_t eraseSize = m_bd->get_erase_size();
+    const bd_addr_t begin = D__roundUp(m_address, eraseSize);
+    const bd_size_t blocks = (m_address + m_size > begin) ? (m_address + m_size - begin) / eraseSize : 0;
+    if (blocks == 0 || eraseSize % transferSize != 0 ||
+        !m_bd->is_valid_program(begin, transferSize))
+        return -EINVAL;
+
+    Prepare(transferSize);
+    int err;
+
+    const bd_size_t slots = blocks * (eraseSize / transferSize);
+    uint64_t totalUs = 0;
+    for (int i = 0; i < m_iterations; i++)
+    {
+        const bd_addr_t addr = begin + (i % slots) * transferSize;
+        if ((addr - begin) % eraseSize == 0)
+        {
+            err = DBlockDeviceUtils::eraseIfNotBlank(m_bd, addr, eraseSize);
+            if (err)
+                return err;
+        }
+
+        for (bd_size_t j = 0; j < transferSize; j++)
+            m_buffer[j] = static_cast<uint8_t>(Random());
+
+        const uint32_t start = us_ticker_read();
+        err = m_bd->program(m_buffer, addr, transferSize);
+        const uint32_t elapsed = us_ticker_read() - start;
+        if (err)
+            return err;
+
+        m_samples[i] = elapsed;
+        totalUs += elapsed;
+    }
+
+    Summarize(transferSize, totalUs, result);
+
+    return BD_ERROR_OK;
+}
+
+
+int DBlockDeviceBenchmark::measureErase(bd_size_t eraseSize, Result* result)
+{
+    X_ASSERT(result);
+
+    const bd_size_t programSize = m_bd->get_program_size();
+    const bd_addr_t begin = D__roundUp(m_address, eraseSize);
+    const bd_size_t blocks = (m_address + m_size > begin) ? (m_address + m_size - begin) / eraseSize : 0;
+    if (blocks == 0 || !m_bd->is_valid_erase(begin, eraseSize))
+        return -EINVAL;
+
+    Prepare(programSize);
+    int err;
+
+    ::memset(m_buffer, 0x00, programSize);
+    uint64_t totalUs = 0;
+    for (int i = 0; i < m_iterations; i++)
+    {
+        const bd_addr_t addr = begin + (i % blocks) * eraseSize;
+
+        bool blank;
+        err = DBlockDeviceUtils::isBlank(m_bd, addr, programSize, &blank);
+        if (!err && blank)
+            err = m_bd->program(m_buffer, addr, programSize);
+        if (err)
+            return err;
+
+        const uint32_t start = us_ticker_read();
+        err = m_bd->erase(addr, eraseSize);
+        const uint32_t elapsed = us_ticker_read() - start;
+        if (err)
+            return err;
+
+        m_samples[i] = elapsed;
+        totalUs += elapsed;
+    }
+
+    Summarize(eraseSize, totalUs, result);
+
+    return BD_ERROR_OK;
+}
+
+
+int DBlockDeviceBenchmark::runReadTests(DStream* out, bd_size_t maxTransferSize)
+{
+    X_ASSERT(out);
+
+    Result result;
+    const bd_size_t maxSize = d_min<bd_size_t>(maxTransferSize, m_size);
+    printHeader(out);
+    for (bd_size_t size = m_bd->get_read_size(); size <= maxSize; size *= 4)
+    {
+        int err = measureRead(size, false, &result);
+        if (err)
+            return err;
+        print(out, "read seq", result);
+
+        err = measureRead(size, true, &result);
+        if (err)
+            return err;
+        print(out, "read rand", result);
+    }
+
+    return BD_ERROR_OK;
+}
+
+
+int DBlockDeviceBenchmark::runProgramTests(DStream* out)
+{
+    X_ASSERT(out);
+
+    Result result;
+    const bd_size_t pageSize = D__roundUp(DEFAULT_PAGE_SIZE, m_bd->get_program_size());
+    const int err = measureProgram(pageSize, &result);
+    if (err)
+        return err;
+
+    printHeader(out);
+    print(out, "program", result);
+
+    return BD_ERROR_OK;
+}
+
+
+int DBlockDeviceBenchmark::runEraseTests(DStream* out)
+{
+    X_ASSERT(out);
+
+    Result result;
+    const bd_size_t maxSize = d_max<bd_size_t>(m_bd->get_erase_size(), 64 * 1024);
+    printHeader(out);
+    for (bd_size_t size = m_bd->get_erase_size(); size <= maxSize; size *= 2)
+    {
+        const int err = measureErase(size, &result);
+        if (err == -EINVAL)
+            break;
+        if (err)
+            return err;
+        print(out, "erase", result);
+    }
+
+    return BD_ERROR_OK;
+}
+
+
+void DBlockDeviceBenchmark::printHeader(DStream* out)
+{
+    out->printf("%-10s %8s %6s %8s %8s %8s %8s %8s\n",
+                "test", "size", "count", "min(us)", "p50(us)", "p99(us)", "max(us)", "KB/s");
+}
+
+
+void DBlockDeviceBenchmark::print(DStream* out, const char* label, const Result& result)
+{
+    out->printf("%-10s %8lu %6lu %8lu %8lu %8lu %8lu %8lu\n",
+                label,
+                static_cast<unsigned long>(result.transferSize),
+                static_cast<unsigned long>(result.count),
+                static_cast<unsigned long>(result.minUs),
+                static_cast<unsigned long>(result.p50Us),
+                static_cast<unsigned long>(result.p99Us),
+                static_cast<unsigned long>(result.maxUs),
+                static_cast<unsigned long>(result.kbytesPerSecond()));
+}
+
+
+void DBlockDeviceBenchmark::Prepare(bd_size_t bufferSize)
+{
+    if (!m_samples)
+    {
+        m_samples = D_NEW(uint32_t[m_iterations]);
+        X_ASSERT(m_samples);
+    }
+
+    if (bufferSize > m_bufferSize)
+    {
+        D_SAFE_DELETE_ARRAY(m_buffer);
+        m_buffer = D_NEW(uint8_t[bufferSize]);
+        X_ASSERT(m_buffer);
+        m_bufferSize = bufferSize;
+    }
+}
+
+
+void DBlockDeviceBenchmark::Summarize(bd_size_t transferSize, uint64_t totalUs, Result* result)
+{
+    const int n = m_iterations;
+    std::sort(m_samples, m_samples + n);
+
+    result->transferSize = transferSize;
+    result->count = n;
+    result->minUs = m_samples[0];
+    result->p50Us = m_samples[(n - 1) * 50 / 100];
+    result->p99Us = m_samples[(n - 1) * 99 / 100];
+    result->maxUs = m_samples[n - 1];
+    result->totalUs = totalUs;
+}
+
+
+uint32_t DBlockDeviceBenchmark::Random()
+{
+    /* xorshift32 */
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+
+    return m_random;
+}
@@ -0,0 +1,181 @@
+/**
+ *       @file  DBlockDeviceBenchmark.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DBlockDeviceBenchmark_hpp_
+#define dandy_DBlockDeviceBenchmark_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include <dandy/core/stream/DStream.hpp>
+
+
+/** BlockDeviceの読み出し、書き込み、消去の性能を測定します
+ *
+ *  フラッシュのベンダーやSPIクロックの比較、ストリームのキャッシュサイズの調整
+ *  などを実機の数値で行うためのものです。1回の操作ごとにus_ticker_read()で時間
+ *  を測り、最小、中央値、99パーセンタイル、最大を求めます。
+ *
+ *  書き込みと消去の測定はコンストラクタで指定した領域の内容を破壊します。読み出
+ *  しの測定は領域の内容を変更しません。
+ *
+ *  @code
+ *  DBlockDeviceBenchmark bench(&flash, 0x700000, 0x100000);
+ *  bench.runReadTests(stdOut, 4096);
+ *  bench.runProgramTests(stdOut);
+ *  bench.runEraseTests(stdOut);
+ *  @endcode
+ */
+class DBlockDeviceBenchmark
+{
+public:
+
+    /** 測定結果です
+     *
+     *  時間の単位はすべてマイクロ秒です。
+     */
+    struct Result
+    {
+        bd_size_t transferSize;
+        uint32_t count;
+        uint32_t minUs;
+        uint32_t p50Us;
+        uint32_t p99Us;
+        uint32_t maxUs;
+        uint64_t totalUs;
+
+        /** 1秒あたりのKB数を返します
+         */
+        uint32_t kbytesPerSecond() const;
+    };
+
+
+    /** 既定の測定回数です
+     */
+    static const int DEFAULT_ITERATIONS = 64;
+
+
+    /** 既定の書き込み単位です
+     *
+     *  SPI NORフラッシュの一般的なページサイズです。
+     */
+    static const bd_size_t DEFAULT_PAGE_SIZE = 256;
+
+
+    /** [address, address + size)の領域を使用して測定を行います
+     */
+    DBlockDeviceBenchmark(BlockDevice* bd, bd_addr_t address, bd_size_t size);
+    ~DBlockDeviceBenchmark();
+
+
+    /** 1つの測定で操作を繰り返す回数を設定します
+     *
+     *  測定結果の計算用に4 * iterationsバイトの動的メモリ確保を行います。
+     */
+    void setIterations(int iterations);
+
+
+    /** transferSizeバイトずつの読み出しを測定します
+     *
+     *  randomがfalseの場合は領域の先頭から連続して、trueの場合はtransferSize境
+     *  界のランダムなアドレスから読み出します。
+     */
+    int measureRead(bd_size_t transferSize, bool random, Result* result);
+
+
+    /** transferSizeバイトずつの書き込みを測定します
+     *
+     *  消去ブロックの先頭に書き込む前に、測定時間に含めずにブロックを消去します。
+     */
+    int measureProgram(bd_size_t transferSize, Result* result);
+
+
+    /** eraseSizeバイトずつの消去を測定します
+     *
+     *  eraseSizeはget_erase_size()の倍数でなければなりません。消去済みの範囲を
+     *  省略するドライバでも測定できるように、消去する前に測定時間に含めずに先頭
+     *  を書き込んでおきます。
+     */
+    int measureErase(bd_size_t eraseSize, Result* result);
+
+
+    /** 連続読み出しとランダム読み出しを、get_read_size()からmaxTransferSizeまで
+     *  4倍ずつ転送サイズを変えて測定し、結果をoutに出力します
+     */
+    int runReadTests(DStream* out, bd_size_t maxTransferSize);
+
+
+    /** DEFAULT_PAGE_SIZE単位の書き込みを測定し、結果をoutに出力します
+     */
+    int runProgramTests(DStream* out);
+
+
+    /** get_erase_size()から64KBまで、2倍ずつ消去サイズを変えて測定し、結果を
+     *  outに出力します
+     */
+    int runEraseTests(DStream* out);
+
+
+    /** 測定結果の表の見出しを出力します
+     */
+    static void printHeader(DStream* out);
+
+
+    /** 測定結果を表の1行として出力します
+     */
+    static void print(DStream* out, const char* label, const Result& result);
+
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DBlockDeviceBenchmark);
+    void Prepare(bd_size_t bufferSize);
+    void Summarize(bd_size_t transferSize, uint64_t totalUs, Result* result);
+    uint32_t Random();
+
+    BlockDevice* m_bd;
+    bd_addr_t m_address;
+    bd_size_t m_size;
+    int m_iterations;
+    uint32_t* m_samples;
+    uint8_t* m_buffer;
+    bd_size_t m_bufferSize;
+    uint32_t m_random;
+};
+
+
+#endif /* end of include guard: dandy_DBlockDeviceBenchmark_hpp_ */
@@ -38,9 +38,238 @@
 
 
 #include <dandy/core/utils/DBlockDeviceUtils.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+#include <dandy/core/memory/DArena.hpp>
 #include <EASTL/unique_ptr.h>
 
 
+#define D__PATCH_MAGIC          "DPT1"
+#define D__PATCH_MAGIC_SIZE     (4)
+#define D__PATCH_CHUNK_SIZE     (256)
+#define D__COPY_CHUNK_SIZE      (256)
+#define D__BLANK_CHECK_CHUNK_SIZE (256)
+
+
+typedef MbedCRC<POLY_32BIT_ANSI, 32> D__CopyCrc;
+
+
+/* 差分の適用結果をプログラムサイズ単位にまとめて書き込む */
+struct D__PatchWriter
+{
+    BlockDevice* bd;
+    bd_addr_t address;
+    bd_size_t eraseSize;
+    bd_size_t pos;          /* 書き込み済みのサイズ */
+    bd_size_t erasedEnd;    /* 消去済みの範囲の終端 */
+    uint8_t* buffer;
+    size_t bufferSize;
+    size_t filled;
+
+    int flush(bool final)
+    {
+        if (!filled)
+            return 0;
+
+        if (final)
+        {
+            /* 最後の書き込みはプログラムサイズに合わせて消去値で埋める */
+            const bd_size_t programSize = bd->get_program_size();
+            const int eraseValue = bd->get_erase_value();
+            while (filled % programSize)
+                buffer[filled++] = (eraseValue < 0) ? 0xFF : eraseValue;
+        }
+
+        while (erasedEnd < pos + filled)
+        {
+            const int result = DBlockDeviceUtils::eraseIfNotBlank(bd, address + erasedEnd, eraseSize);
+            if (result != 0)
+                return result;
+            erasedEnd += eraseSize;
+        }
+
+        const int result = bd->program(buffer, address + pos, filled);
+        if (result != 0)
+            return result;
+
+        pos += filled;
+        filled = 0;
+
+        return 0;
+    }
+
+    int write(const uint8_t* src, size_t size)
+    {
+        while (size)
+        {
+            const size_t n = d_min<size_t>(size, bufferSize - filled);
+            memcpy(buffer + filled, src, n);
+            filled += n;
+            src += n;
+            size -= n;
+
+            if (filled == bufferSize)
+            {
+                const int result = this->flush(false);
+                if (result != 0)
+                    return result;
+            }
+        }
+
+        return 0;
+    }
+};
+
+
+static int D__readPatch(DStream* patch, void* dst, size_t size)
+{
+    uint8_t* p = static_cast<uint8_t*>(dst);
+    while (size)
+    {
+        const ssize_t n = patch->read(p, size);
+        if (n < 0)
+            return n;
+        if (n == 0)
+            return -EINVAL;
+        p += n;
+        size -= n;
+    }
+
+    return 0;
+}
+
+
+static int D__readVarint(DStream* patch, uint64_t* value)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t b;
+        const int result = D__readPatch(patch, &b, 1);
+        if (result != 0)
+            return result;
+
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80))
+        {
+            *value = v;
+            return 0;
+        }
+    }
+
+    return -EINVAL;
+}
+
+
+bool DBlockDeviceUtils::isFilled(const void* src, size_t size, uint8_t value)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(src);
+
+    /* 先頭の4バイト境界までと末尾はバイト単位、それ以外はワード単位で比較する */
+    while (size && (reinterpret_cast<uintptr_t>(p) % sizeof(uint32_t)))
+    {
+        if (*p++ != value)
+            return false;
+        size--;
+    }
+
+    const uint32_t word = value * 0x01010101UL;
+    const uint32_t* w = reinterpret_cast<const uint32_t*>(p);
+    for (; size >= sizeof(uint32_t) * 4; size -= sizeof(uint32_t) * 4, w += 4)
+    {
+        if ((w[0] != word) | (w[1] != word) | (w[2] != word) | (w[3] != word))
+            return false;
+    }
+    for (; size >= sizeof(uint32_t); size -= sizeof(uint32_t))
+    {
+        if (*w++ != word)
+            return false;
+    }
+
+    p = reinterpret_cast<const uint8_t*>(w);
+    while (size--)
+    {
+        if (*p++ != value)
+            return false;
+    }
+
+    return true;
+}
+
+
+int DBlockDeviceUtils::isBlank(BlockDevice* bd, bd_addr_t addr, bd_size_t size, bool* blank)
+{
+    X_ASSERT(bd);
+    X_ASSERT(blank);
+
+    *blank = false;
+    const int eraseValue = bd->get_erase_value();
+    if (eraseValue < 0)
+        return 0;
+
+    /* ワード単位で比較できるようにuint32_tで確保する */
+    uint32_t chunk[D__BLANK_CHECK_CHUNK_SIZE / sizeof(uint32_t)];
+    const bd_size_t readSize = bd->get_read_size();
+    X_ASSERT(readSize <= sizeof(chunk));
+    const bd_size_t chunkSize = sizeof(chunk) - (sizeof(chunk) % readSize);
+
+    while (size)
+    {
+        const bd_size_t n = d_min<bd_size_t>(size, chunkSize);
+        const int result = bd->read(chunk, addr, n);
+        if (result != 0)
+            return result;
+        if (!DBlockDeviceUtils::isFilled(chunk, n, eraseValue))
+            return 0;
+
+        addr += n;
+        size -= n;
+    }
+
+    *blank = true;
+    return 0;
+}
+
+
+int DBlockDeviceUtils::eraseIfNotBlank(BlockDevice* bd, bd_addr_t addr, bd_size_t size)
+{
+    X_ASSERT(bd);
+
+    const bd_size_t eraseSize = bd->get_erase_size();
+    X_ASSERT((addr % eraseSize) == 0);
+    X_ASSERT((size % eraseSize) == 0);
+
+    /* 消去が必要なブロックの連続した範囲[runBegin, offset)をまとめて消去する */
+    bd_size_t runBegin = 0;
+    bool inRun = false;
+    for (bd_size_t offset = 0; offset <= size; offset += eraseSize)
+    {
+        bool blank = true;
+        int result;
+        if (offset < size)
+        {
+            result = DBlockDeviceUtils::isBlank(bd, addr + offset, eraseSize, &blank);
+            if (result != 0)
+                return result;
+        }
+
+        if (!blank && !inRun)
+        {
+            runBegin = offset;
+            inRun = true;
+        }
+        else if (blank && inRun)
+        {
+            result = bd->erase(addr + runBegin, offset - runBegin);
+            if (result != 0)
+                return result;
+            inRun = false;
+        }
+    }
+
+    return 0;
+}
+
+
 int DBlockDeviceUtils::replace(BlockDevice* bd, const void* src, bd_addr_t addr, bd_size_t size)
 {
     X_ASSERT(bd);
@@ -56,7 +285,8 @@ int DBlockDeviceUtils::replace(BlockDevice* bd, const void* src, bd_addr_t addr,
     const bd_size_t offset = addr % erase_size;
     addr = addr - offset;
 
-    eastl::unique_ptr<char[]> bufferUniquePtr(D_NEW(char[erase_size]));
+    eastl::unique_ptr<char[], DArenaScopedDeleter> bufferUniquePtr(
+        static_cast<char*>(DArena::scopedAllocate(erase_size)));
     X_ASSERT(bufferUniquePtr);
 
     char* buffer = bufferUniquePtr.get();
@@ -75,11 +305,14 @@ int DBlockDeviceUtils::replace(BlockDevice* bd, const void* src, bd_addr_t addr,
     else
         toWrite = erase_size - offset;
 
-    /* 消去して */
-    result = bd->erase(addr, erase_size);
-
-    if (result != 0)
-        return result;
+    /* 消去して(消去済みなら省略) */
+    const int erase_value = bd->get_erase_value();
+    if ((erase_value < 0) || !DBlockDeviceUtils::isFilled(buffer, erase_size, erase_value))
+    {
+        result = bd->erase(addr, erase_size);
+        if (result != 0)
+            return result;
+    }
 
     /* 新しいデータに置き換えて */
     memcpy(buffer + offset, p, toWrite);
@@ -104,24 +337,35 @@ int DBlockDeviceUtils::replace(BlockDevice* bd, const void* src, bd_addr_t addr,
     for (;;)
     {
         toWrite = (erase_size > size) ? size : erase_size;
-        if (erase_size > toWrite)
+        if (toWrite == erase_size)
         {
+            /* ブロック全体を置き換えるので、元のデータは読み出さない */
+            result = DBlockDeviceUtils::eraseIfNotBlank(bd, addr, erase_size);
+            if (result != 0)
+                return result;
+
             pp = p;
         }
         else
         {
+            /* 末尾の一部だけを置き換えるブロックは、残りのデータを保持するため
+             * に読み出して、新しいデータで上書きする前に消去済みかを判定する */
             result = bd->read(buffer, addr, erase_size);
             if (result != 0)
                 return result;
+
+            if ((erase_value < 0) || !DBlockDeviceUtils::isFilled(buffer, erase_size, erase_value))
+            {
+                result = bd->erase(addr, erase_size);
+                if (result != 0)
+                    return result;
+            }
+
             memcpy(buffer, p, toWrite);
             pp = buffer;
         }
 
-        result = bd->erase(addr, erase_size);
-        if (result != 0)
-            return result;
-
-        result = bd->program(pp, addr, toWrite);
+        result = bd->program(pp, addr, (pp == buffer) ? erase_size : toWrite);
         if (result != 0)
             return result;
 
@@ -136,3 +380,274 @@ int DBlockDeviceUtils::replace(BlockDevice* bd, const void* src, bd_addr_t addr,
 
     return result;
 }
+
+
+/* コピー先の範囲がコピー元と同じかどうかと、消去済みかどうかを調べる */
+static int D__compareRange(BlockDevice* srcBd, bd_addr_t srcAddr,
+                           BlockDevice* dstBd, bd_addr_t dstAddr,
+                           bd_size_t size, uint8_t* srcChunk, uint8_t* dstChunk, size_t chunkSize,
+                           bool* identical, bool* blank)
+{
+    const int eraseValue = dstBd->get_erase_value();
+    *identical = true;
+    *blank = (eraseValue >= 0);
+
+    for (bd_size_t offset = 0; offset < size; offset += chunkSize)
+    {
+        const bd_size_t n = d_min<bd_size_t>(size - offset, chunkSize);
+        int result = dstBd->read(dstChunk, dstAddr + offset, n);
+        if (result != 0)
+            return result;
+
+        if (*blank && !DBlockDeviceUtils::isFilled(dstChunk, n, eraseValue))
+            *blank = false;
+
+        if (*identical)
+        {
+            result = srcBd->read(srcChunk, srcAddr + offset, n);
+            if (result != 0)
+                return result;
+            if (memcmp(srcChunk, dstChunk, n) != 0)
+                *identical = false;
+        }
+
+        if (!*identical && !*blank)
+            break;
+    }
+
+    return 0;
+}
+
+
+/* 消去済みの範囲にコピー元のデータを書き込み、必要なら読み返して検証する */
+static int D__programRange(BlockDevice* srcBd, bd_addr_t srcAddr,
+                           BlockDevice* dstBd, bd_addr_t dstAddr,
+                           bd_size_t size, uint8_t* srcChunk, uint8_t* dstChunk, size_t chunkSize,
+                           bool verify)
+{
+    D__CopyCrc ct;
+    uint32_t srcCrc;
+    int result;
+
+    ct.compute_partial_start(&srcCrc);
+    for (bd_size_t offset = 0; offset < size; offset += chunkSize)
+    {
+        const bd_size_t n = d_min<bd_size_t>(size - offset, chunkSize);
+        if ((result = srcBd->read(srcChunk, srcAddr + offset, n)) != 0)
+            return result;
+        if ((result = dstBd->program(srcChunk, dstAddr + offset, n)) != 0)
+            return result;
+        if (verify)
+            ct.compute_partial(srcChunk, n, &srcCrc);
+    }
+    ct.compute_partial_stop(&srcCrc);
+
+    if (!verify)
+        return 0;
+
+    uint32_t dstCrc;
+    ct.compute_partial_start(&dstCrc);
+    for (bd_size_t offset = 0; offset < size; offset += chunkSize)
+    {
+        const bd_size_t n = d_min<bd_size_t>(size - offset, chunkSize);
+        if ((result = dstBd->read(dstChunk, dstAddr + offset, n)) != 0)
+            return result;
+        ct.compute_partial(dstChunk, n, &dstCrc);
+    }
+    ct.compute_partial_stop(&dstCrc);
+
+    return (srcCrc == dstCrc) ? 0 : BD_ERROR_DEVICE_ERROR;
+}
+
+
+int DBlockDeviceUtils::copy(BlockDevice* srcBd, bd_addr_t srcAddr,
+                            BlockDevice* dstBd, bd_addr_t dstAddr,
+                            bd_size_t size, bool verify)
+{
+    X_ASSERT(srcBd);
+    X_ASSERT(dstBd);
+
+    const bd_size_t eraseSize = dstBd->get_erase_size();
+    if ((dstAddr % eraseSize) || (size % eraseSize))
+        return -EINVAL;
+    if ((srcBd == dstBd) && (srcAddr < dstAddr + size) && (dstAddr < srcAddr + size))
+        return -EINVAL;
+
+    /* 1回の読み書きのサイズは双方の読み出しサイズとコピー先のプログラムサイズ
+     * の倍数にする
+     */
+    bd_size_t unit = dstBd->get_program_size();
+    while ((unit % srcBd->get_read_size()) || (unit % dstBd->get_read_size()))
+        unit += dstBd->get_program_size();
+    const size_t chunkSize = ((D__COPY_CHUNK_SIZE + unit - 1) / unit) * unit;
+
+    eastl::unique_ptr<uint8_t[], DArenaScopedDeleter> bufferUniquePtr(
+        static_cast<uint8_t*>(DArena::scopedAllocate(chunkSize * 2)));
+    X_ASSERT(bufferUniquePtr);
+    uint8_t* const srcChunk = bufferUniquePtr.get();
+    uint8_t* const dstChunk = srcChunk + chunkSize;
+
+    /* 消去が必要なブロックの連続した範囲[eraseBegin, offset)と、書き込みが必要
+     * なブロックの連続した範囲[programBegin, offset)をそれぞれまとめて処理する。
+     * 消去の範囲は書き込みの範囲に含まれ、必ず先に終わる。
+     */
+    bd_size_t eraseBegin = 0;
+    bd_size_t programBegin = 0;
+    bool inEraseRun = false;
+    bool inProgramRun = false;
+    for (bd_size_t offset = 0; offset <= size; offset += eraseSize)
+    {
+        bool identical = true;
+        bool blank = false;
+        int result;
+        if (offset < size)
+        {
+            result = D__compareRange(srcBd, srcAddr + offset, dstBd, dstAddr + offset,
+                                     eraseSize, srcChunk, dstChunk, chunkSize, &identical, &blank);
+            if (result != 0)
+                return result;
+        }
+
+        const bool needsErase = !identical && !blank;
+        if (inEraseRun && !needsErase)
+        {
+            if ((result = dstBd->erase(dstAddr + eraseBegin, offset - eraseBegin)) != 0)
+                return result;
+            inEraseRun = false;
+        }
+
+        if (inProgramRun && identical)
+        {
+            result = D__programRange(srcBd, srcAddr + programBegin, dstBd, dstAddr + programBegin,
+                                     offset - programBegin, srcChunk, dstChunk, chunkSize, verify);
+            if (result != 0)
+                return result;
+            inProgramRun = false;
+        }
+
+        if (needsErase && !inEraseRun)
+        {
+            eraseBegin = offset;
+            inEraseRun = true;
+        }
+
+        if (!identical && !inProgramRun)
+        {
+            programBegin = offset;
+            inProgramRun = true;
+        }
+    }
+
+    return 0;
+}
+
+
+int DBlockDeviceUtils::applyPatch(DStream* patch,
+                                  BlockDevice* srcBd, bd_addr_t srcAddr, bd_size_t srcSize,
+                                  BlockDevice* dstBd, bd_addr_t dstAddr, bd_size_t dstSize,
+                                  bd_size_t* newSize)
+{
+    X_ASSERT(patch);
+    X_ASSERT(srcBd);
+    X_ASSERT(dstBd);
+
+    const bd_size_t eraseSize = dstBd->get_erase_size();
+    if ((dstAddr % eraseSize) || (dstSize % eraseSize))
+        return -EINVAL;
+    if ((srcBd == dstBd) && (srcAddr < dstAddr + dstSize) && (dstAddr < srcAddr + srcSize))
+        return -EINVAL;
+
+    char magic[D__PATCH_MAGIC_SIZE];
+    int result = D__readPatch(patch, magic, sizeof(magic));
+    if (result != 0)
+        return result;
+    if (memcmp(magic, D__PATCH_MAGIC, D__PATCH_MAGIC_SIZE) != 0)
+        return -EINVAL;
+
+    uint64_t targetSize;
+    result = D__readVarint(patch, &targetSize);
+    if (result != 0)
+        return result;
+    if (targetSize > dstSize)
+        return -ENOSPC;
+
+    /* 作業領域は差分データ、古いイメージ、書き込みバッファの3つ */
+    const bd_size_t programSize = dstBd->get_program_size();
+    const size_t writeBufferSize = ((D__PATCH_CHUNK_SIZE + programSize - 1) / programSize) * programSize;
+    eastl::unique_ptr<uint8_t[], DArenaScopedDeleter> bufferUniquePtr(
+        static_cast<uint8_t*>(DArena::scopedAllocate(D__PATCH_CHUNK_SIZE * 2 + writeBufferSize)));
+    X_ASSERT(bufferUniquePtr);
+
+    uint8_t* const chunk = bufferUniquePtr.get();
+    uint8_t* const old = chunk + D__PATCH_CHUNK_SIZE;
+
+    D__PatchWriter writer;
+    writer.bd = dstBd;
+    writer.address = dstAddr;
+    writer.eraseSize = eraseSize;
+    writer.pos = 0;
+    writer.erasedEnd = 0;
+    writer.buffer = old + D__PATCH_CHUNK_SIZE;
+    writer.bufferSize = writeBufferSize;
+    writer.filled = 0;
+
+    uint64_t written = 0;
+    int64_t oldPos = 0;
+    while (written < targetSize)
+    {
+        uint64_t diffLen, extraLen, zigzag;
+        if (((result = D__readVarint(patch, &diffLen)) != 0) ||
+            ((result = D__readVarint(patch, &extraLen)) != 0) ||
+            ((result = D__readVarint(patch, &zigzag)) != 0))
+            return result;
+
+        if ((diffLen > targetSize - written) || (extraLen > targetSize - written - diffLen))
+            return -EINVAL;
+
+        /* 差分データ: 古いイメージに加算する */
+        while (diffLen)
+        {
+            const size_t n = d_min<uint64_t>(diffLen, D__PATCH_CHUNK_SIZE);
+            if ((oldPos < 0) || (static_cast<uint64_t>(oldPos) + n > srcSize))
+                return -EINVAL;
+            if ((result = D__readPatch(patch, chunk, n)) != 0)
+                return result;
+            if ((result = srcBd->read(old, srcAddr + oldPos, n)) != 0)
+                return result;
+
+            for (size_t i = 0; i < n; i++)
+                chunk[i] += old[i];
+            if ((result = writer.write(chunk, n)) != 0)
+                return result;
+
+            oldPos += n;
+            diffLen -= n;
+            written += n;
+        }
+
+        /* 追加データ: そのまま出力する */
+        while (extraLen)
+        {
+            const size_t n = d_min<uint64_t>(extraLen, D__PATCH_CHUNK_SIZE);
+            if ((result = D__readPatch(patch, chunk, n)) != 0)
+                return result;
+            if ((result = writer.write(chunk, n)) != 0)
+                return result;
+
+            extraLen -= n;
+            written += n;
+        }
+
+        const int64_t seek = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        oldPos += seek;
+    }
+
+    result = writer.flush(true);
+    if (result != 0)
+        return result;
+
+    if (newSize)
+        *newSize = targetSize;
+
+    return 0;
+}
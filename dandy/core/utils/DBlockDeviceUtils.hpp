@@ -41,6 +41,7 @@
 
 
 #include <dandy/core/DCore.hpp>
+#include <dandy/core/stream/DStream.hpp>
 
 
 class DBlockDeviceUtils
@@ -53,6 +54,84 @@ public:
      *  を行います。
      */
     static int replace(BlockDevice* bd, const void* src, bd_addr_t addr, bd_size_t size);
+
+
+    /** メモリ上のデータがすべてvalueかどうかを返します
+     *
+     *  4バイト単位で比較するので、消去済みかどうかの判定などに使用できます。
+     */
+    static bool isFilled(const void* src, size_t size, uint8_t value);
+
+
+    /** 指定範囲が消去済みかどうかを調べます
+     *
+     *  範囲を数百バイトずつ読み出して、すべてbd->get_erase_value()であるかを調べ
+     *  ます。消去値が定義されていない(-1を返す)デバイスでは常にfalseになります。
+     *  NORフラッシュでは、4KBの読み出しは4KBの消去よりもずっと短時間で済みます。
+     */
+    static int isBlank(BlockDevice* bd, bd_addr_t addr, bd_size_t size, bool* blank);
+
+
+    /** 消去済みでない消去ブロックだけを消去します
+     *
+     *  addrとsizeはbd->get_erase_size()の倍数でなければなりません。消去が必要な
+     *  ブロックが連続している場合は、まとめて1回のerase()で消去します。
+     */
+    static int eraseIfNotBlank(BlockDevice* bd, bd_addr_t addr, bd_size_t size);
+
+
+    /** ブロックデバイス間で領域をコピーします
+     *
+     *  コピー先の消去ブロックごとにコピー元と比較し、内容が同じブロックは消去も
+     *  書き込みも行いません。消去済みのブロックは消去せずに書き込みます。内容が
+     *  異なるブロックが連続している場合は、まとめて1回のerase()で消去するので、
+     *  ドライバがより大きな消去コマンドを選択できます。
+     *
+     *  verifyがtrueの場合、書き込んだ範囲を読み返してCRC32を比較し、一致しなけれ
+     *  ばBD_ERROR_DEVICE_ERRORを返します。
+     *
+     *  dstAddrとsizeはコピー先の消去サイズの倍数でなければなりません。同じデバイ
+     *  ス内で範囲が重なっている場合は-EINVALを返します。作業用に数百バイトの動的
+     *  メモリ確保を行います。
+     */
+    static int copy(BlockDevice* srcBd, bd_addr_t srcAddr,
+                    BlockDevice* dstBd, bd_addr_t dstAddr,
+                    bd_size_t size, bool verify = false);
+
+
+    /** 差分データを適用して新しいイメージを作成します
+     *
+     *  srcBdの古いイメージとpatchから読み出した差分から新しいイメージを作り、
+     *  dstBdに書き込みます。patchは先頭から1回読むだけで、作業用に数百バイトの
+     *  動的メモリ確保を行います。
+     *
+     *  差分の形式はbsdiffと同様で、古いイメージとの差を取ったデータと、追加データ
+     *  の組を並べたものです。数値はすべてLEB128形式の可変長整数です。
+     *
+     *  @code
+     *  "DPT1"                  マジック(4バイト)
+     *  newSize                 新しいイメージのサイズ
+     *  以下を新しいイメージのサイズに達するまで繰り返す
+     *      diffLen             差分データのバイト数
+     *      extraLen            追加データのバイト数
+     *      seek                diffLen後の古いイメージの読み出し位置の移動量
+     *                          (ZigZag符号化した符号付き整数)
+     *      diff[diffLen]       古いイメージの読み出し位置のデータに加算する値
+     *      extra[extraLen]     そのまま出力するデータ
+     *  @endcode
+     *
+     *  dstAddrとdstSizeは消去サイズの倍数でなければなりません。dstBdは書き込む直
+     *  前に消去ブロック単位で消去されます。古いイメージと新しいイメージの領域が重
+     *  なっていてはいけません。
+     *
+     *  成功した場合は0を返し、newSizeに新しいイメージのサイズを格納します。差分
+     *  データが壊れている場合は-EINVALを、新しいイメージがdstSizeに収まらない場合
+     *  は-ENOSPCを返します。
+     */
+    static int applyPatch(DStream* patch,
+                          BlockDevice* srcBd, bd_addr_t srcAddr, bd_size_t srcSize,
+                          BlockDevice* dstBd, bd_addr_t dstAddr, bd_size_t dstSize,
+                          bd_size_t* newSize = NULL);
 };
 
 
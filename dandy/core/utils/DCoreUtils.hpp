@@ -110,4 +110,75 @@ static inline bool d_is_null(float f)
     return (val.u & 0x7fffffff) == 0;
 }
 
+
+/** FNV-1aハッシュの初期値です
+ */
+static const uint32_t D_FNV1A_OFFSET_BASIS = 2166136261U;
+
+
+/** FNV-1aハッシュの乗数です
+ */
+static const uint32_t D_FNV1A_PRIME = 16777619U;
+
+
+/** data[0, len)のFNV-1aハッシュ値を返します
+ */
+inline uint32_t d_fnv1a(const void* data, size_t len)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t hash = D_FNV1A_OFFSET_BASIS;
+    while (len--)
+        hash = (hash ^ *p++) * D_FNV1A_PRIME;
+    return hash;
+}
+
+
+/// @cond IGNORE
+namespace dandy_detail {
+    inline constexpr uint32_t fnv1a_step(const char* str, uint32_t hash)
+    {
+        return *str ? fnv1a_step(str + 1, (hash ^ static_cast<uint8_t>(*str)) * D_FNV1A_PRIME) : hash;
+    }
+
+    template <uint32_t Value>
+    struct hash_constant
+    {
+        static const uint32_t value = Value;
+    };
+}
+/// @endcond IGNORE
+
+
+/** ヌル終端文字列のFNV-1aハッシュ値を返します
+ *
+ *  d_fnv1a(str, strlen(str))と同じ値です。C++11以降ではconstexprなので、文字
+ *  列リテラルのハッシュ値はD_HASH_LITERAL()でコンパイル時に計算できます。
+ */
+#if defined(EA_COMPILER_NO_CONSTEXPR)
+inline uint32_t d_fnv1a(const char* str)
+{
+    uint32_t hash = D_FNV1A_OFFSET_BASIS;
+    while (*str)
+        hash = (hash ^ static_cast<uint8_t>(*str++)) * D_FNV1A_PRIME;
+    return hash;
+}
+#else
+inline constexpr uint32_t d_fnv1a(const char* str)
+{
+    return dandy_detail::fnv1a_step(str, D_FNV1A_OFFSET_BASIS);
+}
+#endif
+
+
+/** 文字列リテラルのFNV-1aハッシュ値を、コンパイル時に計算した定数として返します
+ *
+ *  constexprが使えないコンパイラでは、実行時にd_fnv1a()を呼び出します。
+ */
+#if defined(EA_COMPILER_NO_CONSTEXPR)
+    #define D_HASH_LITERAL(str) d_fnv1a(str)
+#else
+    #define D_HASH_LITERAL(str) (dandy_detail::hash_constant<d_fnv1a(str)>::value)
+#endif
+
+
 #endif /* end of include guard: dandy_DCoreUtils_hpp_ */
@@ -38,6 +38,7 @@
 
 
 #include <dandy/core/utils/DStringUtils.hpp>
+#include <dandy/core/memory/DArena.hpp>
 
 
 namespace {
@@ -49,6 +50,15 @@ namespace {
         return 255;
     }
     const char D__HexMap[] = "0123456789ABCDEF";
+
+    inline void D__BytesToHex(const uint8_t* p, size_t len, char* dst)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            *dst++ = D__HexMap[(p[i] >> 4) & 0x0F];
+            *dst++ = D__HexMap[(p[i]) & 0x0F];
+        }
+    }
 }
 
 
@@ -64,23 +74,29 @@ std::string DStringUtils::format(const char* fmt, ...)
 
 std::string DStringUtils::vformat(const char* fmt, va_list args)
 {
+    DFixedString<D_STRING_UTILS_FORMAT_BUFFER_SIZE> str;
+
     va_list args2;
     va_copy(args2, args);
-
-    const int len = x_vsnprintf(NULL, 0, fmt, args2);
+    const int len = str.vformat(fmt, args2);
     va_end(args2);
 
     if (len < 0)
         return std::string("");
 
-    char* buffer = D_NEW(char[len + 1]);
+    if (! str.overflowed())
+        return std::string(str.c_str(), str.size());
+
+    /* 長さはわかっているので、作業バッファをアリーナに確保して書式化しなおし
+     * ます */
+    char* buffer = static_cast<char*>(DArena::scopedAllocate(len + 1));
     X_ASSERT(buffer);
 
     x_vsnprintf(buffer, len + 1, fmt, args);
 
-    const std::string result(buffer);
+    const std::string result(buffer, len);
 
-    D_DELETE_ARRAY(buffer);
+    DArena::scopedDeallocate(buffer);
 
     return result;
 }
@@ -88,37 +104,67 @@ std::string DStringUtils::vformat(const char* fmt, va_list args)
 
 std::string DStringUtils::bytesToHex(const void* bytes, size_t len)
 {
-    if (len == 0)
-        return std::string();
-
-    char* buffer = D_NEW(char[len * 2 + 1]);
-    X_ASSERT(buffer);
+    std::string result(len * 2, '\0');
+    if (len)
+        D__BytesToHex(static_cast<const uint8_t*>(bytes), len, &result[0]);
 
-    const uint8_t* p = static_cast<const uint8_t*>(bytes);
-    size_t j = 0;
-    for (size_t i = 0; i < len; i++)
-    {
-        buffer[j++] = D__HexMap[(p[i] >> 4) & 0x0F];
-        buffer[j++] = D__HexMap[(p[i]) & 0x0F];
-    }
-    buffer[j] = '\0';
+    return result;
+}
 
-    const std::string result(buffer);
 
-    D_DELETE_ARRAY(buffer);
+bool DStringUtils::format(DFixedStringBase* dst, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    const bool result = DStringUtils::vformat(dst, fmt, args);
+    va_end(args);
 
     return result;
 }
 
 
-void* DStringUtils::hexToBytes(const char* hex, void* dst)
+bool DStringUtils::vformat(DFixedStringBase* dst, const char* fmt, va_list args)
+{
+    X_ASSERT(dst);
+
+    const int len = dst->vformat(fmt, args);
+    return (len >= 0) && (! dst->overflowed());
+}
+
+
+bool DStringUtils::bytesToHex(DFixedStringBase* dst, const void* bytes, size_t len)
+{
+    X_ASSERT(dst);
+
+    const size_t n = d_min(len, dst->capacity() / 2);
+    D__BytesToHex(static_cast<const uint8_t*>(bytes), n, dst->data());
+    dst->data()[n * 2] = '\0';
+    dst->updateLength(n != len);
+
+    return n == len;
+}
+
+
+char* DStringUtils::bytesToHex(const void* bytes, size_t len, char* dst)
+{
+    X_ASSERT(dst);
+
+    D__BytesToHex(static_cast<const uint8_t*>(bytes), len, dst);
+    dst[len * 2] = '\0';
+
+    return dst;
+}
+
+
+void* DStringUtils::hexToBytes(const DStringView& hex, void* dst)
 {
-    const size_t len = ::strlen(hex) / 2;
+    const size_t len = hex.size() / 2;
+    const char* src = hex.data();
     uint8_t* p = static_cast<uint8_t*>(dst);
     for (size_t i = 0; i < len; i++)
     {
-        p[i] = D__NibbleFromChar(hex[0]) << 4 | D__NibbleFromChar(hex[1]);
-        hex += 2;
+        p[i] = D__NibbleFromChar(src[0]) << 4 | D__NibbleFromChar(src[1]);
+        src += 2;
     }
 
     return dst;
@@ -42,16 +42,45 @@
 
 
 #include <dandy/core/DCore.hpp>
+#include <dandy/core/DFixedString.hpp>
 #include <string>
 
 
+#ifndef D_STRING_UTILS_FORMAT_BUFFER_SIZE
+    /* format()がstd::stringを返す際に、最初にスタック上で書式化するバッファの
+     * サイズです。これより長い場合はアリーナに作業バッファを確保します */
+    #define D_STRING_UTILS_FORMAT_BUFFER_SIZE    (64)
+#endif
+
+
 class DStringUtils
 {
 public:
     static std::string format(const char* fmt, ...) X_PRINTF_ATTR(1, 2);
     static std::string vformat(const char* fmt, va_list args);
     static std::string bytesToHex(const void* bytes, size_t len);
-    static void* hexToBytes(const char* hex, void* dst);
+    static void* hexToBytes(const DStringView& hex, void* dst);
+
+    /** dstに書式化した文字列を設定します。動的メモリ確保は行いません
+     *
+     *  @return 切り詰めずにdstに収まった場合はtrue
+     */
+    static bool format(DFixedStringBase* dst, const char* fmt, ...) X_PRINTF_ATTR(2, 3);
+    static bool vformat(DFixedStringBase* dst, const char* fmt, va_list args);
+
+    /** dstにbytesの16進表記を設定します。動的メモリ確保は行いません
+     *
+     *  @return 切り詰めずにdstに収まった場合はtrue
+     */
+    static bool bytesToHex(DFixedStringBase* dst, const void* bytes, size_t len);
+
+    /** dstにbytesのヌル終端した16進表記を書き込みます
+     *
+     *  dstにはlen * 2 + 1バイトの領域が必要です。
+     *
+     *  @return dst
+     */
+    static char* bytesToHex(const void* bytes, size_t len, char* dst);
 };
 
 
@@ -57,6 +57,24 @@ public:
     {
         DTimeUtils::waitMicroSecondsByBusyLoop(ms * 1000);
     }
+
+    /** 他のスレッドにCPUを譲りながら待ちます
+     *
+     *  1ms未満の待ち時間ではスレッドを切り替えるだけですぐに戻るので、ポーリン
+     *  グのループの中で使うことを想定しています。RTOSがない場合はビジーループで
+     *  待ちます。
+     */
+    static void sleepMicroSeconds(uint32_t us)
+    {
+#ifdef MBED_CONF_RTOS_PRESENT
+        if (us >= 1000)
+            rtos::Thread::wait(us / 1000);
+        else
+            rtos::Thread::yield();
+#else
+        DTimeUtils::waitMicroSecondsByBusyLoop(us);
+#endif
+    }
 };
 
 #endif /* end of include guard: dandy_TimeUtils_hpp_ */
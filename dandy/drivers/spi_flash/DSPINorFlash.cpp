@@ -0,0 +1,603 @@
+/**
+ *       @file  DSPINorFlash.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/drivers/spi_flash/DSPINorFlash.hpp>
+#include <dandy/core/utils/DBlockDeviceUtils.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+#include <dandy/core/utils/DTimeUtils.hpp>
+
+
+#define D__CMD_WRSR             (0x01) /* Write Status Register */
+#define D__CMD_WRDI             (0x04) /* Write Disable */
+#define D__CMD_RDSR             (0x05) /* Read Status Register */
+#define D__CMD_WREN             (0x06) /* Write Enable */
+#define D__CMD_PP               (0x02) /* Page Program */
+#define D__CMD_FAST_READ        (0x0B) /* Fast Read */
+#define D__CMD_SFDP             (0x5A) /* Read SFDP */
+#define D__CMD_ULBPR            (0x98) /* Global Block Protection Unlock (SST26) */
+#define D__CMD_JEDEC_ID         (0x9F) /* Read JEDEC ID */
+#define D__CMD_EN4B             (0xB7) /* Enter 4-byte Address Mode */
+
+#define D__SR_BIT_BUSY          (1UL << 0)
+#define D__SR_BIT_WEL           (1UL << 1)
+
+#define D__SFDP_SIGNATURE       (0x50444653UL) /* "SFDP" */
+#define D__SFDP_ID_BASIC        (0xFF00)
+#define D__SFDP_ID_SECTOR_MAP   (0xFF81)
+#define D__SFDP_BASIC_DWORDS    (11)
+
+#define D__MANUFACTURER_SST     (0xBF)
+
+/* SFDPに標準時間がない場合に使用する値 */
+#define D__DEFAULT_PAGE_SIZE    (256)
+#define D__DEFAULT_PROGRAM_US   (1000)
+#define D__DEFAULT_ERASE_US     (50000)
+
+/* 完了待ちのポーリング間隔は、操作の標準時間をこの値で割った時間にする */
+#define D__POLL_DIVISOR         (8)
+
+
+static uint32_t D__LoadLE32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0])      ) |
+           (static_cast<uint32_t>(p[1]) <<  8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+
+DSPINorFlash::DSPINorFlash(PinName mosi, PinName miso, PinName sclk, PinName cs, int frequency)
+    : m_spi(mosi, miso, sclk)
+    , m_cs(cs)
+    , m_memorySize(0)
+    , m_pageSize(D__DEFAULT_PAGE_SIZE)
+    , m_eraseSize(0)
+    , m_programTypicalUs(D__DEFAULT_PROGRAM_US)
+    , m_addressBytes(3)
+    , m_blankCheckEnabled(false)
+    , m_regionCount(0)
+{
+    ::memset(m_jedecId, 0, sizeof(m_jedecId));
+    ::memset(m_eraseTypes, 0, sizeof(m_eraseTypes));
+    this->SPICSHigh();
+    m_spi.frequency(frequency);
+}
+
+DSPINorFlash::~DSPINorFlash()
+{
+    this->deinit();
+}
+
+int DSPINorFlash::init()
+{
+    m_mutex.lock();
+
+    m_memorySize = 0;
+    m_eraseSize = 0;
+    this->DoCommandNoAddress(D__CMD_JEDEC_ID, NULL, 0, m_jedecId, sizeof(m_jedecId));
+
+    int result = BD_ERROR_DEVICE_ERROR;
+    uint8_t header[8];
+    this->ReadSFDP(0, header, sizeof(header));
+    if (D__LoadLE32(header) != D__SFDP_SIGNATURE)
+    {
+        X_LOG_WARN(("DSPINorFlash", "SFDP not supported {%02X,%02X,%02X}",
+                    m_jedecId[0], m_jedecId[1], m_jedecId[2]));
+        m_mutex.unlock();
+        return result;
+    }
+
+    /* パラメータヘッダは新しいリビジョンのテーブルが後ろに並ぶので、最後に見つ
+     * かったBasic Flash Parameter Tableを使用する。
+     */
+    const int headerCount = header[6] + 1;
+    uint32_t sectorMapAddress = 0;
+    size_t sectorMapDwords = 0;
+    for (int i = 0; i < headerCount; i++)
+    {
+        uint8_t ph[8];
+        this->ReadSFDP(8 + i * 8, ph, sizeof(ph));
+
+        const uint16_t id = (ph[7] << 8) | ph[0];
+        const size_t dwords = ph[3];
+        const uint32_t address = ph[4] | (ph[5] << 8) | (ph[6] << 16);
+
+        if (id == D__SFDP_ID_BASIC)
+            result = this->ParseBasicParameterTable(address, dwords);
+        else if (id == D__SFDP_ID_SECTOR_MAP)
+        {
+            sectorMapAddress = address;
+            sectorMapDwords = dwords;
+        }
+    }
+
+    if (result == BD_ERROR_OK)
+    {
+        this->SetUniformRegion();
+        if (sectorMapDwords && (this->ParseSectorMapTable(sectorMapAddress, sectorMapDwords) != 0))
+        {
+            /* 領域ごとの消去コマンドが分からないので、どこでも使える最小の消去
+             * コマンドだけを使用する。
+             */
+            X_LOG_WARN(("DSPINorFlash", "unsupported sector map, fallback to minimum erase type"));
+            const int smallest = this->FindSmallestEraseType();
+            m_regionCount = 1;
+            m_regions[0].end = m_memorySize;
+            m_regions[0].typeMask = (smallest >= 0) ? (1U << smallest) : 0;
+        }
+
+        /* どの領域でも消去できる単位をeraseサイズにする */
+        for (int r = 0; r < m_regionCount; r++)
+        {
+            bd_size_t regionMin = 0;
+            for (int i = 0; i < MAX_ERASE_TYPES; i++)
+            {
+                if ((m_regions[r].typeMask & (1U << i)) &&
+                    (!regionMin || (m_eraseTypes[i].size < regionMin)))
+                    regionMin = m_eraseTypes[i].size;
+            }
+            m_eraseSize = d_max<bd_size_t>(m_eraseSize, regionMin);
+        }
+
+        /* 消去コマンドが1つもない */
+        if (!m_eraseSize)
+            result = BD_ERROR_DEVICE_ERROR;
+    }
+
+    if (result == BD_ERROR_OK)
+    {
+        /* パワーオンリセット後は書き込み保護されているので解除する */
+        if (m_jedecId[0] == D__MANUFACTURER_SST)
+        {
+            this->WriteEnable();
+            this->DoCommandNoAddress(D__CMD_ULBPR, NULL, 0, NULL, 0);
+            this->WaitForCommandCompletion(0);
+        }
+
+        if (m_addressBytes == 4)
+        {
+            this->WriteEnable();
+            this->DoCommandNoAddress(D__CMD_EN4B, NULL, 0, NULL, 0);
+        }
+    }
+    else
+    {
+        m_memorySize = 0;
+    }
+
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DSPINorFlash::deinit()
+{
+    m_mutex.lock();
+    this->DoCommandNoAddress(D__CMD_WRDI, NULL, 0, NULL, 0);
+    m_mutex.unlock();
+
+    return BD_ERROR_OK;
+}
+
+int DSPINorFlash::read(void* dst, bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(this->is_valid_read(address, size));
+
+    m_mutex.lock();
+    this->DoCommand(D__CMD_FAST_READ, address, 1, NULL, 0, dst, size);
+    m_mutex.unlock();
+
+    return BD_ERROR_OK;
+}
+
+int DSPINorFlash::program(const void* src, bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(this->is_valid_program(address, size));
+
+    const uint8_t* p = static_cast<const uint8_t*>(src);
+
+    m_mutex.lock();
+    while (size)
+    {
+        /* ページ境界を越えるとページの先頭に戻って書き込まれてしまうので、ペー
+         * ジ境界で分割する。
+         */
+        const bd_size_t pageRemaining = m_pageSize - (address % m_pageSize);
+        const bd_size_t toProgram = d_min<bd_size_t>(size, pageRemaining);
+
+        this->WriteEnable();
+        this->DoCommand(D__CMD_PP, address, 0, p, toProgram, NULL, 0);
+        this->WaitForCommandCompletion(m_programTypicalUs);
+
+        p += toProgram;
+        address += toProgram;
+        size -= toProgram;
+    }
+    m_mutex.unlock();
+
+    return BD_ERROR_OK;
+}
+
+int DSPINorFlash::erase(bd_addr_t address, bd_size_t size)
+{
+    X_ASSERT(this->is_valid_erase(address, size));
+
+    const bd_addr_t end = address + size;
+    int result = BD_ERROR_OK;
+
+    m_mutex.lock();
+    while (address < end)
+    {
+        const int type = this->FindEraseType(address, end);
+        if (type < 0)
+        {
+            result = BD_ERROR_DEVICE_ERROR;
+            break;
+        }
+
+        const EraseType& e = m_eraseTypes[type];
+        bool blank = false;
+        if (m_blankCheckEnabled)
+        {
+            result = DBlockDeviceUtils::isBlank(this, address, e.size, &blank);
+            if (result != 0)
+                break;
+        }
+        if (!blank)
+        {
+            this->WriteEnable();
+            this->DoCommand(e.opcode, address, 0, NULL, 0, NULL, 0);
+            this->WaitForCommandCompletion(e.typicalUs);
+        }
+        address += e.size;
+    }
+    m_mutex.unlock();
+
+    return result;
+}
+
+bd_size_t DSPINorFlash::get_read_size() const
+{
+    return 1;
+}
+
+bd_size_t DSPINorFlash::get_program_size() const
+{
+    return 1;
+}
+
+bd_size_t DSPINorFlash::get_erase_size() const
+{
+    return m_eraseSize;
+}
+
+int DSPINorFlash::get_erase_value() const
+{
+    return 0xFF;
+}
+
+bd_size_t DSPINorFlash::size() const
+{
+    return m_memorySize;
+}
+
+size_t DSPINorFlash::countEraseOperations(bd_addr_t address, bd_size_t size) const
+{
+    const bd_addr_t end = address + size;
+    size_t count = 0;
+
+    while (address < end)
+    {
+        const int type = this->FindEraseType(address, end);
+        if (type < 0)
+            return 0;
+
+        address += m_eraseTypes[type].size;
+        count++;
+    }
+
+    return count;
+}
+
+void DSPINorFlash::setBlankCheckEnabled(bool enabled)
+{
+    m_mutex.lock();
+    m_blankCheckEnabled = enabled;
+    m_mutex.unlock();
+}
+
+int DSPINorFlash::ReadSFDP(uint32_t address, void* dst, size_t size)
+{
+    /* SFDPの読み出しは常に3バイトアドレスと8クロックのダミーサイクルで行う */
+    const uint8_t preTx[5] = {
+        D__CMD_SFDP,
+        static_cast<uint8_t>((address >> 16) & 0xFF),
+        static_cast<uint8_t>((address >> 8)  & 0xFF),
+        static_cast<uint8_t>((address) & 0xFF),
+        0xFF
+    };
+
+    this->SPICSLow();
+    this->SPIExchange(preTx, sizeof(preTx), NULL, 0);
+    this->SPIExchange(NULL, 0, dst, size);
+    this->SPICSHigh();
+
+    return BD_ERROR_OK;
+}
+
+int DSPINorFlash::ParseBasicParameterTable(uint32_t address, size_t dwords)
+{
+    /* see [JESD216 6.4 JEDEC Basic Flash Parameter Table]
+     */
+    if (dwords < 9)
+        return BD_ERROR_DEVICE_ERROR;
+
+    uint8_t raw[D__SFDP_BASIC_DWORDS * 4];
+    const size_t toRead = d_min(dwords, static_cast<size_t>(D__SFDP_BASIC_DWORDS));
+    ::memset(raw, 0, sizeof(raw));
+    this->ReadSFDP(address, raw, toRead * 4);
+
+    uint32_t dw[D__SFDP_BASIC_DWORDS];
+    for (size_t i = 0; i < D__SFDP_BASIC_DWORDS; i++)
+        dw[i] = D__LoadLE32(&raw[i * 4]);
+
+    /* 2nd DWORD: 容量(bit単位) */
+    uint64_t bits;
+    if (dw[1] & 0x80000000UL)
+        bits = static_cast<uint64_t>(1) << (dw[1] & 0x7FFFFFFFUL);
+    else
+        bits = static_cast<uint64_t>(dw[1]) + 1;
+    m_memorySize = bits / 8;
+
+    /* 1st DWORD bit[18:17]: 00=3バイトのみ, 01=3or4バイト, 10=4バイトのみ */
+    const uint32_t addressMode = (dw[0] >> 17) & 0x03;
+    if ((addressMode == 0x02) || ((addressMode == 0x01) && (m_memorySize > (16UL * 1024 * 1024))))
+        m_addressBytes = 4;
+    else
+        m_addressBytes = 3;
+
+    /* 8th, 9th DWORD: 消去コマンドの種類。サイズは2のべき乗で、0は未対応 */
+    for (int i = 0; i < MAX_ERASE_TYPES; i++)
+    {
+        const uint32_t field = (dw[7 + i / 2] >> ((i % 2) * 16)) & 0xFFFF;
+        const uint8_t exponent = field & 0xFF;
+        EraseType& e = m_eraseTypes[i];
+        e.opcode = (field >> 8) & 0xFF;
+        e.size = exponent ? (static_cast<bd_size_t>(1) << exponent) : 0;
+        e.typicalUs = D__DEFAULT_ERASE_US;
+    }
+
+    /* 10th, 11th DWORDはJESD216Aから追加された */
+    if (dwords >= D__SFDP_BASIC_DWORDS)
+    {
+        /* 10th DWORD: 消去の標準時間 bit[4:0]=count, bit[6:5]=単位 */
+        static const uint32_t eraseUnits[] = { 1000, 16000, 128000, 1000000 };
+        for (int i = 0; i < MAX_ERASE_TYPES; i++)
+        {
+            const uint32_t field = (dw[9] >> (4 + 7 * i)) & 0x7F;
+            m_eraseTypes[i].typicalUs = ((field & 0x1F) + 1) * eraseUnits[(field >> 5) & 0x03];
+        }
+
+        /* 11th DWORD: bit[7:4]=ページサイズ(2^N), bit[13:8]=書き込みの標準時間 */
+        m_pageSize = static_cast<bd_size_t>(1) << ((dw[10] >> 4) & 0x0F);
+        const uint32_t field = (dw[10] >> 8) & 0x3F;
+        m_programTypicalUs = ((field & 0x1F) + 1) * ((field & 0x20) ? 64 : 8);
+    }
+
+    return BD_ERROR_OK;
+}
+
+int DSPINorFlash::ParseSectorMapTable(uint32_t address, size_t dwords)
+{
+    /* see [JESD216B 6.5 Sector Map Parameter Table]
+     * 構成検出コマンドがあるデバイスは、レジスタを読んで構成を判断する必要があ
+     * るので対応しない。構成が1つだけのデバイスはマップディスクリプタが1つだけ
+     * 並んでいる。
+     */
+    uint8_t raw[4];
+    this->ReadSFDP(address, raw, sizeof(raw));
+    const uint32_t descriptor = D__LoadLE32(raw);
+    if (!(descriptor & 0x02))
+        return BD_ERROR_DEVICE_ERROR;
+
+    const size_t regionCount = ((descriptor >> 16) & 0xFF) + 1;
+    if ((regionCount > MAX_REGIONS) || (regionCount + 1 > dwords))
+        return BD_ERROR_DEVICE_ERROR;
+
+    bd_addr_t end = 0;
+    for (size_t i = 0; i < regionCount; i++)
+    {
+        this->ReadSFDP(address + (i + 1) * 4, raw, sizeof(raw));
+        const uint32_t region = D__LoadLE32(raw);
+        end += (static_cast<bd_size_t>(region >> 8) + 1) * 256;
+        m_regions[i].end = end;
+        m_regions[i].typeMask = region & 0x0F;
+    }
+
+    if (end != m_memorySize)
+    {
+        this->SetUniformRegion();
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    m_regionCount = regionCount;
+
+    return BD_ERROR_OK;
+}
+
+void DSPINorFlash::SetUniformRegion()
+{
+    /* Sector Mapがない場合、領域ごとに使える消去コマンドは分からない。SST26の
+     * ように同じオペコードで領域ごとに消去サイズが変わるデバイスがあるので、オ
+     * ペコードが他の種類と重ならない消去コマンドだけを使用する。すべて重なる場
+     * 合は最小の消去コマンドだけを使用する。
+     */
+    uint8_t mask = 0;
+    for (int i = 0; i < MAX_ERASE_TYPES; i++)
+    {
+        if (!m_eraseTypes[i].size)
+            continue;
+
+        bool unique = true;
+        for (int j = 0; j < MAX_ERASE_TYPES; j++)
+        {
+            if ((j != i) && m_eraseTypes[j].size && (m_eraseTypes[j].opcode == m_eraseTypes[i].opcode))
+                unique = false;
+        }
+
+        if (unique)
+            mask |= 1U << i;
+    }
+
+    if (!mask)
+    {
+        const int smallest = this->FindSmallestEraseType();
+        if (smallest >= 0)
+            mask = 1U << smallest;
+    }
+
+    m_regionCount = 1;
+    m_regions[0].end = m_memorySize;
+    m_regions[0].typeMask = mask;
+}
+
+int DSPINorFlash::FindSmallestEraseType() const
+{
+    int smallest = -1;
+    for (int i = 0; i < MAX_ERASE_TYPES; i++)
+    {
+        if (m_eraseTypes[i].size &&
+            ((smallest < 0) || (m_eraseTypes[i].size < m_eraseTypes[smallest].size)))
+            smallest = i;
+    }
+
+    return smallest;
+}
+
+int DSPINorFlash::FindEraseType(bd_addr_t address, bd_addr_t end) const
+{
+    /* 消去サイズはすべて2のべき乗なので、アライメントが合い範囲をはみ出さない
+     * 最大の消去コマンドを貪欲に選べば、消去回数が最小になる。
+     */
+    int r = 0;
+    while ((r < m_regionCount) && (address >= m_regions[r].end))
+        r++;
+    if (r == m_regionCount)
+        return -1;
+
+    const bd_addr_t limit = d_min<bd_addr_t>(end, m_regions[r].end);
+    int best = -1;
+    for (int i = 0; i < MAX_ERASE_TYPES; i++)
+    {
+        const EraseType& e = m_eraseTypes[i];
+        if (!(m_regions[r].typeMask & (1U << i)) || !e.size)
+            continue;
+        if (((address % e.size) != 0) || (address + e.size > limit))
+            continue;
+        if ((best < 0) || (e.size > m_eraseTypes[best].size))
+            best = i;
+    }
+
+    return best;
+}
+
+void DSPINorFlash::DoCommand(uint8_t cmd, bd_addr_t address, int dummyBytes, const void* tx, int txSize, void* rx, int rxSize)
+{
+    uint8_t preTx[1 + 4 + 1];
+    int n = 0;
+    preTx[n++] = cmd;
+    if (m_addressBytes == 4)
+        preTx[n++] = static_cast<uint8_t>((address >> 24) & 0xFF);
+    preTx[n++] = static_cast<uint8_t>((address >> 16) & 0xFF);
+    preTx[n++] = static_cast<uint8_t>((address >> 8)  & 0xFF);
+    preTx[n++] = static_cast<uint8_t>((address) & 0xFF);
+    for (int i = 0; i < dummyBytes; i++)
+        preTx[n++] = 0xFF;
+
+    this->SPICSLow();
+    this->SPIExchange(preTx, n, NULL, 0);
+    if (tx || rx)
+        this->SPIExchange(tx, txSize, rx, rxSize);
+    this->SPICSHigh();
+}
+
+void DSPINorFlash::DoCommandNoAddress(uint8_t cmd, const void* tx, int txSize, void* rx, int rxSize)
+{
+    this->SPICSLow();
+    this->SPIExchange(&cmd, 1, NULL, 0);
+    if (tx || rx)
+        this->SPIExchange(tx, txSize, rx, rxSize);
+    this->SPICSHigh();
+}
+
+void DSPINorFlash::WriteEnable()
+{
+    this->DoCommandNoAddress(D__CMD_WREN, NULL, 0, NULL, 0);
+    X_ASSERT(this->ReadStatusRegister() & D__SR_BIT_WEL);
+}
+
+uint8_t DSPINorFlash::ReadStatusRegister()
+{
+    uint8_t statusRegister;
+    this->DoCommandNoAddress(D__CMD_RDSR, NULL, 0, &statusRegister, 1);
+
+    return statusRegister;
+}
+
+void DSPINorFlash::WaitForCommandCompletion(uint32_t typicalUs)
+{
+    const uint32_t interval = typicalUs / D__POLL_DIVISOR;
+    while (this->ReadStatusRegister() & D__SR_BIT_BUSY)
+        DTimeUtils::sleepMicroSeconds(interval);
+}
+
+void DSPINorFlash::SPICSHigh()
+{
+    m_cs.write(1);
+}
+
+void DSPINorFlash::SPICSLow()
+{
+    m_cs.write(0);
+}
+
+void DSPINorFlash::SPIExchange(const void* tx, int txSize, void* rx, int rxSize)
+{
+    m_spi.write((const char*)tx, txSize, (char*)rx, rxSize);
+}
@@ -0,0 +1,166 @@
+/**
+ *       @file  DSPINorFlash.hpp
+ *      @brief  SFDPでパラメータを取得する汎用SPI NORフラッシュドライバです
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DSPINorFlash_hpp_
+#define dandy_DSPINorFlash_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+#include "platform/PlatformMutex.h"
+
+
+/** JEDEC SFDP(JESD216)でパラメータを取得する汎用SPI NORフラッシュドライバです
+ *
+ *  init()でSFDPのBasic Flash Parameter TableとSector Map Parameter Tableを読み
+ *  出し、容量、ページサイズ、消去コマンドの種類と、領域ごとに使用可能な消去コマ
+ *  ンドを取得します。
+ *
+ *  erase()は、指定範囲を最も少ない回数で消去できるように、アライメントが合う最
+ *  大の消去コマンドから順に選択します。例えば64KB境界から外れた範囲の消去でも、
+ *  32KBや8KBの消去コマンドが使える場所ではそれらを使用します。Sector Mapがな
+ *  いデバイスでは、オペコードが他の種類と重ならない消去コマンドだけを使用しま
+ *  す(SST26の0xD8のように、領域によって消去サイズが変わるコマンドを避けるた
+ *  めです)。
+ *
+ *  program()はページ境界で分割して書き込みます。読み出しにはFast Read(0x0B)を
+ *  使用します。
+ *
+ *  SST26のようにパワーオン時に書き込み保護されているデバイスは、init()で保護を
+ *  解除します。
+ */
+class DSPINorFlash : public BlockDevice
+{
+public:
+
+    /** 消去コマンドの種類の最大数です(SFDPの定義による)
+     */
+    static const int MAX_ERASE_TYPES = 4;
+
+
+    /** 管理可能な不均一セクタ領域の最大数です
+     */
+    static const int MAX_REGIONS = 8;
+
+
+    DSPINorFlash(PinName mosi, PinName miso, PinName sclk, PinName cs, int frequency);
+    virtual ~DSPINorFlash() override;
+    virtual const char* get_type() const { return "DSPINorFlash"; }
+    virtual int init() override;
+    virtual int deinit() override;
+    virtual int read(void* dst, bd_addr_t address, bd_size_t size) override;
+    virtual int program(const void* src, bd_addr_t address, bd_size_t size) override;
+    virtual int erase(bd_addr_t address, bd_size_t size) override;
+    virtual bd_size_t get_read_size() const override;
+    virtual bd_size_t get_program_size() const override;
+    virtual bd_size_t get_erase_size() const override;
+    virtual int get_erase_value() const override;
+    virtual bd_size_t size() const override;
+
+
+    /** 指定範囲の消去に必要な消去コマンドの発行回数を返します
+     *
+     *  範囲が消去可能でない場合は0を返します。
+     */
+    size_t countEraseOperations(bd_addr_t address, bd_size_t size) const;
+
+
+    /** ページサイズを返します
+     */
+    bd_size_t getPageSize() const { return m_pageSize; }
+
+
+    /** JEDEC IDを返します
+     */
+    const uint8_t* getJedecId() const { return m_jedecId; }
+
+
+    /** erase()で消去済みの範囲の消去を省略するかどうかを設定します(デフォルトは無効)
+     */
+    void setBlankCheckEnabled(bool enabled);
+
+private:
+    D_DISALLOW_COPY_AND_ASSIGN(DSPINorFlash);
+
+    struct EraseType
+    {
+        uint8_t opcode;
+        bd_size_t size;
+        uint32_t typicalUs;
+    };
+
+    struct Region
+    {
+        bd_addr_t end;
+        uint8_t typeMask;
+    };
+
+    int ReadSFDP(uint32_t address, void* dst, size_t size);
+    int ParseBasicParameterTable(uint32_t address, size_t dwords);
+    int ParseSectorMapTable(uint32_t address, size_t dwords);
+    void SetUniformRegion();
+    int FindSmallestEraseType() const;
+    int FindEraseType(bd_addr_t address, bd_addr_t end) const;
+
+    void DoCommand(uint8_t cmd, bd_addr_t address, int dummyBytes, const void* tx, int txSize, void* rx, int rxSize);
+    void DoCommandNoAddress(uint8_t cmd, const void* tx, int txSize, void* rx, int rxSize);
+    void WriteEnable();
+    uint8_t ReadStatusRegister();
+    void WaitForCommandCompletion(uint32_t typicalUs);
+
+    void SPICSHigh();
+    void SPICSLow();
+    void SPIExchange(const void* tx, int txSize, void* rx, int rxSize);
+
+    SPI m_spi;
+    DigitalOut m_cs;
+    PlatformMutex m_mutex;
+    uint8_t m_jedecId[3];
+    bd_size_t m_memorySize;
+    bd_size_t m_pageSize;
+    bd_size_t m_eraseSize;
+    uint32_t m_programTypicalUs;
+    int m_addressBytes;
+    EraseType m_eraseTypes[MAX_ERASE_TYPES];
+    bool m_blankCheckEnabled;
+    Region m_regions[MAX_REGIONS];
+    int m_regionCount;
+};
+
+
+#endif /* end of include guard: dandy_DSPINorFlash_hpp_ */
@@ -38,63 +38,6 @@
  * SOFTWARE.
  */
 
-#ifndef dandy_DSST26_hpp_
-#define dandy_DSST26_hpp_
 
-
-#include <dandy/core/DCore.hpp>
-#include <dandy/drivers/spi_flash/DSST26_def.h>
-
-
-enum DSST26DeviceType
-{
-    D_SST26_TYPE_VF016,
-    D_SST26_TYPE_VF032,
-    D_SST26_TYPE_VF064,
-    D_SST26_TYPE_END,
-    D_SST26_TYPE_UNKNOWN = D_SST26_TYPE_END,
-};
-
-class DSST26: public BlockDevice
-{
-public:
-    DSST26(PinName mosi, PinName miso, PinName sclk, PinName cs, int frequency);
-    virtual ~DSST26() override;
-    virtual const char* get_type() const { return "DSST26"; }
-    virtual int init() override;
-    virtual int deinit() override;
-    virtual int read(void* dst, bd_addr_t address, bd_size_t size) override;
-    virtual int program(const void* src, bd_addr_t address, bd_size_t size) override;
-    virtual int erase(bd_addr_t address, bd_size_t size) override;
-    virtual bd_size_t get_read_size() const override;
-    virtual bd_size_t get_program_size() const override;
-    virtual bd_size_t get_erase_size() const override;
-    virtual bd_size_t size() const override;
-
-    DSST26DeviceType getDeviceType() const;
-    bool chipErase();
-    uint8_t readStatusRegister();
-    uint8_t readConfigurationRegister();
-
-private:
-    void DoCommand(uint8_t cmd, bd_addr_t address, const void* tx, int txSize, void* rx, int rxSize);
-    void DoCommandNoAddress(uint8_t cmd, const void* tx, int txSize, void* rx, int rxSize);
-    void WriteEnable();
-    void WriteDisable();
-    void WaitForCommandCompletion();
-    void UnlockGlobalBlockProtection();
-    bd_size_t GetBlockEraseSize(bd_addr_t addr) const;
-    void EraseSectorOrBlock(uint8_t eraseCommand, bd_addr_t address);
-
-    void SPICSHigh();
-    void SPICSLow();
-    void SPIExchange(const void* tx, int txSize, void* rx, int rxSize);
-
-    SPI m_spi;
-    DigitalOut m_cs;
-    size_t m_memorySize;
-    DSST26DeviceType m_deviceType;
-};
-
-
-#endif /* end of include guard: dandy_DSST26_hpp_ */
+/* 実装はsst26/に移動した。古いインクルードパスとの互換のために残している。 */
+#include <dandy/drivers/spi_flash/sst26/DSST26.hpp>
@@ -12,18 +12,42 @@
  */
 
 #include <dandy/drivers/spi_flash/is25/DIS25.hpp>
+#include <dandy/core/utils/DBlockDeviceUtils.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+#include <dandy/core/utils/DTimeUtils.hpp>
+
+
+/* 完了待ちのポーリング間隔は、操作の標準時間をこの値で割った時間にする */
+#define D__POLL_DIVISOR                 (8)
+
+/* レジュームから次のサスペンドまでの最小間隔。読み出しが続いても消去が進むよ
+ * うにする。
+ */
+#define D__RESUME_TO_SUSPEND_US         (1000)
+
+/* この長さ以上のread()は、SPI::transfer()を使用して読み出す */
+#define D__ASYNC_READ_MIN_SIZE          (64)
+
+/* 1回のSPI::transfer()で読み出す最大バイト数。DMAの最大転送数を超えないように
+ * 分割し、完了割り込みから次の転送を開始する。
+ */
+#define D__ASYNC_CHUNK_SIZE             (4096)
+
+/* 読み出しコマンドの最大長 (コマンド + アドレス4バイト + ダミー1バイト) */
+#define D__READ_COMMAND_MAX             (6)
 
 
 struct D__EraseInfo
 {
     uint8_t cmd;
     bd_size_t size;
+    uint32_t typicalUs;
 };
 
 const D__EraseInfo D__eraseInfos[] = {
-    { D_IS25_CMD_4BER64, D_IS25_ERASE_SIZE_64KB},
-    { D_IS25_CMD_4BER32, D_IS25_ERASE_SIZE_32KB},
-    { D_IS25_CMD_4SER, D_IS25_ERASE_SIZE_4KB}
+    { D_IS25_CMD_4BER64, D_IS25_ERASE_SIZE_64KB, D_IS25_TIME_BER64_US},
+    { D_IS25_CMD_4BER32, D_IS25_ERASE_SIZE_32KB, D_IS25_TIME_BER32_US},
+    { D_IS25_CMD_4SER, D_IS25_ERASE_SIZE_4KB, D_IS25_TIME_SER_US}
 };
 
 static bool D__IsAligned(bd_addr_t address, bd_addr_t align)
@@ -39,9 +63,28 @@ DIS25::DIS25(PinName mosi, PinName miso, PinName sclk, PinName cs, int frequency
     , m_cs(cs)
     , m_memorySize(0)
     , m_deviceType(D_IS25_TYPE_UNKNOWN)
+    , m_busy(false)
+    , m_suspendable(false)
+    , m_suspendEnabled(true)
+    , m_busyAddress(0)
+    , m_busySize(0)
+    , m_pollInterval(0)
+    , m_resumedAt(0)
+    , m_readMode(D_IS25_READ_MODE_NORMAL)
+    , m_blankCheckEnabled(false)
+    , m_suspended(false)
+    , m_reading(false)
+#if DEVICE_SPI_ASYNCH
+    , m_readDst(nullptr)
+    , m_readRemaining(0)
+    , m_readResult(0)
+#endif
 {
     this->SPICSHigh();
     m_spi.frequency(frequency);
+#if DEVICE_SPI_ASYNCH
+    m_spi.set_dma_usage(DMA_USAGE_OPPORTUNISTIC);
+#endif
 }
 
 DIS25::~DIS25()
@@ -51,9 +94,13 @@ DIS25::~DIS25()
 
 void DIS25::chipErase()
 {
+    m_mutex.lock();
+    this->WaitForIdle();
     this->WriteEnable();
     this->DoCommandNoAddress(D_IS25_CMD_CER, NULL, 0, NULL, 0);
-    this->WaitForCommandCompletion();
+    this->BeginOperation(0, m_memorySize, false);
+    this->WaitForCommandCompletion(D_IS25_TIME_CER_US);
+    m_mutex.unlock();
 }
 
 int DIS25::init()
@@ -70,7 +117,9 @@ int DIS25::init()
 
     uint8_t deviceID[3] = { 0 };
 
+    m_mutex.lock();
     this->DoCommandNoAddress(D_IS25_CMD_RDJDID, NULL, 0, deviceID, sizeof(deviceID));
+    m_mutex.unlock();
 
     DIS25DeviceType deviceType = D_IS25_TYPE_UNKNOWN;
     for (int i = 0; i < X_COUNT_OF_ROW(IS25_ids); i++)
@@ -116,7 +165,10 @@ int DIS25::init()
 
 int DIS25::deinit()
 {
+    m_mutex.lock();
+    this->WaitForIdle();
     this->WRDI_writeDisable();
+    m_mutex.unlock();
     return BD_ERROR_OK;
 }
 
@@ -124,7 +176,40 @@ int DIS25::read(void* dst, bd_addr_t address, bd_size_t size)
 {
     X_ASSERT(this->is_valid_read(address, size));
 
-    this->DoCommand(D_IS25_CMD_4NORD, address, NULL, 0, dst, size);
+#if DEVICE_SPI_ASYNCH
+    if (size >= D__ASYNC_READ_MIN_SIZE)
+    {
+        /* 完了まで排他しておかないと、他のスレッドが次の読み出しを開始して
+         * m_readResultを上書きしてしまう */
+        m_mutex.lock();
+        this->StartRead(dst, address, size, ReadCallback());
+
+        /* 転送中はCPUを他のスレッドに譲る */
+#ifdef MBED_CONF_RTOS_PRESENT
+        m_readDone.wait();
+#else
+        while (m_reading)
+            sleep();
+#endif
+
+        this->CompleteRead();
+        const int result = m_readResult;
+        m_mutex.unlock();
+
+        return result;
+    }
+#endif
+
+    m_mutex.lock();
+    uint8_t preTx[D__READ_COMMAND_MAX];
+    const int preTxSize = this->BuildReadCommand(address, preTx);
+    m_suspended = this->SuspendForRead(address, size);
+    this->SPICSLow();
+    this->SPIExchange(preTx, preTxSize, NULL, 0);
+    this->SPIExchange(NULL, 0, dst, size);
+    this->SPICSHigh();
+    this->CompleteRead();
+    m_mutex.unlock();
 
     return BD_ERROR_OK;
 }
@@ -134,20 +219,26 @@ int DIS25::program(const void* src, bd_addr_t address, bd_size_t size)
     X_ASSERT(this->is_valid_program(address, size));
 
     const char* p = static_cast<const char*>(src);
-    const int maxSizeOfOneTime = 256; /* 1回のPPコマンドで書き込み可能な最大バイト数 */
 
+    m_mutex.lock();
     while (size)
     {
-        this->WriteEnable();
+        /* PPコマンドはページの末尾を越えるとページの先頭に折り返して書き込むの
+         * で、開始アドレスからではなくページ境界で分割する。
+         */
+        const bd_size_t toProgram = d_min<bd_size_t>(size, D_IS25_PAGE_SIZE - (address % D_IS25_PAGE_SIZE));
 
-        const int toProgram = size > maxSizeOfOneTime ? maxSizeOfOneTime : size;
-        this->DoCommand(D_IS25_CMD_4PP, address, p, toProgram, NULL, 0);
+        this->WaitForIdle();
+        this->WriteEnable();
+        this->DoCommand(D_IS25_CMD_4PP, address, p, static_cast<int>(toProgram), NULL, 0);
+        this->BeginOperation(address, toProgram, false);
         p += toProgram;
         address += toProgram;
         size -= toProgram;
 
-        this->WaitForCommandCompletion();
+        this->WaitForCommandCompletion(D_IS25_TIME_PP_US);
     }
+    m_mutex.unlock();
     return BD_ERROR_OK;
 }
 
@@ -169,11 +260,29 @@ int DIS25::erase(bd_addr_t address, bd_size_t size)
         }
         X_ASSERT(info);
 
+        bool blank = false;
+        if (m_blankCheckEnabled)
+        {
+            const int result = DBlockDeviceUtils::isBlank(this, address, info->size, &blank);
+            if (result != 0)
+                return result;
+        }
+        if (blank)
+        {
+            address += info->size;
+            size -= info->size;
+            continue;
+        }
+
+        m_mutex.lock();
+        this->WaitForIdle();
         this->WriteEnable();
         this->xER_sectorOrBlockErase(info->cmd, address);
+        this->BeginOperation(address, info->size, true);
+        this->WaitForCommandCompletion(info->typicalUs);
+        m_mutex.unlock();
         address += info->size;
         size -= info->size;
-        this->WaitForCommandCompletion();
     }
 
     return BD_ERROR_OK;
@@ -194,6 +303,11 @@ bd_size_t DIS25::get_erase_size() const
     return D_IS25_ERASE_SIZE_4KB;
 }
 
+int DIS25::get_erase_value() const
+{
+    return 0xFF;
+}
+
 
 bd_size_t DIS25::size() const
 {
@@ -205,6 +319,27 @@ DIS25DeviceType DIS25::getDeviceType() const
     return m_deviceType;
 }
 
+void DIS25::setSuspendEnabled(bool enabled)
+{
+    m_mutex.lock();
+    m_suspendEnabled = enabled;
+    m_mutex.unlock();
+}
+
+void DIS25::setReadMode(DIS25ReadMode mode)
+{
+    m_mutex.lock();
+    m_readMode = mode;
+    m_mutex.unlock();
+}
+
+void DIS25::setBlankCheckEnabled(bool enabled)
+{
+    m_mutex.lock();
+    m_blankCheckEnabled = enabled;
+    m_mutex.unlock();
+}
+
 void DIS25::DoCommand(uint8_t cmd, bd_addr_t address, const void* tx, int txSize, void* rx, int rxSize)
 {
     const uint8_t preTx[5] = {
@@ -231,16 +366,198 @@ void DIS25::DoCommandNoAddress(uint8_t cmd, const void* tx, int txSize, void* rx
     this->SPICSHigh();
 }
 
-void DIS25::WaitForCommandCompletion()
+void DIS25::BeginOperation(bd_addr_t address, bd_size_t size, bool suspendable)
 {
+    m_busy = true;
+    m_busyAddress = address;
+    m_busySize = size;
+    m_suspendable = suspendable;
+}
+
+void DIS25::WaitForCommandCompletion(uint32_t typicalUs)
+{
+    /* 完了を待つ間はバスを解放して、他のスレッドがサスペンドして読み出しを行え
+     * るようにする。
+     */
+    m_pollInterval = typicalUs / D__POLL_DIVISOR;
     for (;;)
     {
         const uint8_t status = this->RDSP_readStatusRegister();
         if (!(status & D_IS25_SR_BIT_WIP))
             break;
+
+        m_mutex.unlock();
+        DTimeUtils::sleepMicroSeconds(m_pollInterval);
+        m_mutex.lock();
+        this->WaitForBus();
+    }
+
+    m_busy = false;
+}
+
+void DIS25::WaitForIdle()
+{
+    this->WaitForBus();
+    while (m_busy)
+    {
+        m_mutex.unlock();
+        DTimeUtils::sleepMicroSeconds(m_pollInterval);
+        m_mutex.lock();
+        this->WaitForBus();
+    }
+}
+
+bool DIS25::SuspendForRead(bd_addr_t address, bd_size_t size)
+{
+    this->WaitForBus();
+    while (m_busy)
+    {
+        const bool overlapped = (address < m_busyAddress + m_busySize) &&
+                                (m_busyAddress < address + size);
+        const uint32_t elapsed = us_ticker_read() - m_resumedAt;
+
+        if (m_suspendEnabled && m_suspendable && !overlapped &&
+            (elapsed >= D__RESUME_TO_SUSPEND_US))
+        {
+            /* サスペンドが完了するとWIPが0になり、ファンクションレジスタのESUS
+             * が1になる。ESUSが0なら、サスペンドする前に消去が完了している。
+             */
+            this->PERSUS_suspend();
+            while (this->RDSP_readStatusRegister() & D_IS25_SR_BIT_WIP)
+                ;
+
+            return (this->RDFR_readFunctionRegister() & D_IS25_FR_BIT_ESUS) != 0;
+        }
+
+        m_mutex.unlock();
+        DTimeUtils::sleepMicroSeconds(m_pollInterval);
+        m_mutex.lock();
+        this->WaitForBus();
+    }
+
+    return false;
+}
+
+void DIS25::Resume()
+{
+    this->PERRSM_resume();
+    m_resumedAt = us_ticker_read();
+}
+
+void DIS25::WaitForBus()
+{
+    while (m_reading)
+    {
+        m_mutex.unlock();
+        DTimeUtils::sleepMicroSeconds(0);
+        m_mutex.lock();
     }
+
+    this->CompleteRead();
+}
+
+int DIS25::BuildReadCommand(bd_addr_t address, uint8_t* cmd) const
+{
+    cmd[0] = (m_readMode == D_IS25_READ_MODE_FAST) ? D_IS25_CMD_4FRD : D_IS25_CMD_4NORD;
+    cmd[1] = static_cast<uint8_t>((address >> 24) & 0xFF);
+    cmd[2] = static_cast<uint8_t>((address >> 16) & 0xFF);
+    cmd[3] = static_cast<uint8_t>((address >> 8)  & 0xFF);
+    cmd[4] = static_cast<uint8_t>((address) & 0xFF);
+    if (m_readMode == D_IS25_READ_MODE_NORMAL)
+        return 5;
+
+    /* Read Registerのダミーサイクル数はリセット後のデフォルト(SPIモードで8ク
+     * ロック)のまま使用する。
+     */
+    cmd[5] = 0xFF;
+    return 6;
 }
 
+void DIS25::CompleteRead()
+{
+    /* 非同期読み出しのためにサスペンドした消去は、割り込みハンドラからはレ
+     * ジュームできないので、次にバスを使用するスレッドがレジュームする。
+     */
+    if (!m_reading && m_suspended)
+    {
+        this->Resume();
+        m_suspended = false;
+    }
+}
+
+#if DEVICE_SPI_ASYNCH
+int DIS25::readAsync(void* dst, bd_addr_t address, bd_size_t size, const ReadCallback& callback)
+{
+    X_ASSERT(this->is_valid_read(address, size));
+    X_ASSERT(callback);
+
+    m_mutex.lock();
+    const int result = this->StartRead(dst, address, size, callback);
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DIS25::StartRead(void* dst, bd_addr_t address, bd_size_t size, const ReadCallback& callback)
+{
+    m_suspended = this->SuspendForRead(address, size);
+
+    uint8_t preTx[D__READ_COMMAND_MAX];
+    const int preTxSize = this->BuildReadCommand(address, preTx);
+
+    m_readDst = static_cast<uint8_t*>(dst);
+    m_readRemaining = size;
+    m_readResult = BD_ERROR_OK;
+    m_readCallback = callback;
+    m_reading = true;
+
+    this->SPICSLow();
+    this->SPIExchange(preTx, preTxSize, NULL, 0);
+    this->TransferNextChunk();
+
+    return BD_ERROR_OK;
+}
+
+void DIS25::TransferNextChunk()
+{
+    const int toRead = (m_readRemaining > D__ASYNC_CHUNK_SIZE) ? D__ASYNC_CHUNK_SIZE : m_readRemaining;
+    uint8_t* const dst = m_readDst;
+    m_readDst += toRead;
+    m_readRemaining -= toRead;
+
+    /* 読み出し命令のあとはCSをLowにしている間アドレスが進み続けるので、分割し
+     * た転送をそのまま続けて行える。
+     */
+    const int result = m_spi.transfer<uint8_t>(NULL, 0, dst, toRead,
+                                               callback(this, &DIS25::OnReadEvent),
+                                               SPI_EVENT_COMPLETE | SPI_EVENT_ERROR);
+    if (result != 0)
+        this->OnReadEvent(SPI_EVENT_ERROR);
+}
+
+void DIS25::OnReadEvent(int event)
+{
+    if (event & SPI_EVENT_ERROR)
+        m_readResult = BD_ERROR_DEVICE_ERROR;
+
+    if ((m_readResult == BD_ERROR_OK) && (m_readRemaining > 0))
+    {
+        this->TransferNextChunk();
+        return;
+    }
+
+    this->SPICSHigh();
+    m_reading = false;
+
+    if (m_readCallback)
+        m_readCallback(m_readResult);
+#ifdef MBED_CONF_RTOS_PRESENT
+    else
+        m_readDone.release();
+#endif
+}
+#endif
+
 void DIS25::WREN_writeEnable()
 {
     this->DoCommandNoAddress(D_IS25_CMD_WREN, NULL, 0, NULL, 0);
@@ -254,8 +571,14 @@ void DIS25::WRDI_writeDisable()
 void DIS25::WriteEnable()
 {
     this->WREN_writeEnable();
+
+    /* WELの確認は書き込みごとにステータスレジスタの読み出しが増えるので、アサー
+     * トが有効な時だけ行う。
+     */
+#if X_CONF_NDEBUG == 0
     const uint8_t statusRegister = this->RDSP_readStatusRegister();
     X_ASSERT(statusRegister & D_IS25_SR_BIT_WEL);
+#endif
 }
 
 void DIS25::xER_sectorOrBlockErase(uint8_t eraseCommand, bd_addr_t address)
@@ -276,6 +599,24 @@ uint8_t DIS25::RDSP_readStatusRegister()
     return statusRegister;
 }
 
+uint8_t DIS25::RDFR_readFunctionRegister()
+{
+    uint8_t functionRegister;
+    this->DoCommandNoAddress(D_IS25_CMD_RDFR, NULL, 0, &functionRegister, 1);
+
+    return functionRegister;
+}
+
+void DIS25::PERSUS_suspend()
+{
+    this->DoCommandNoAddress(D_IS25_CMD_PERSUS, NULL, 0, NULL, 0);
+}
+
+void DIS25::PERRSM_resume()
+{
+    this->DoCommandNoAddress(D_IS25_CMD_PERRSM, NULL, 0, NULL, 0);
+}
+
 void DIS25::SPICSHigh()
 {
     m_cs.write(1);
@@ -17,6 +17,10 @@
 
 #include <dandy/core/DCore.hpp>
 #include <dandy/drivers/spi_flash/is25/DIS25_def.h>
+#include "platform/PlatformMutex.h"
+#ifdef MBED_CONF_RTOS_PRESENT
+#include "rtos/Semaphore.h"
+#endif
 
 
 enum DIS25DeviceType
@@ -32,6 +36,12 @@ enum DIS25DeviceType
     D_IS25_TYPE_UNKNOWN = D_IS25_TYPE_END,
 };
 
+enum DIS25ReadMode
+{
+    D_IS25_READ_MODE_NORMAL, /* 4NORD (0x13) 最大50MHz */
+    D_IS25_READ_MODE_FAST,   /* 4FRD (0x0C) ダミー8クロック 最大133MHz */
+};
+
 class DIS25: public BlockDevice
 {
 public:
@@ -46,15 +56,73 @@ public:
     virtual bd_size_t get_read_size() const override;
     virtual bd_size_t get_program_size() const override;
     virtual bd_size_t get_erase_size() const override;
+    virtual int get_erase_value() const override;
     virtual bd_size_t size() const override;
 
     DIS25DeviceType getDeviceType() const;
     void chipErase();
+
+    /** 消去中に別スレッドからread()された時、消去をサスペンドするかどうかを設定します
+     *
+     *  デフォルトは有効です。消去中のセクタやブロックと重なる範囲の読み出しは、
+     *  サスペンドせずに消去の完了を待ちます。
+     */
+    void setSuspendEnabled(bool enabled);
+
+    /** 読み出しに使用するコマンドを設定します
+     *
+     *  デフォルトはD_IS25_READ_MODE_NORMALです。Normal Readコマンドは50MHzまで
+     *  しか動作しないので、それ以上のクロックで使用する場合は
+     *  D_IS25_READ_MODE_FASTを指定してください。
+     */
+    void setReadMode(DIS25ReadMode mode);
+
+
+    /** erase()で消去済みの範囲の消去を省略するかどうかを設定します(デフォルトは無効)
+     */
+    void setBlankCheckEnabled(bool enabled);
+
+#if DEVICE_SPI_ASYNCH
+
+    /** 読み出し完了時に呼び出されるコールバックです
+     *
+     *  引数は読み出しの結果で、成功時は0です。割り込みコンテキストから呼び出さ
+     *  れます。
+     */
+    typedef Callback<void(int)> ReadCallback;
+
+
+    /** 非同期に読み出しを開始します
+     *
+     *  SPI::transfer()を使用して、DMAでdstに直接読み出します。読み出しが完了す
+     *  るとcallbackが呼び出されます。完了するまでdstを解放してはいけません。
+     *  割り込みコンテキストからは呼び出せません。
+     */
+    int readAsync(void* dst, bd_addr_t address, bd_size_t size, const ReadCallback& callback);
+
+
+    /** 非同期の読み出し中かどうかを返します
+     */
+    bool isReading() const { return m_reading; }
+#endif
+
 private:
     void DoCommand(uint8_t cmd, bd_addr_t address, const void* tx, int txSize, void* rx, int rxSize);
     void DoCommandNoAddress(uint8_t cmd, const void* tx, int txSize, void* rx, int rxSize);
     void WriteEnable();
-    void WaitForCommandCompletion();
+    void BeginOperation(bd_addr_t address, bd_size_t size, bool suspendable);
+    void WaitForCommandCompletion(uint32_t typicalUs);
+    void WaitForIdle();
+    bool SuspendForRead(bd_addr_t address, bd_size_t size);
+    void Resume();
+    void WaitForBus();
+    void CompleteRead();
+    int BuildReadCommand(bd_addr_t address, uint8_t* cmd) const;
+#if DEVICE_SPI_ASYNCH
+    int StartRead(void* dst, bd_addr_t address, bd_size_t size, const ReadCallback& callback);
+    void TransferNextChunk();
+    void OnReadEvent(int event);
+#endif
 
     void SPICSLow();
     void SPICSHigh();
@@ -65,11 +133,41 @@ private:
     void xER_sectorOrBlockErase(uint8_t eraseCommand, bd_addr_t address);
     void WRSR_writeStatusRegister(uint8_t statusRegister);
     uint8_t RDSP_readStatusRegister();
+    uint8_t RDFR_readFunctionRegister();
+    void PERSUS_suspend();
+    void PERRSM_resume();
 
     SPI m_spi;
     DigitalOut m_cs;
     uint32_t m_memorySize;
     DIS25DeviceType m_deviceType;
+
+    /* 消去や書き込みの完了待ちの間はm_mutexを解放するので、実行中の操作はこれ
+     * らのメンバで管理する。
+     */
+    PlatformMutex m_mutex;
+    bool m_busy;
+    bool m_suspendable;
+    bool m_suspendEnabled;
+    bd_addr_t m_busyAddress;
+    bd_size_t m_busySize;
+    uint32_t m_pollInterval;
+    uint32_t m_resumedAt;
+    DIS25ReadMode m_readMode;
+    bool m_blankCheckEnabled;
+    bool m_suspended;
+    volatile bool m_reading;
+
+#if DEVICE_SPI_ASYNCH
+    /* 非同期読み出しの状態。m_readingがtrueの間は割り込みハンドラが更新する。 */
+    uint8_t* m_readDst;
+    bd_size_t m_readRemaining;
+    volatile int m_readResult;
+    ReadCallback m_readCallback;
+#ifdef MBED_CONF_RTOS_PRESENT
+    rtos::Semaphore m_readDone;
+#endif
+#endif
 };
 
 
@@ -89,6 +89,8 @@
 #define D_IS25_ERASE_SIZE_64KB  (1024UL * 64)
 #define D_IS25_ERASE_SIZE_MIN   (D_IS25_ERASE_SIZE_4KB)
 
+#define D_IS25_PAGE_SIZE        (256UL)     /* 1回のPPコマンドで書き込み可能な最大バイト数 */
+
 #define D_IS25_SR_BIT_WIP       (1UL << 0)
 #define D_IS25_SR_BIT_WEL       (1UL << 1)
 #define D_IS25_SR_BIT_BP0       (1UL << 2)
@@ -98,6 +100,18 @@
 #define D_IS25_SR_BIT_QE        (1UL << 6)
 #define D_IS25_SR_BIT_SRWD      (1UL << 7)
 
+/* DataSheet Function Register */
+#define D_IS25_FR_BIT_TBS       (1UL << 1)
+#define D_IS25_FR_BIT_PSUS      (1UL << 2)
+#define D_IS25_FR_BIT_ESUS      (1UL << 3)
+
+/* DataSheet AC CHARACTERISTICS (typ) */
+#define D_IS25_TIME_PP_US       (200UL)       /* Page Program */
+#define D_IS25_TIME_SER_US      (70000UL)     /* Sector Erase 4KB */
+#define D_IS25_TIME_BER32_US    (100000UL)    /* Block Erase 32KB */
+#define D_IS25_TIME_BER64_US    (150000UL)    /* Block Erase 64KB */
+#define D_IS25_TIME_CER_US      (20000000UL)  /* Chip Erase */
+
 #define D_IS25xx32_ADDRESS_BEGIN  (0x00000000)
 #define D_IS25xx32_ADDRESS_END    (0x00400000)
 #define D_IS25xx32_SIZE           (D_IS25xx32_ADDRESS_END - D_IS25xx32_ADDRESS_BEGIN) /* 4MB */
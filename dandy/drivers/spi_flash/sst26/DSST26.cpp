@@ -38,20 +38,61 @@
  * SOFTWARE.
  */
 
-#include <dandy/drivers/spi_flash/DSST26.hpp>
+#include <dandy/drivers/spi_flash/sst26/DSST26.hpp>
+#include <dandy/core/utils/DBlockDeviceUtils.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+#include <dandy/core/utils/DTimeUtils.hpp>
 
 
 static const char TAG[] = "DSST26";
 
+/* 完了待ちのポーリング間隔は、操作の標準時間をこの値で割った時間にする */
+#define D__POLL_DIVISOR                 (8)
+
+/* レジュームから次のサスペンドまでの最小間隔。読み出しが続いても消去が進むよ
+ * うにする。
+ */
+#define D__RESUME_TO_SUSPEND_US         (1000)
+
+/* この長さ以上のread()は、SPI::transfer()を使用して読み出す */
+#define D__ASYNC_READ_MIN_SIZE          (64)
+
+/* 1回のSPI::transfer()で読み出す最大バイト数。DMAの最大転送数を超えないように
+ * 分割し、完了割り込みから次の転送を開始する。
+ */
+#define D__ASYNC_CHUNK_SIZE             (4096)
+
+/* 読み出しコマンドの最大長 (コマンド + アドレス3バイト + ダミー1バイト) */
+#define D__READ_COMMAND_MAX             (5)
+
 
 DSST26::DSST26(PinName mosi, PinName miso, PinName sclk, PinName cs, int frequency)
     : m_spi(mosi, miso, sclk)
     , m_cs(cs)
     , m_memorySize(0)
     , m_deviceType(D_SST26_TYPE_UNKNOWN)
+    , m_busy(false)
+    , m_suspendable(false)
+    , m_suspendEnabled(true)
+    , m_busyAddress(0)
+    , m_busySize(0)
+    , m_pollInterval(0)
+    , m_resumedAt(0)
+    , m_readMode(D_SST26_READ_MODE_NORMAL)
+    , m_blankCheckEnabled(false)
+    , m_suspended(false)
+    , m_reading(false)
+#if DEVICE_SPI_ASYNCH
+    , m_readDst(nullptr)
+    , m_readRemaining(0)
+    , m_readResult(0)
+#endif
 {
     this->SPICSHigh();
     m_spi.frequency(frequency);
+#if DEVICE_SPI_ASYNCH
+    m_spi.set_dma_usage(DMA_USAGE_OPPORTUNISTIC);
+#endif
 }
 
 DSST26::~DSST26()
@@ -69,7 +110,9 @@ int DSST26::init()
 
     uint8_t deviceID[3] = { 0 };
 
+    m_mutex.lock();
     this->DoCommandNoAddress(D_SST26_CMD_JEDEC_ID, NULL, 0, deviceID, sizeof(deviceID));
+    m_mutex.unlock();
 
     DSST26DeviceType deviceType = D_SST26_TYPE_UNKNOWN;
     for (int i = 0; i < X_COUNT_OF_ROW(SST26_ids); i++)
@@ -103,14 +146,19 @@ int DSST26::init()
     }
     m_deviceType = deviceType;
 
+    m_mutex.lock();
     this->UnlockGlobalBlockProtection();
+    m_mutex.unlock();
 
     return true;
 }
 
 int DSST26::deinit()
 {
+    m_mutex.lock();
+    this->WaitForIdle();
     this->WriteDisable();
+    m_mutex.unlock();
     return 0;
 }
 
@@ -118,7 +166,40 @@ int DSST26::read(void* dst, bd_addr_t address, bd_size_t size)
 {
     X_ASSERT(this->is_valid_read(address, size));
 
-    this->DoCommand(D_SST26_CMD_Read, address, NULL, 0, dst, size);
+#if DEVICE_SPI_ASYNCH
+    if (size >= D__ASYNC_READ_MIN_SIZE)
+    {
+        /* 完了まで排他しておかないと、他のスレッドが次の読み出しを開始して
+         * m_readResultを上書きしてしまう */
+        m_mutex.lock();
+        this->StartRead(dst, address, size, ReadCallback());
+
+        /* 転送中はCPUを他のスレッドに譲る */
+#ifdef MBED_CONF_RTOS_PRESENT
+        m_readDone.wait();
+#else
+        while (m_reading)
+            sleep();
+#endif
+
+        this->CompleteRead();
+        const int result = m_readResult;
+        m_mutex.unlock();
+
+        return result;
+    }
+#endif
+
+    m_mutex.lock();
+    uint8_t preTx[D__READ_COMMAND_MAX];
+    const int preTxSize = this->BuildReadCommand(address, preTx);
+    m_suspended = this->SuspendForRead(address, size);
+    this->SPICSLow();
+    this->SPIExchange(preTx, preTxSize, NULL, 0);
+    this->SPIExchange(NULL, 0, dst, size);
+    this->SPICSHigh();
+    this->CompleteRead();
+    m_mutex.unlock();
 
     return 0;
 }
@@ -128,20 +209,26 @@ int DSST26::program(const void* src, bd_addr_t address, bd_size_t size)
     X_ASSERT(this->is_valid_program(address, size));
 
     const char* p = static_cast<const char*>(src);
-    const int maxSizeOfOneTime = 256; /* 1回のPPコマンドで書き込み可能な最大バイト数 */
 
+    m_mutex.lock();
     while (size)
     {
-        this->WriteEnable();
+        /* PPコマンドはページの末尾を越えるとページの先頭に折り返して書き込むの
+         * で、開始アドレスからではなくページ境界で分割する。
+         */
+        const bd_size_t toProgram = d_min<bd_size_t>(size, D_SST26_PAGE_SIZE - (address % D_SST26_PAGE_SIZE));
 
-        const int toProgram = size > maxSizeOfOneTime ? maxSizeOfOneTime : size;
-        this->DoCommand(D_SST26_CMD_PP, address, p, toProgram, NULL, 0);
+        this->WaitForIdle();
+        this->WriteEnable();
+        this->DoCommand(D_SST26_CMD_PP, address, p, static_cast<int>(toProgram), NULL, 0);
+        this->BeginOperation(address, toProgram, false);
         p += toProgram;
         address += toProgram;
         size -= toProgram;
 
-        this->WaitForCommandCompletion();
+        this->WaitForCommandCompletion(D_SST26_TIME_PP_US);
     }
+    m_mutex.unlock();
     return 0;
 }
 
@@ -166,7 +253,15 @@ int DSST26::erase(bd_addr_t address, bd_size_t size)
             eraseSize = D_SST26_ERASE_SIZE_4KB;
         }
 
-        this->EraseSectorOrBlock(eraseCommand, address);
+        bool blank = false;
+        if (m_blankCheckEnabled)
+        {
+            const int result = DBlockDeviceUtils::isBlank(this, address, eraseSize, &blank);
+            if (result != 0)
+                return result;
+        }
+        if (!blank)
+            this->EraseSectorOrBlock(eraseCommand, address, eraseSize);
         address += eraseSize;
         size -= eraseSize;
     }
@@ -198,6 +293,11 @@ bd_size_t DSST26::get_erase_size() const
     return D_SST26_ERASE_SIZE_4KB;
 }
 
+int DSST26::get_erase_value() const
+{
+    return 0xFF;
+}
+
 bd_size_t DSST26::size() const
 {
     return m_memorySize;
@@ -210,9 +310,13 @@ DSST26DeviceType DSST26::getDeviceType() const
 
 bool DSST26::chipErase()
 {
+    m_mutex.lock();
+    this->WaitForIdle();
     this->WriteEnable();
     this->DoCommandNoAddress(D_SST26_CMD_CE, NULL, 0, NULL, 0);
-    this->WaitForCommandCompletion();
+    this->BeginOperation(0, m_memorySize, false);
+    this->WaitForCommandCompletion(D_SST26_TIME_CE_US);
+    m_mutex.unlock();
 
     return true;
 }
@@ -220,7 +324,9 @@ bool DSST26::chipErase()
 uint8_t DSST26::readStatusRegister()
 {
     uint8_t statusRegister;
+    m_mutex.lock();
     this->DoCommandNoAddress(D_SST26_CMD_RDSR, NULL, 0, &statusRegister, 1);
+    m_mutex.unlock();
 
     return statusRegister;
 }
@@ -228,11 +334,34 @@ uint8_t DSST26::readStatusRegister()
 uint8_t DSST26::readConfigurationRegister()
 {
     uint8_t configurationRegister;
+    m_mutex.lock();
     this->DoCommandNoAddress(D_SST26_CMD_RDCR, NULL, 0, &configurationRegister, 1);
+    m_mutex.unlock();
 
     return configurationRegister;
 }
 
+void DSST26::setSuspendEnabled(bool enabled)
+{
+    m_mutex.lock();
+    m_suspendEnabled = enabled;
+    m_mutex.unlock();
+}
+
+void DSST26::setReadMode(DSST26ReadMode mode)
+{
+    m_mutex.lock();
+    m_readMode = mode;
+    m_mutex.unlock();
+}
+
+void DSST26::setBlankCheckEnabled(bool enabled)
+{
+    m_mutex.lock();
+    m_blankCheckEnabled = enabled;
+    m_mutex.unlock();
+}
+
 void DSST26::DoCommand(uint8_t cmd, bd_addr_t address, const void* tx, int txSize, void* rx, int rxSize)
 {
     const uint8_t preTx[4] = {
@@ -261,8 +390,14 @@ void DSST26::DoCommandNoAddress(uint8_t cmd, const void* tx, int txSize, void* r
 void DSST26::WriteEnable()
 {
     this->DoCommandNoAddress(D_SST26_CMD_WREN, NULL, 0, NULL, 0);
+
+    /* WELの確認は書き込みごとにステータスレジスタの読み出しが増えるので、アサー
+     * トが有効な時だけ行う。
+     */
+#if X_CONF_NDEBUG == 0
     const uint8_t statusRegister = this->readStatusRegister();
     X_ASSERT(statusRegister & D_SST26_SR_BIT_WEL);
+#endif
 }
 
 void DSST26::WriteDisable()
@@ -272,16 +407,201 @@ void DSST26::WriteDisable()
     X_ASSERT(!(statusRegister & D_SST26_SR_BIT_WEL));
 }
 
-void DSST26::WaitForCommandCompletion()
+void DSST26::BeginOperation(bd_addr_t address, bd_size_t size, bool suspendable)
+{
+    m_busy = true;
+    m_busyAddress = address;
+    m_busySize = size;
+    m_suspendable = suspendable;
+}
+
+void DSST26::WaitForCommandCompletion(uint32_t typicalUs)
 {
+    /* 完了を待つ間はバスを解放して、他のスレッドがサスペンドして読み出しを行え
+     * るようにする。
+     */
+    m_pollInterval = typicalUs / D__POLL_DIVISOR;
     for (;;)
     {
         const uint8_t status = this->readStatusRegister();
         if (!(status & D_SST26_SR_BIT_BUSY))
             break;
+
+        m_mutex.unlock();
+        DTimeUtils::sleepMicroSeconds(m_pollInterval);
+        m_mutex.lock();
+        this->WaitForBus();
+    }
+
+    m_busy = false;
+}
+
+void DSST26::WaitForIdle()
+{
+    this->WaitForBus();
+    while (m_busy)
+    {
+        m_mutex.unlock();
+        DTimeUtils::sleepMicroSeconds(m_pollInterval);
+        m_mutex.lock();
+        this->WaitForBus();
     }
 }
 
+bool DSST26::SuspendForRead(bd_addr_t address, bd_size_t size)
+{
+    this->WaitForBus();
+    while (m_busy)
+    {
+        const bool overlapped = (address < m_busyAddress + m_busySize) &&
+                                (m_busyAddress < address + size);
+        const uint32_t elapsed = us_ticker_read() - m_resumedAt;
+
+        if (m_suspendEnabled && m_suspendable && !overlapped &&
+            (elapsed >= D__RESUME_TO_SUSPEND_US))
+        {
+            /* see [DataSheet Write-Suspend]
+             * サスペンドが完了するとBUSYが0になり、WSEが1になる。WSEが0なら、
+             * サスペンドする前に消去が完了している。
+             */
+            this->DoCommandNoAddress(D_SST26_CMD_WRSU, NULL, 0, NULL, 0);
+            uint8_t status;
+            do
+            {
+                status = this->readStatusRegister();
+            } while (status & D_SST26_SR_BIT_BUSY);
+
+            return (status & D_SST26_SR_BIT_WSE) != 0;
+        }
+
+        m_mutex.unlock();
+        DTimeUtils::sleepMicroSeconds(m_pollInterval);
+        m_mutex.lock();
+        this->WaitForBus();
+    }
+
+    return false;
+}
+
+void DSST26::Resume()
+{
+    this->DoCommandNoAddress(D_SST26_CMD_WRRE, NULL, 0, NULL, 0);
+    m_resumedAt = us_ticker_read();
+}
+
+void DSST26::WaitForBus()
+{
+    while (m_reading)
+    {
+        m_mutex.unlock();
+        DTimeUtils::sleepMicroSeconds(0);
+        m_mutex.lock();
+    }
+
+    this->CompleteRead();
+}
+
+int DSST26::BuildReadCommand(bd_addr_t address, uint8_t* cmd) const
+{
+    cmd[0] = (m_readMode == D_SST26_READ_MODE_FAST) ? D_SST26_CMD_HighSpeedRead : D_SST26_CMD_Read;
+    cmd[1] = static_cast<uint8_t>((address >> 16) & 0xFF);
+    cmd[2] = static_cast<uint8_t>((address >> 8)  & 0xFF);
+    cmd[3] = static_cast<uint8_t>((address) & 0xFF);
+    if (m_readMode == D_SST26_READ_MODE_NORMAL)
+        return 4;
+
+    /* see [DataSheet High-Speed Read]
+     * SPIモードではアドレスのあとに8クロック分のダミーサイクルが必要。
+     */
+    cmd[4] = 0xFF;
+    return 5;
+}
+
+void DSST26::CompleteRead()
+{
+    /* 非同期読み出しのためにサスペンドした消去は、割り込みハンドラからはレ
+     * ジュームできないので、次にバスを使用するスレッドがレジュームする。
+     */
+    if (!m_reading && m_suspended)
+    {
+        this->Resume();
+        m_suspended = false;
+    }
+}
+
+#if DEVICE_SPI_ASYNCH
+int DSST26::readAsync(void* dst, bd_addr_t address, bd_size_t size, const ReadCallback& callback)
+{
+    X_ASSERT(this->is_valid_read(address, size));
+    X_ASSERT(callback);
+
+    m_mutex.lock();
+    const int result = this->StartRead(dst, address, size, callback);
+    m_mutex.unlock();
+
+    return result;
+}
+
+int DSST26::StartRead(void* dst, bd_addr_t address, bd_size_t size, const ReadCallback& callback)
+{
+    m_suspended = this->SuspendForRead(address, size);
+
+    uint8_t preTx[D__READ_COMMAND_MAX];
+    const int preTxSize = this->BuildReadCommand(address, preTx);
+
+    m_readDst = static_cast<uint8_t*>(dst);
+    m_readRemaining = size;
+    m_readResult = BD_ERROR_OK;
+    m_readCallback = callback;
+    m_reading = true;
+
+    this->SPICSLow();
+    this->SPIExchange(preTx, preTxSize, NULL, 0);
+    this->TransferNextChunk();
+
+    return BD_ERROR_OK;
+}
+
+void DSST26::TransferNextChunk()
+{
+    const int toRead = (m_readRemaining > D__ASYNC_CHUNK_SIZE) ? D__ASYNC_CHUNK_SIZE : m_readRemaining;
+    uint8_t* const dst = m_readDst;
+    m_readDst += toRead;
+    m_readRemaining -= toRead;
+
+    /* 読み出し命令のあとはCSをLowにしている間アドレスが進み続けるので、分割し
+     * た転送をそのまま続けて行える。
+     */
+    const int result = m_spi.transfer<uint8_t>(NULL, 0, dst, toRead,
+                                               callback(this, &DSST26::OnReadEvent),
+                                               SPI_EVENT_COMPLETE | SPI_EVENT_ERROR);
+    if (result != 0)
+        this->OnReadEvent(SPI_EVENT_ERROR);
+}
+
+void DSST26::OnReadEvent(int event)
+{
+    if (event & SPI_EVENT_ERROR)
+        m_readResult = BD_ERROR_DEVICE_ERROR;
+
+    if ((m_readResult == BD_ERROR_OK) && (m_readRemaining > 0))
+    {
+        this->TransferNextChunk();
+        return;
+    }
+
+    this->SPICSHigh();
+    m_reading = false;
+
+    if (m_readCallback)
+        m_readCallback(m_readResult);
+#ifdef MBED_CONF_RTOS_PRESENT
+    else
+        m_readDone.release();
+#endif
+}
+#endif
+
 void DSST26::UnlockGlobalBlockProtection()
 {
     /* パワーオンリセット後はデフォルトで書き込み保護されているので、ULBPRコマン
@@ -301,7 +621,8 @@ void DSST26::UnlockGlobalBlockProtection()
      */
     this->WriteEnable();
     this->DoCommandNoAddress(D_SST26_CMD_ULBPR, NULL, 0, NULL, 0);
-    this->WaitForCommandCompletion();
+    this->BeginOperation(0, m_memorySize, false);
+    this->WaitForCommandCompletion(0);
 }
 
 bd_size_t DSST26::GetBlockEraseSize(bd_addr_t addr) const
@@ -329,11 +650,15 @@ bd_size_t DSST26::GetBlockEraseSize(bd_addr_t addr) const
     return 64 * 1024;
 }
 
-void DSST26::EraseSectorOrBlock(uint8_t eraseCommand, bd_addr_t address)
+void DSST26::EraseSectorOrBlock(uint8_t eraseCommand, bd_addr_t address, bd_size_t size)
 {
+    m_mutex.lock();
+    this->WaitForIdle();
     this->WriteEnable();
     this->DoCommand(eraseCommand, address, NULL, 0, NULL, 0);
-    this->WaitForCommandCompletion();
+    this->BeginOperation(address, size, true);
+    this->WaitForCommandCompletion((eraseCommand == D_SST26_CMD_BE) ? D_SST26_TIME_BE_US : D_SST26_TIME_SE_US);
+    m_mutex.unlock();
 }
 
 void DSST26::SPICSHigh()
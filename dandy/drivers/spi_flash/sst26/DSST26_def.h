@@ -90,6 +90,14 @@
 #define D_SST26_ERASE_SIZE_64KB   (1024UL * 64)
 #define D_SST26_ERASE_SIZE_MIN    (D_SST26_ERASE_SIZE_4KB)
 
+#define D_SST26_PAGE_SIZE         (256UL)     /* 1回のPPコマンドで書き込み可能な最大バイト数 */
+
+/* DataSheet AC OPERATING CHARACTERISTICS (typ) */
+#define D_SST26_TIME_PP_US        (1000UL)     /* Page-Program */
+#define D_SST26_TIME_SE_US        (18000UL)    /* Sector-Erase */
+#define D_SST26_TIME_BE_US        (18000UL)    /* Block-Erase */
+#define D_SST26_TIME_CE_US        (35000UL)    /* Chip-Erase */
+
 #define D_SST26XX016_ADDRESS_BEGIN (0x00000000)
 #define D_SST26XX016_ADDRESS_END   (0x00200000)
 #define D_SST26XX016_SIZE          (D_SST26XX016_ADDRESS_END - D_SST26XX016_ADDRESS_BEGIN) /* 2MB */
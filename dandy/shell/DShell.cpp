@@ -38,6 +38,8 @@
 
 
 #include <dandy/shell/DShell.hpp>
+#include <dandy/core/DStringPool.hpp>
+#include <dandy/core/memory/DArena.hpp>
 #include <linenoise/linenoise.h>
 #include <picox/misc/xargparser.h>
 
@@ -57,8 +59,8 @@ public:
 
         D_CONST_FOREACH(DShell::DShellCommandMap::const_iterator, it, shell->m_commands)
         {
-            if (::strncmp(buf, it->first.c_str(), bufLen) == 0)
-                linenoiseAddCompletion(l, lc, it->first.c_str());
+            if (::strncmp(buf, it->first, bufLen) == 0)
+                linenoiseAddCompletion(l, lc, it->first);
         }
     }
 
@@ -91,19 +93,21 @@ public:
     }
 };
 
-DShell::DShell()
-    : m_stdOut(nullptr)
+DShell::DShell(const DEASTLAllocator& allocator)
+    : m_commands(allocator)
+    , m_stdOut(nullptr)
     , m_stdIn(nullptr)
     , m_stdErr(nullptr)
     , m_maxHistory(20)
     , m_maxLine(256)
     , m_maxArgc(16)
+    , m_arena(nullptr)
 {
 }
 
 void DShell::install(const char* name, DShellCommand command)
 {
-    m_commands.insert(std::make_pair(name, command));
+    m_commands.insert(eastl::make_pair(DStringPool::shared()->intern(name), command));
 }
 
 void DShell::start(const char* prompt, DStream* stdOut, DStream* stdIn, DStream* stdErr)
@@ -180,6 +184,7 @@ void DShell::start(const char* prompt, DStream* stdOut, DStream* stdIn, DStream*
             ctx.stdIn = m_stdIn;
             ctx.stdErr = m_stdErr;
             const DShellCommand command = item->second;
+            DArenaScope commandScope(m_arena);
             command.call(&ctx);
         }
     }
@@ -202,3 +207,8 @@ void DShell::setMaxArgc(size_t maxArgc)
 {
     m_maxArgc = maxArgc;
 }
+
+void DShell::setArena(DArena* arena)
+{
+    m_arena = arena;
+}
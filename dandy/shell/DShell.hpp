@@ -42,7 +42,11 @@
 
 
 #include <dandy/core/stream/DStream.hpp>
-#include <map>
+#include <dandy/core/memory/DEASTLAllocator.hpp>
+#include <EASTL/map.h>
+
+
+class DArena;
 
 
 struct DShellCommandContext
@@ -59,7 +63,12 @@ typedef Callback<int (const DShellCommandContext*)> DShellCommand;
 class DShell
 {
 public:
-    DShell();
+    /** allocatorからコマンドテーブルのノードを確保します
+     *
+     *  XFixedAllocatorを使用する場合は、ブロックサイズをNODE_SIZE以上にしてくだ
+     *  さい。
+     */
+    explicit DShell(const DEASTLAllocator& allocator = DEASTLAllocator(EASTL_NAME_VAL("DShell")));
     void install(const char* name, DShellCommand command);
     void installBuiltinCommands();
     void start(const char* prompt, DStream* stdOut, DStream* stdIn = nullptr, DStream* stdErr = nullptr);
@@ -67,8 +76,19 @@ public:
     void setMaxLine(size_t maxLine);
     void setMaxArgc(size_t maxArgc);
 
+    /** シェルとコマンドの一時バッファを確保するアリーナを設定します
+     *
+     *  コマンドを実行する間はarenaを確保スコープに設定し、コマンドが終わるとコマ
+     *  ンド内で確保したメモリをまとめて解放します。start()の前に設定してください。
+     */
+    void setArena(DArena* arena);
+
 private:
-    typedef std::map<std::string, DShellCommand> DShellCommandMap;
+    /* コマンド名はDStringPoolに登録した文字列を保持します */
+    typedef eastl::map<const char*,
+                       DShellCommand,
+                       eastl::str_less<const char*>,
+                       DEASTLAllocator> DShellCommandMap;
 
     DShellCommandMap m_commands;
     DStream* m_stdOut;
@@ -77,9 +97,13 @@ private:
     int m_maxHistory;
     size_t m_maxLine;
     size_t m_maxArgc;
+    DArena* m_arena;
 
     friend class DShellLinenoiseCallbackHelper;
 
+public:
+    static const size_t NODE_SIZE = sizeof(DShellCommandMap::node_type);
+
 };
 
 #endif /* end of include guard: dandy_DShell_hpp_ */
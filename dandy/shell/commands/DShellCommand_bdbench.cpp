@@ -0,0 +1,102 @@
+#include <dandy/shell/DShell.hpp>
+#include <dandy/core/utils/DBlockDeviceBenchmark.hpp>
+#include <optparse/optparse.h>
+
+
+int d_shellcommand_bdbench(BlockDevice* bd, const DShellCommandContext* ctx)
+{
+    struct optparse_long longopts[] = {
+        {"help", 'h', OPTPARSE_NONE},
+        {"address", 'a', OPTPARSE_REQUIRED},
+        {"size", 's', OPTPARSE_REQUIRED},
+        {"iterations", 'n', OPTPARSE_REQUIRED},
+        {"transfer", 't', OPTPARSE_REQUIRED},
+        {"program", 'p', OPTPARSE_NONE},
+        {"erase", 'e', OPTPARSE_NONE},
+        {0}
+    };
+
+    struct optparse options;
+    int option;
+    uint32_t address = 0;
+    uint32_t size = 0;
+    uint32_t iterations = DBlockDeviceBenchmark::DEFAULT_ITERATIONS;
+    uint32_t transfer = 4096;
+    bool programTest = false;
+    bool eraseTest = false;
+    bool ok = true;
+    const char* name = ctx->argv[0];
+
+    optparse_init(&options, ctx->argv);
+    while ((option = optparse_long(&options, longopts, NULL)) != -1) {
+        switch (option) {
+        case 'h':
+            ctx->stdErr->printf(
+                "usage: %s [-h] [-a ADDRESS] [-s SIZE] [-n ITERATIONS] [-t TRANSFER] [-p] [-e]\n"
+                " -h --help\t\tshow this help message and exit\n"
+                " -a --address\t\tstart address of the test region (default: 0)\n"
+                " -s --size\t\tsize of the test region (default: whole device)\n"
+                " -n --iterations\toperations per measurement (default: %d)\n"
+                " -t --transfer\t\tmaximum read transfer size (default: 4096)\n"
+                " -p --program\t\tmeasure page program latency (destroys the region)\n"
+                " -e --erase\t\tmeasure erase latency (destroys the region)\n",
+                name, DBlockDeviceBenchmark::DEFAULT_ITERATIONS);
+            return EXIT_SUCCESS;
+        case 'a':
+            address = x_strtouint32(options.optarg, 0, &ok);
+            break;
+        case 's':
+            size = x_strtouint32(options.optarg, 0, &ok);
+            break;
+        case 'n':
+            iterations = x_strtouint32(options.optarg, 0, &ok);
+            break;
+        case 't':
+            transfer = x_strtouint32(options.optarg, 0, &ok);
+            break;
+        case 'p':
+            programTest = true;
+            break;
+        case 'e':
+            eraseTest = true;
+            break;
+        case '?':
+            ctx->stdErr->printf("%s: %s\n", name, options.errmsg);
+            return EXIT_FAILURE;
+        default:
+            break;
+        }
+
+        if (!ok)
+        {
+            ctx->stdErr->printf("%s: invalid number '%s'\n", name, options.optarg);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (size == 0)
+        size = (address < bd->size()) ? bd->size() - address : 0;
+
+    if (iterations == 0 || size == 0 || !bd->is_valid_read(address, size))
+    {
+        ctx->stdErr->printf("%s: invalid test region\n", name);
+        return EXIT_FAILURE;
+    }
+
+    DBlockDeviceBenchmark bench(bd, address, size);
+    bench.setIterations(iterations);
+
+    int err = bench.runReadTests(ctx->stdOut, transfer);
+    if (!err && programTest)
+        err = bench.runProgramTests(ctx->stdOut);
+    if (!err && eraseTest)
+        err = bench.runEraseTests(ctx->stdOut);
+
+    if (err)
+    {
+        ctx->stdErr->printf("%s: error %d\n", name, err);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
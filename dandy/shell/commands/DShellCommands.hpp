@@ -46,4 +46,15 @@
 int d_shellcommand_example(const DShellCommandContext* ctx);
 
 
+/** BlockDeviceの性能を測定するコマンドです
+ *
+ *  測定対象のデバイスを第1引数に束縛してインストールします。
+ *
+ *  @code
+ *  shell.install("bdbench", callback(d_shellcommand_bdbench, &flash));
+ *  @endcode
+ */
+int d_shellcommand_bdbench(BlockDevice* bd, const DShellCommandContext* ctx);
+
+
 #endif /* end of include guard: dandy_DShellCommands_hpp_ */
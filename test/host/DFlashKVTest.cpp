@@ -0,0 +1,272 @@
+/**
+ *       @file  DFlashKVTest.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/DFlashKV.hpp>
+#include <dandy/core/block_device/DSimulatedNorFlash.hpp>
+#include "DHostTest.hpp"
+#include <map>
+
+
+D_TEST_DEFINE_FAILURES();
+
+
+#define D__KV_SIZE      (4 * 4096)
+#define D__KV_MAX_KEYS  (32)
+#define D__KEY_COUNT    (24)
+#define D__MAX_VALUE    (48)
+
+
+typedef std::map<std::string, std::string> D__Model;
+
+
+static std::string D__Key(DTestRandom* random)
+{
+    char key[8];
+    x_snprintf(key, sizeof(key), "k%u", static_cast<unsigned>(random->next(D__KEY_COUNT)));
+    return key;
+}
+
+
+static std::string D__Value(DTestRandom* random)
+{
+    std::string value(1 + random->next(D__MAX_VALUE), '\0');
+    for (size_t i = 0; i < value.size(); i++)
+        value[i] = static_cast<char>(random->next());
+    return value;
+}
+
+
+/* 値が存在しない場合は-ENOENTを返す */
+static int D__Get(DFlashKV* kv, const std::string& key, std::string* value)
+{
+    char buffer[D__MAX_VALUE];
+    size_t actualSize;
+    const int result = kv->get(key.c_str(), buffer, sizeof(buffer), &actualSize);
+    if (result == 0)
+        value->assign(buffer, actualSize);
+    return result;
+}
+
+
+static void D__CheckKey(DFlashKV* kv, const D__Model& model, const std::string& key)
+{
+    std::string value;
+    const int result = D__Get(kv, key, &value);
+    D__Model::const_iterator item = model.find(key);
+    if (item == model.end())
+    {
+        D_TEST_CHECK(result == -ENOENT);
+    }
+    else
+    {
+        D_TEST_CHECK(result == 0);
+        D_TEST_CHECK(value == item->second);
+    }
+}
+
+
+static void D__CheckModel(DFlashKV* kv, const D__Model& model)
+{
+    D_TEST_CHECK(kv->count() == model.size());
+    for (int i = 0; i < D__KEY_COUNT; i++)
+    {
+        char key[8];
+        x_snprintf(key, sizeof(key), "k%d", i);
+        D__CheckKey(kv, model, key);
+    }
+    D__CheckKey(kv, model, "hot");
+}
+
+
+/* 電源を入れなおした時と同じく、新しいインスタンスでマウントする */
+static DFlashKV* D__Remount(DSimulatedNorFlash* flash, DFlashKV* kv)
+{
+    D_DELETE(kv);
+    kv = D_NEW(DFlashKV(flash, 0, D__KV_SIZE, D__KV_MAX_KEYS));
+    D_TEST_CHECK(kv->mount() == 0);
+    return kv;
+}
+
+
+/* 予備のセクタを使ったcompact()の直後にset()/remove()して電源が落ちても、
+ * 書き込みが完了を返した値が失われないことを確認する */
+static void D__TestWriteAfterReserveCompaction()
+{
+    DSimulatedNorFlash flash(DSimulatedNorFlash::is25lp064a());
+    D_TEST_CHECK(flash.init() == 0);
+
+    DFlashKV* kv = D_NEW(DFlashKV(&flash, 0, D__KV_SIZE, D__KV_MAX_KEYS));
+    D_TEST_CHECK(kv->format() == 0);
+
+    DTestRandom random(1);
+    D__Model model;
+
+    /* 最も古いセクタの後半に有効なエントリを多く残して、コンパクションでエン
+     * トリを移動している途中でヘッドが一杯になるようにする */
+    for (int i = 0; i < 60; i++)
+    {
+        const std::string value = D__Value(&random);
+        D_TEST_CHECK(kv->set("hot", value.data(), value.size()) == 0);
+        model["hot"] = value;
+    }
+
+    for (int i = 0; i < D__KEY_COUNT; i++)
+    {
+        char key[8];
+        x_snprintf(key, sizeof(key), "k%d", i);
+        const std::string value = D__Value(&random);
+        D_TEST_CHECK(kv->set(key, value.data(), value.size()) == 0);
+        model[key] = value;
+    }
+
+    int writesWithoutFreeSector = 0;
+    for (int i = 0; i < 2000; i++)
+    {
+        if (kv->freeSectors() == 1)
+            D_TEST_CHECK(kv->compact(1) == 0);
+
+        if (kv->freeSectors() == 0)
+            writesWithoutFreeSector++;
+
+        /* 大半は同じキーの更新で、ときどき削除する */
+        const std::string key = (random.next(8) == 0) ? D__Key(&random) : "hot";
+        if (random.next(10) != 0)
+        {
+            const std::string value = D__Value(&random);
+            D_TEST_CHECK(kv->set(key.c_str(), value.data(), value.size()) == 0);
+            model[key] = value;
+        }
+        else
+        {
+            const int result = kv->remove(key.c_str());
+            D_TEST_CHECK(result == (model.erase(key) ? 0 : -ENOENT));
+        }
+
+        /* コンパクションの進み具合を保ったまま試験を続けるため、マウントは
+         * 別のインスタンスで行う */
+        DFlashKV rebooted(&flash, 0, D__KV_SIZE, D__KV_MAX_KEYS);
+        D_TEST_CHECK(rebooted.mount() == 0);
+        D__CheckModel(&rebooted, model);
+    }
+
+    /* 試験したい状態を実際に通ったか */
+    D_TEST_CHECK(writesWithoutFreeSector > 0);
+
+    D_DELETE(kv);
+}
+
+
+/* 書き込みやコンパクションの途中で電源が落ちても、マウントでき、各キーは更新
+ * 前か更新後の値のどちらかになることを確認する */
+static void D__TestPowerCut()
+{
+    DSimulatedNorFlash flash(DSimulatedNorFlash::is25lp064a());
+    D_TEST_CHECK(flash.init() == 0);
+
+    DFlashKV* kv = D_NEW(DFlashKV(&flash, 0, D__KV_SIZE, D__KV_MAX_KEYS));
+    D_TEST_CHECK(kv->format() == 0);
+
+    DTestRandom random(2);
+    D__Model model;
+    int cuts = 0;
+    for (int i = 0; i < 4000; i++)
+    {
+        const uint32_t op = random.next(10);
+        const std::string key = D__Key(&random);
+        const std::string value = D__Value(&random);
+        const bool existed = model.count(key) > 0;
+
+        flash.setPowerCutAfter(random.next(8));
+        int result;
+        if (op < 2)
+            result = kv->compact(1 + random.next(3));
+        else if (op < 9)
+            result = kv->set(key.c_str(), value.data(), value.size());
+        else
+            result = existed ? kv->remove(key.c_str()) : 0;
+        const bool cut = flash.isPowerCut();
+        flash.restorePower();
+
+        if (result == 0)
+        {
+            if ((op >= 2) && (op < 9))
+                model[key] = value;
+            else if (op >= 9)
+                model.erase(key);
+            continue;
+        }
+
+        D_TEST_CHECK(cut);
+        cuts++;
+        kv = D__Remount(&flash, kv);
+
+        /* 途中で止まった更新は、更新前と更新後のどちらになってもよい */
+        if (op >= 2)
+        {
+            std::string actual;
+            const int found = D__Get(kv, key, &actual);
+            if (found == -ENOENT)
+            {
+                D_TEST_CHECK(!existed || (op >= 9));
+                model.erase(key);
+            }
+            else
+            {
+                D_TEST_CHECK(found == 0);
+                D_TEST_CHECK((existed && (actual == model[key])) || ((op < 9) && (actual == value)));
+                model[key] = actual;
+            }
+        }
+
+        D__CheckModel(kv, model);
+    }
+
+    D_TEST_CHECK(cuts > 0);
+
+    D_DELETE(kv);
+}
+
+
+int main()
+{
+    D__TestWriteAfterReserveCompaction();
+    D__TestPowerCut();
+
+    return D_TEST_RESULT();
+}
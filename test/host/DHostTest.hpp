@@ -0,0 +1,92 @@
+/**
+ *       @file  DHostTest.hpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef dandy_DHostTest_hpp_
+#define dandy_DHostTest_hpp_
+
+
+#include <dandy/core/DCore.hpp>
+
+
+/** ホストの試験プログラムで使用する検査マクロです
+ *
+ *  exprが偽の場合は場所を表示して失敗を数えます。main()はD_TEST_RESULT()を返し
+ *  てください。失敗が1つでもあればctestで失敗として扱われます。
+ */
+extern int d_test_failures;
+
+#define D_TEST_CHECK(expr)                                                  \
+    do                                                                      \
+    {                                                                       \
+        if (!(expr))                                                        \
+        {                                                                   \
+            ::fprintf(stderr, "%s:%d: check failed: %s\n",                  \
+                      __FILE__, __LINE__, #expr);                           \
+            d_test_failures++;                                              \
+        }                                                                   \
+    } while (0)
+
+#define D_TEST_DEFINE_FAILURES()    int d_test_failures = 0
+#define D_TEST_RESULT()             ((d_test_failures == 0) ? 0 : 1)
+
+
+/** 試験を再現できるように、シードを固定した擬似乱数を返します
+ */
+class DTestRandom
+{
+public:
+    explicit DTestRandom(uint32_t seed) : m_state(seed) {}
+
+    uint32_t next()
+    {
+        /* xorshift32 */
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    uint32_t next(uint32_t n) { return this->next() % n; }
+
+private:
+    uint32_t m_state;
+};
+
+
+#endif /* end of include guard: dandy_DHostTest_hpp_ */
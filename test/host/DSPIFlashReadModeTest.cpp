@@ -0,0 +1,170 @@
+/**
+ *       @file  DSPIFlashReadModeTest.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/drivers/spi_flash/sst26/DSST26.hpp>
+#include <dandy/drivers/spi_flash/is25/DIS25.hpp>
+#include <dandy/core/host/DSimulatedSPINorFlash.hpp>
+#include "DHostTest.hpp"
+#include <vector>
+
+
+D_TEST_DEFINE_FAILURES();
+
+
+#define D__PIN_MOSI     (0)
+#define D__PIN_MISO     (1)
+#define D__PIN_SCLK     (2)
+#define D__PIN_CS       (3)
+#define D__FREQUENCY    (40000000)
+#define D__SECTOR_SIZE  (4 * 1024)
+#define D__ITERATIONS   (50)
+
+
+/* シミュレータに書き込んだパターンを、modeで設定したコマンドでflashから読み出す
+ *
+ * アドレスのバイト数やダミーバイトの数がコマンドと合っていなければ、読み出した
+ * データがずれるか、コマンドが途中で終わってprotocolErrors()に数えられる。
+ * Quadの読み出しはドライバが実装していないので確かめない。
+ */
+template <typename Flash, typename Mode>
+static void D__CheckRead(Flash* flash, DSimulatedSPINorFlash* device, Mode mode,
+                         uint8_t expectedOpcode, uint8_t unexpectedOpcode)
+{
+    DSimulatedNorFlash& sim = device->flash();
+    flash->setReadMode(mode);
+
+    const uint64_t expectedBefore = device->commandCount(expectedOpcode);
+    const uint64_t unexpectedBefore = device->commandCount(unexpectedOpcode);
+
+    DTestRandom random(expectedOpcode);
+    for (int i = 0; i < D__ITERATIONS; i++)
+    {
+        const bd_addr_t address = random.next(static_cast<uint32_t>(sim.size() - 2 * D__SECTOR_SIZE));
+        std::vector<uint8_t> data(1 + random.next(D__SECTOR_SIZE));
+        for (size_t j = 0; j < data.size(); j++)
+            data[j] = static_cast<uint8_t>(random.next());
+
+        const bd_addr_t eraseBegin = address - (address % D__SECTOR_SIZE);
+        D_TEST_CHECK(sim.erase(eraseBegin, 2 * D__SECTOR_SIZE) == 0);
+        D_TEST_CHECK(sim.program(&data[0], address, data.size()) == 0);
+
+        std::vector<uint8_t> actual(data.size());
+        D_TEST_CHECK(flash->read(&actual[0], address, actual.size()) == 0);
+        D_TEST_CHECK(::memcmp(&actual[0], &data[0], data.size()) == 0);
+    }
+
+    D_TEST_CHECK(device->commandCount(expectedOpcode) - expectedBefore == D__ITERATIONS);
+    D_TEST_CHECK(device->commandCount(unexpectedOpcode) == unexpectedBefore);
+    D_TEST_CHECK(device->protocolErrors() == 0);
+}
+
+
+/* ドライバの書き込みで書いた内容を、シミュレータから直接読んで確かめる */
+template <typename Flash>
+static void D__CheckProgram(Flash* flash, DSimulatedSPINorFlash* device)
+{
+    DSimulatedNorFlash& sim = device->flash();
+    DTestRandom random(98765);
+    const bd_addr_t address = D__SECTOR_SIZE + random.next(D__SECTOR_SIZE);
+    std::vector<uint8_t> data(1 + random.next(D__SECTOR_SIZE));
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<uint8_t>(random.next());
+
+    D_TEST_CHECK(flash->erase(D__SECTOR_SIZE, 2 * D__SECTOR_SIZE) == 0);
+    D_TEST_CHECK(flash->program(&data[0], address, data.size()) == 0);
+
+    std::vector<uint8_t> actual(data.size());
+    D_TEST_CHECK(sim.read(&actual[0], address, actual.size()) == 0);
+    D_TEST_CHECK(::memcmp(&actual[0], &data[0], data.size()) == 0);
+    D_TEST_CHECK(sim.programViolations() == 0);
+    D_TEST_CHECK(device->protocolErrors() == 0);
+}
+
+
+/* SST26: Read(0x03)とHigh-Speed Read(0x0B, アドレス3バイト, ダミー1バイト) */
+static void D__TestSST26(DSimulatedSPINorFlash* device)
+{
+    DSST26 flash(D__PIN_MOSI, D__PIN_MISO, D__PIN_SCLK, D__PIN_CS, D__FREQUENCY);
+    flash.init();
+    D_TEST_CHECK(flash.getDeviceType() == D_SST26_TYPE_VF064);
+    D_TEST_CHECK(flash.size() == device->flash().size());
+
+    D__CheckProgram(&flash, device);
+    D__CheckRead(&flash, device, D_SST26_READ_MODE_NORMAL, 0x03, 0x0B);
+    D__CheckRead(&flash, device, D_SST26_READ_MODE_FAST, 0x0B, 0x03);
+    D__CheckRead(&flash, device, D_SST26_READ_MODE_NORMAL, 0x03, 0x0B);
+    D_TEST_CHECK(flash.deinit() == 0);
+}
+
+
+/* IS25: 4NORD(0x13)と4FRD(0x0C, アドレス4バイト, ダミー1バイト) */
+static void D__TestIS25(DSimulatedSPINorFlash* device)
+{
+    DIS25 flash(D__PIN_MOSI, D__PIN_MISO, D__PIN_SCLK, D__PIN_CS, D__FREQUENCY);
+    D_TEST_CHECK(flash.init() == BD_ERROR_OK);
+    D_TEST_CHECK(flash.getDeviceType() == D_IS25_TYPE_LP064A);
+    D_TEST_CHECK(flash.size() == device->flash().size());
+
+    D__CheckProgram(&flash, device);
+    D__CheckRead(&flash, device, D_IS25_READ_MODE_NORMAL, 0x13, 0x0C);
+    D__CheckRead(&flash, device, D_IS25_READ_MODE_FAST, 0x0C, 0x13);
+    D__CheckRead(&flash, device, D_IS25_READ_MODE_NORMAL, 0x13, 0x0C);
+    D_TEST_CHECK(flash.deinit() == 0);
+}
+
+
+/* ドライバのデストラクタもバスにアクセスするので、ドライバを破棄してからデバ
+ * イスを切り離す */
+static void D__Run(const DSimulatedSPINorFlash::Device& definition, void (*test)(DSimulatedSPINorFlash*))
+{
+    DSimulatedSPINorFlash device(definition);
+    DHostSPIDevice::attach(D__PIN_CS, &device);
+    test(&device);
+    D_TEST_CHECK(device.protocolErrors() == 0);
+    DHostSPIDevice::attach(D__PIN_CS, NULL);
+}
+
+
+int main()
+{
+    D__Run(DSimulatedSPINorFlash::sst26vf064b(), D__TestSST26);
+    D__Run(DSimulatedSPINorFlash::is25lp064a(), D__TestIS25);
+
+    return D_TEST_RESULT();
+}
@@ -0,0 +1,216 @@
+/**
+ *       @file  DSPINorFlashTest.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/drivers/spi_flash/DSPINorFlash.hpp>
+#include <dandy/core/host/DSimulatedSPINorFlash.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+#include "DHostTest.hpp"
+#include <vector>
+
+
+D_TEST_DEFINE_FAILURES();
+
+
+#define D__PIN_MOSI     (0)
+#define D__PIN_MISO     (1)
+#define D__PIN_SCLK     (2)
+#define D__PIN_CS       (3)
+#define D__FREQUENCY    (40000000)
+#define D__SECTOR_SIZE  (4 * 1024)
+#define D__MARGIN       (64 * 1024)
+#define D__ITERATIONS   (300)
+
+
+/* SST26の不均一な領域を通るように、先頭と末尾の128KBから半分の範囲を選ぶ */
+static void D__RandomRange(DTestRandom* random, bd_size_t deviceSize, bd_addr_t* address, bd_size_t* size)
+{
+    const bd_size_t sectors = deviceSize / D__SECTOR_SIZE;
+    const uint32_t where = random->next(4);
+    bd_size_t first;
+    if (where == 0)
+        first = random->next(32);
+    else if (where == 1)
+        first = sectors - 1 - random->next(32);
+    else
+        first = random->next(sectors);
+
+    const bd_size_t count = d_min<bd_size_t>(1 + random->next(64), sectors - first);
+    *address = first * D__SECTOR_SIZE;
+    *size = count * D__SECTOR_SIZE;
+}
+
+
+/* 範囲の前後をパターンで埋めてから消去し、範囲だけが消去されたこと、発行した消
+ * 去コマンドの数が計画と一致することを確かめる */
+static void D__CheckErase(DSPINorFlash* flash, DSimulatedSPINorFlash* device,
+                          bd_addr_t address, bd_size_t size, uint64_t expectedOperations,
+                          DTestRandom* random)
+{
+    DSimulatedNorFlash& sim = device->flash();
+    const bd_addr_t begin = (address > D__MARGIN) ? address - D__MARGIN : 0;
+    const bd_addr_t end = d_min<bd_addr_t>(address + size + D__MARGIN, sim.size());
+
+    std::vector<uint8_t> pattern(end - begin);
+    for (size_t i = 0; i < pattern.size(); i++)
+        pattern[i] = static_cast<uint8_t>(random->next());
+    D_TEST_CHECK(sim.erase(begin, end - begin) == 0);
+    D_TEST_CHECK(sim.program(&pattern[0], begin, pattern.size()) == 0);
+
+    const uint64_t before = sim.eraseOperationCount();
+    D_TEST_CHECK(flash->erase(address, size) == 0);
+    const uint64_t issued = sim.eraseOperationCount() - before;
+    D_TEST_CHECK(issued == flash->countEraseOperations(address, size));
+    D_TEST_CHECK(issued == expectedOperations);
+
+    std::vector<uint8_t> actual(end - begin);
+    D_TEST_CHECK(sim.read(&actual[0], begin, actual.size()) == 0);
+    bool erased = true;
+    bool preserved = true;
+    for (size_t i = 0; i < actual.size(); i++)
+    {
+        const bd_addr_t a = begin + i;
+        if ((a >= address) && (a < address + size))
+            erased = erased && (actual[i] == 0xFF);
+        else
+            preserved = preserved && (actual[i] == pattern[i]);
+    }
+    D_TEST_CHECK(erased);
+    D_TEST_CHECK(preserved);
+}
+
+
+/* SFDPから組み立てた消去の計画を、シミュレータのコマンドの解釈と突き合わせる
+ *
+ * uniqueEraseSizeが0なら、DSimulatedNorFlash::erase()と同じ最小の回数になる
+ * はず。0でなければ、その大きさの消去コマンドだけを使うはず。
+ */
+static void D__TestErasePlan(const DSimulatedSPINorFlash::Device& definition, bool sectorMap,
+                             bd_size_t uniqueEraseSize)
+{
+    DSimulatedSPINorFlash device(definition);
+    device.setSectorMapEnabled(sectorMap);
+    DHostSPIDevice::attach(D__PIN_CS, &device);
+
+    DSPINorFlash flash(D__PIN_MOSI, D__PIN_MISO, D__PIN_SCLK, D__PIN_CS, D__FREQUENCY);
+    D_TEST_CHECK(flash.init() == BD_ERROR_OK);
+    D_TEST_CHECK(flash.size() == definition.profile->size);
+    D_TEST_CHECK(flash.getPageSize() == definition.profile->pageSize);
+    D_TEST_CHECK(flash.get_erase_size() == D__SECTOR_SIZE);
+    D_TEST_CHECK(::memcmp(flash.getJedecId(), definition.jedecId, 3) == 0);
+
+    /* 最小の回数はシミュレータ自身の消去で求める */
+    DSimulatedNorFlash reference(*definition.profile);
+    D_TEST_CHECK(reference.init() == 0);
+
+    DTestRandom random(0x5F3759DF);
+    for (int i = 0; i < D__ITERATIONS; i++)
+    {
+        bd_addr_t address;
+        bd_size_t size;
+        D__RandomRange(&random, flash.size(), &address, &size);
+
+        uint64_t expected;
+        if (uniqueEraseSize)
+        {
+            expected = size / uniqueEraseSize;
+        }
+        else
+        {
+            const uint64_t before = reference.eraseOperationCount();
+            D_TEST_CHECK(reference.erase(address, size) == 0);
+            expected = reference.eraseOperationCount() - before;
+        }
+
+        D__CheckErase(&flash, &device, address, size, expected, &random);
+    }
+
+    D_TEST_CHECK(device.protocolErrors() == 0);
+    D_TEST_CHECK(flash.deinit() == 0);
+    DHostSPIDevice::attach(D__PIN_CS, NULL);
+}
+
+
+/* ページ境界をまたぐ書き込みと、Fast Read(0x0B, アドレス3バイト, ダミー1バイト)
+ * での読み出し */
+static void D__TestProgramRead(const DSimulatedSPINorFlash::Device& definition)
+{
+    DSimulatedSPINorFlash device(definition);
+    DHostSPIDevice::attach(D__PIN_CS, &device);
+
+    DSPINorFlash flash(D__PIN_MOSI, D__PIN_MISO, D__PIN_SCLK, D__PIN_CS, D__FREQUENCY);
+    D_TEST_CHECK(flash.init() == BD_ERROR_OK);
+
+    DTestRandom random(12345);
+    for (int i = 0; i < 50; i++)
+    {
+        const bd_addr_t address = 1 + random.next(static_cast<uint32_t>(flash.size() - 2048));
+        std::vector<uint8_t> data(1 + random.next(1024));
+        for (size_t j = 0; j < data.size(); j++)
+            data[j] = static_cast<uint8_t>(random.next());
+
+        const bd_addr_t eraseBegin = address - (address % D__SECTOR_SIZE);
+        const bd_addr_t eraseEnd = address + data.size() + D__SECTOR_SIZE - 1;
+        D_TEST_CHECK(flash.erase(eraseBegin, eraseEnd - (eraseEnd % D__SECTOR_SIZE) - eraseBegin) == 0);
+        D_TEST_CHECK(flash.program(&data[0], address, data.size()) == 0);
+
+        std::vector<uint8_t> actual(data.size() + 2);
+        D_TEST_CHECK(flash.read(&actual[0], address - 1, actual.size()) == 0);
+        D_TEST_CHECK(::memcmp(&actual[1], &data[0], data.size()) == 0);
+    }
+
+    D_TEST_CHECK(device.commandCount(0x0B) > 0);
+    D_TEST_CHECK(device.commandCount(0x03) == 0);
+    D_TEST_CHECK(device.flash().programViolations() == 0);
+    D_TEST_CHECK(device.protocolErrors() == 0);
+    DHostSPIDevice::attach(D__PIN_CS, NULL);
+}
+
+
+int main()
+{
+    /* SST26は0xD8が8KB/32KB/64KBを兼ねるので、Sector Mapがなければ4KBだけを使う */
+    D__TestErasePlan(DSimulatedSPINorFlash::sst26vf064b(), true, 0);
+    D__TestErasePlan(DSimulatedSPINorFlash::sst26vf064b(), false, D__SECTOR_SIZE);
+    D__TestErasePlan(DSimulatedSPINorFlash::is25lp064a(), true, 0);
+    D__TestErasePlan(DSimulatedSPINorFlash::is25lp064a(), false, 0);
+    D__TestProgramRead(DSimulatedSPINorFlash::sst26vf064b());
+    D__TestProgramRead(DSimulatedSPINorFlash::is25lp064a());
+
+    return D_TEST_RESULT();
+}
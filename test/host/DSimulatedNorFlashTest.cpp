@@ -0,0 +1,242 @@
+/**
+ *       @file  DSimulatedNorFlashTest.cpp
+ *      @brief
+ *
+ *    @details
+ *
+ *     @author  MaskedW
+ *
+ *   @internal
+ *     Created  2026/10/19
+ * ===================================================================
+ */
+
+/*
+ * License: MIT license
+ * Copyright (c) <2026> <MaskedW [maskedw00@gmail.com]>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dandy/core/block_device/DSimulatedNorFlash.hpp>
+#include <dandy/core/utils/DCoreUtils.hpp>
+#include "DHostTest.hpp"
+#include <vector>
+
+
+D_TEST_DEFINE_FAILURES();
+
+
+#define D__KB           (1024)
+#define D__SST26_D8     (0x0E)  /* SST26のブロック消去(0xD8)が消去する種類 */
+
+
+static bool D__IsFilled(DSimulatedNorFlash* flash, bd_addr_t address, bd_size_t size, uint8_t value)
+{
+    std::vector<uint8_t> actual(size);
+    if (flash->read(&actual[0], address, size) != 0)
+        return false;
+
+    for (size_t i = 0; i < actual.size(); i++)
+    {
+        if (actual[i] != value)
+            return false;
+    }
+
+    return true;
+}
+
+
+static void D__Fill(DSimulatedNorFlash* flash, bd_addr_t address, bd_size_t size, uint8_t value)
+{
+    const std::vector<uint8_t> data(size, value);
+    D_TEST_CHECK(flash->program(&data[0], address, size) == 0);
+}
+
+
+/* 1回のページプログラムは、ページの末尾を越えた分をページの先頭に書き込む */
+static void D__TestPageWrap()
+{
+    DSimulatedNorFlash flash(DSimulatedNorFlash::is25lp064a());
+    D_TEST_CHECK(flash.init() == 0);
+    const bd_size_t pageSize = DSimulatedNorFlash::is25lp064a().pageSize;
+
+    uint8_t data[16];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = static_cast<uint8_t>(i);
+
+    const bd_addr_t page = 4 * pageSize;
+    D_TEST_CHECK(flash.pageProgram(data, page + pageSize - 8, sizeof(data)) == 0);
+    D_TEST_CHECK(flash.pageProgramCount() == 1);
+
+    uint8_t actual[16];
+    D_TEST_CHECK(flash.read(actual, page + pageSize - 8, 8) == 0);
+    D_TEST_CHECK(::memcmp(actual, data, 8) == 0);
+    D_TEST_CHECK(flash.read(actual, page, 8) == 0);
+    D_TEST_CHECK(::memcmp(actual, data + 8, 8) == 0);
+    D_TEST_CHECK(D__IsFilled(&flash, page + 8, pageSize - 16, 0xFF));
+    D_TEST_CHECK(D__IsFilled(&flash, page + pageSize, pageSize, 0xFF));
+
+    /* program()はページ境界で分割するので折り返さない */
+    D_TEST_CHECK(flash.program(data, 2 * pageSize - 8, sizeof(data)) == 0);
+    D_TEST_CHECK(flash.pageProgramCount() == 3);
+    D_TEST_CHECK(flash.read(actual, 2 * pageSize - 8, sizeof(actual)) == 0);
+    D_TEST_CHECK(::memcmp(actual, data, sizeof(data)) == 0);
+    D_TEST_CHECK(D__IsFilled(&flash, pageSize, 8, 0xFF));
+}
+
+
+/* 書き込みはビットを0にすることしかできない */
+static void D__TestProgramAnd()
+{
+    DSimulatedNorFlash flash(DSimulatedNorFlash::is25lp064a());
+    D_TEST_CHECK(flash.init() == 0);
+
+    const uint8_t high = 0xF0;
+    const uint8_t low = 0x0F;
+    const uint8_t cleared = 0x30;
+    uint8_t actual;
+
+    D_TEST_CHECK(flash.program(&high, 0, 1) == 0);
+    D_TEST_CHECK(flash.programViolations() == 0);
+    D_TEST_CHECK(flash.program(&low, 0, 1) == 0);
+    D_TEST_CHECK(flash.programViolations() == 1);
+    D_TEST_CHECK(flash.read(&actual, 0, 1) == 0);
+    D_TEST_CHECK(actual == 0x00);
+
+    /* 0にするだけの書き込みは違反ではない */
+    D_TEST_CHECK(flash.program(&high, 1, 1) == 0);
+    D_TEST_CHECK(flash.program(&cleared, 1, 1) == 0);
+    D_TEST_CHECK(flash.programViolations() == 1);
+    D_TEST_CHECK(flash.read(&actual, 1, 1) == 0);
+    D_TEST_CHECK(actual == (high & cleared));
+
+    /* strictでは違反するとメモリを変更せずにエラーを返す */
+    flash.setStrict(true);
+    D_TEST_CHECK(flash.program(&high, 2, 1) == 0);
+    D_TEST_CHECK(flash.program(&low, 2, 1) != 0);
+    D_TEST_CHECK(flash.read(&actual, 2, 1) == 0);
+    D_TEST_CHECK(actual == high);
+
+    D_TEST_CHECK(flash.erase(0, flash.get_erase_size()) == 0);
+    D_TEST_CHECK(D__IsFilled(&flash, 0, flash.get_erase_size(), 0xFF));
+    D_TEST_CHECK(flash.program(&low, 2, 1) == 0);
+}
+
+
+/* SST26のブロック消去は、アドレスを含む領域によって消去サイズが変わり、アドレス
+ * の下位ビットを無視して消去単位の先頭から消去する */
+static void D__CheckEraseCommand(DSimulatedNorFlash* flash, bd_addr_t address, uint8_t typeMask,
+                                 bd_size_t expectedSize)
+{
+    const bd_addr_t begin = address - (address % expectedSize);
+    const bd_addr_t marginBegin = (begin >= 64 * D__KB) ? begin - 64 * D__KB : 0;
+    const bd_addr_t marginEnd = d_min<bd_addr_t>(begin + expectedSize + 64 * D__KB, flash->size());
+
+    D_TEST_CHECK(flash->erase(marginBegin, marginEnd - marginBegin) == 0);
+    D__Fill(flash, marginBegin, marginEnd - marginBegin, 0x00);
+
+    const uint64_t before = flash->eraseOperationCount();
+    D_TEST_CHECK(flash->eraseCommand(address, typeMask) == 0);
+    D_TEST_CHECK(flash->eraseOperationCount() - before == 1);
+
+    D_TEST_CHECK(D__IsFilled(flash, marginBegin, begin - marginBegin, 0x00));
+    D_TEST_CHECK(D__IsFilled(flash, begin, expectedSize, 0xFF));
+    D_TEST_CHECK(D__IsFilled(flash, begin + expectedSize, marginEnd - begin - expectedSize, 0x00));
+}
+
+
+static void D__TestSST26Regions()
+{
+    DSimulatedNorFlash flash(DSimulatedNorFlash::sst26vf064b());
+    D_TEST_CHECK(flash.init() == 0);
+    const bd_size_t size = flash.size();
+
+    D__CheckEraseCommand(&flash, 0, D__SST26_D8, 8 * D__KB);
+    D__CheckEraseCommand(&flash, 24 * D__KB + 100, D__SST26_D8, 8 * D__KB);
+    D__CheckEraseCommand(&flash, 40 * D__KB, D__SST26_D8, 32 * D__KB);
+    D__CheckEraseCommand(&flash, 64 * D__KB, D__SST26_D8, 64 * D__KB);
+    D__CheckEraseCommand(&flash, size / 2 + 12345, D__SST26_D8, 64 * D__KB);
+    D__CheckEraseCommand(&flash, size - 64 * D__KB - 1, D__SST26_D8, 64 * D__KB);
+    D__CheckEraseCommand(&flash, size - 48 * D__KB, D__SST26_D8, 32 * D__KB);
+    D__CheckEraseCommand(&flash, size - 1, D__SST26_D8, 8 * D__KB);
+
+    /* セクタ消去(0x20)はどの領域でも4KB */
+    D__CheckEraseCommand(&flash, 8 * D__KB + 1, 0x01, 4 * D__KB);
+    D__CheckEraseCommand(&flash, size / 2 + 1, 0x01, 4 * D__KB);
+
+    /* 領域で使えない種類だけを指定するとエラー */
+    D_TEST_CHECK(flash.eraseCommand(64 * D__KB, 0x02) != 0);
+    D_TEST_CHECK(flash.eraseCommand(0, 0x08) != 0);
+    D_TEST_CHECK(flash.eraseCommand(size, 0x01) != 0);
+}
+
+
+/* erase()は最も少ない回数の消去コマンドを選び、セクタごとの消去回数を数える */
+static void D__TestEraseCounts()
+{
+    DSimulatedNorFlash sst26(DSimulatedNorFlash::sst26vf064b());
+    D_TEST_CHECK(sst26.init() == 0);
+
+    /* 8KBが4回と32KBが1回 */
+    D_TEST_CHECK(sst26.erase(0, 64 * D__KB) == 0);
+    D_TEST_CHECK(sst26.eraseOperationCount() == 5);
+
+    /* 4KBが1回と64KBが1回と4KBが1回 */
+    sst26.resetStatistics();
+    D_TEST_CHECK(sst26.erase(60 * D__KB, 72 * D__KB) == 0);
+    D_TEST_CHECK(sst26.eraseOperationCount() == 3);
+
+    D_TEST_CHECK(sst26.eraseCount(0) == 1);
+    D_TEST_CHECK(sst26.eraseCount(56 * D__KB) == 1);
+    D_TEST_CHECK(sst26.eraseCount(60 * D__KB) == 2);
+    D_TEST_CHECK(sst26.eraseCount(64 * D__KB) == 1);
+    D_TEST_CHECK(sst26.eraseCount(128 * D__KB) == 1);
+    D_TEST_CHECK(sst26.eraseCount(132 * D__KB) == 0);
+    D_TEST_CHECK(sst26.maxEraseCount() == 2);
+
+    DSimulatedNorFlash is25(DSimulatedNorFlash::is25lp064a());
+    D_TEST_CHECK(is25.init() == 0);
+
+    /* 4KBが7回と32KBが1回と64KBが1回 */
+    D_TEST_CHECK(is25.erase(4 * D__KB, 124 * D__KB) == 0);
+    D_TEST_CHECK(is25.eraseOperationCount() == 9);
+    D_TEST_CHECK(is25.eraseCount(0) == 0);
+    D_TEST_CHECK(is25.eraseCount(4 * D__KB) == 1);
+    D_TEST_CHECK(is25.eraseCount(124 * D__KB) == 1);
+    D_TEST_CHECK(is25.eraseCount(128 * D__KB) == 0);
+
+    /* 消去できない範囲はエラー */
+    D_TEST_CHECK(is25.erase(2 * D__KB, 4 * D__KB) != 0);
+    D_TEST_CHECK(is25.eraseOperationCount() == 9);
+}
+
+
+int main()
+{
+    D__TestPageWrap();
+    D__TestProgramAnd();
+    D__TestSST26Regions();
+    D__TestEraseCounts();
+
+    return D_TEST_RESULT();
+}